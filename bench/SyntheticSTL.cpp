@@ -0,0 +1,320 @@
+/*
+ * SyntheticSTL.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "SyntheticSTL.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include <errno.h>
+
+namespace
+{
+	const char* const SHAPE_NAMES[SyntheticSTL::NUM_SHAPES] = { "sphere", "torus", "noise" };
+	const char* const FORMAT_NAMES[SyntheticSTL::NUM_FORMATS] = { "binary", "ascii" };
+
+	// Sizes in mm, roughly those of a small machined part
+	const double SPHERE_RADIUS = 50.0;
+	const double TORUS_MAJOR_RADIUS = 40.0;
+	const double TORUS_MINOR_RADIUS = 15.0;
+	const double NOISE_SIZE = 100.0;
+	const double NOISE_HEIGHT = 10.0;
+	const int NOISE_OCTAVES = 4;
+
+	const double PI = 3.14159265358979323846;
+
+	/** A repeatable pseudo-random value in [0, 1] for a lattice point */
+	double lattice_value(int64_t x, int64_t y)
+	{
+		uint64_t h = (uint64_t) x * 0x9E3779B97F4A7C15ull ^ (uint64_t) y * 0xC2B2AE3D27D4EB4Full;
+		h ^= h >> 29;
+		h *= 0xBF58476D1CE4E5B9ull;
+		h ^= h >> 32;
+
+		return (double) (h & 0xFFFFFF) / (double) 0xFFFFFF;
+	}
+
+	/** Smoothly interpolated lattice values, a few octaves of them */
+	double value_noise(double x, double y)
+	{
+		double value = 0.0, amplitude = 0.5, frequency = 4.0;
+		for (int octave = 0 ; octave < NOISE_OCTAVES ; octave++)
+		{
+			const double fx = x * frequency, fy = y * frequency;
+			const int64_t ix = (int64_t) std::floor(fx), iy = (int64_t) std::floor(fy);
+			const double tx = fx - ix, ty = fy - iy;
+			const double sx = tx * tx * (3.0 - 2.0 * tx), sy = ty * ty * (3.0 - 2.0 * ty);
+
+			const double bottom = lattice_value(ix, iy) + sx * (lattice_value(ix + 1, iy) - lattice_value(ix, iy));
+			const double top = lattice_value(ix, iy + 1) + sx * (lattice_value(ix + 1, iy + 1) - lattice_value(ix, iy + 1));
+			value += amplitude * (bottom + sy * (top - bottom));
+
+			amplitude *= 0.5;
+			frequency *= 2.0;
+		}
+
+		return value;
+	}
+
+	/** The two facets of a grid cell with corners a, b (along u), c (along v) and d, facing u x v */
+	template <typename Function>
+	void emit_cell(Function& f, const float* a, const float* b, const float* c, const float* d)
+	{
+		float v[9];
+
+		std::memcpy(v, a, 3 * sizeof(float));
+		std::memcpy(v + 3, b, 3 * sizeof(float));
+		std::memcpy(v + 6, d, 3 * sizeof(float));
+		f(v);
+
+		std::memcpy(v + 3, d, 3 * sizeof(float));
+		std::memcpy(v + 6, c, 3 * sizeof(float));
+		f(v);
+	}
+
+	void facet_normal(const float* v, float n[3])
+	{
+		const double e1[3] = { (double) v[3] - v[0], (double) v[4] - v[1], (double) v[5] - v[2] };
+		const double e2[3] = { (double) v[6] - v[0], (double) v[7] - v[1], (double) v[8] - v[2] };
+		double c[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+		const double length = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+		for (int i = 0 ; i < 3 ; i++)
+			n[i] = length > 0.0 ? (float) (c[i] / length) : 0.0f;
+	}
+};
+
+SyntheticSTL::SyntheticSTL(Shape shape, uint64_t num_facets)
+: m_shape(shape)
+{
+	// Facets per grid: 12 g^2 for the sphere, 4 g^2 for the torus (twice as many cells around as across), 2 g^2 for noise
+	const double facets_per_cell = shape == SHAPE_SPHERE ? 12.0 : (shape == SHAPE_TORUS ? 4.0 : 2.0);
+	const uint64_t min_grid = shape == SHAPE_TORUS ? 3 : 1;
+
+	m_grid = std::max(min_grid, (uint64_t) std::llround(std::sqrt(num_facets / facets_per_cell)));
+}
+
+uint64_t SyntheticSTL::NumFacets() const
+{
+	switch (m_shape)
+	{
+	case SHAPE_SPHERE:	return 12 * m_grid * m_grid;
+	case SHAPE_TORUS:	return 4 * m_grid * m_grid;
+	default:			return 2 * m_grid * m_grid;
+	}
+}
+
+template <typename Function>
+void SyntheticSTL::for_each_facet(Function f) const
+{
+	const uint64_t g = m_grid;
+
+	// Two rows of vertices at a time, so even 100M facet parts take little memory
+	std::vector<float> row0, row1;
+
+	if (m_shape == SHAPE_SPHERE)
+	{
+		for (int face = 0 ; face < 6 ; face++)
+		{
+			const int axis = face / 2;
+			const float side = (face % 2) ? -1.0f : 1.0f;
+
+			auto fill_row = [&](uint64_t j, std::vector<float>& row)
+			{
+				row.resize(3 * (g + 1));
+				for (uint64_t i = 0 ; i <= g ; i++)
+				{
+					float p[3];
+					p[axis] = side;
+					p[(axis + 1) % 3] = 2.0f * i / g - 1.0f;
+					p[(axis + 2) % 3] = 2.0f * j / g - 1.0f;
+
+					const float scale = (float) (SPHERE_RADIUS / std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]));
+					for (int k = 0 ; k < 3 ; k++)
+						row[3 * i + k] = p[k] * scale;
+				}
+			};
+
+			fill_row(0, row0);
+			for (uint64_t j = 0 ; j < g ; j++)
+			{
+				fill_row(j + 1, row1);
+				for (uint64_t i = 0 ; i < g ; i++)
+				{
+					// The faces on the negative side are mirrored, so they're wound the other way
+					if (side > 0.0f)
+						emit_cell(f, &row0[3 * i], &row0[3 * i + 3], &row1[3 * i], &row1[3 * i + 3]);
+					else
+						emit_cell(f, &row0[3 * i], &row1[3 * i], &row0[3 * i + 3], &row1[3 * i + 3]);
+				}
+				row0.swap(row1);
+			}
+		}
+	}
+	else if (m_shape == SHAPE_TORUS)
+	{
+		const uint64_t around = 2 * g;
+
+		// The last row and column wrap round to the first, with the same coordinates
+		auto fill_row = [&](uint64_t j, std::vector<float>& row)
+		{
+			const double phi = 2.0 * PI * (j % g) / g;
+			const double ring = TORUS_MAJOR_RADIUS + TORUS_MINOR_RADIUS * std::cos(phi);
+
+			row.resize(3 * (around + 1));
+			for (uint64_t i = 0 ; i <= around ; i++)
+			{
+				const double theta = 2.0 * PI * (i % around) / around;
+				row[3 * i] = (float) (ring * std::cos(theta));
+				row[3 * i + 1] = (float) (ring * std::sin(theta));
+				row[3 * i + 2] = (float) (TORUS_MINOR_RADIUS * std::sin(phi));
+			}
+		};
+
+		fill_row(0, row0);
+		for (uint64_t j = 0 ; j < g ; j++)
+		{
+			fill_row(j + 1, row1);
+			for (uint64_t i = 0 ; i < around ; i++)
+				emit_cell(f, &row0[3 * i], &row0[3 * i + 3], &row1[3 * i], &row1[3 * i + 3]);
+			row0.swap(row1);
+		}
+	}
+	else
+	{
+		auto fill_row = [&](uint64_t j, std::vector<float>& row)
+		{
+			const double y = (double) j / g;
+
+			row.resize(3 * (g + 1));
+			for (uint64_t i = 0 ; i <= g ; i++)
+			{
+				const double x = (double) i / g;
+				row[3 * i] = (float) (x * NOISE_SIZE);
+				row[3 * i + 1] = (float) (y * NOISE_SIZE);
+				row[3 * i + 2] = (float) (value_noise(x, y) * NOISE_HEIGHT);
+			}
+		};
+
+		fill_row(0, row0);
+		for (uint64_t j = 0 ; j < g ; j++)
+		{
+			fill_row(j + 1, row1);
+			for (uint64_t i = 0 ; i < g ; i++)
+				emit_cell(f, &row0[3 * i], &row0[3 * i + 3], &row1[3 * i], &row1[3 * i + 3]);
+			row0.swap(row1);
+		}
+	}
+}
+
+uint64_t SyntheticSTL::Write(const std::string& filename, Format format) const
+{
+	const uint64_t num_facets = NumFacets();
+	if (format == FORMAT_BINARY && num_facets > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("Too many facets for a binary STL file");
+
+	FILE* file = std::fopen(filename.c_str(), format == FORMAT_BINARY ? "wb" : "w");
+	if (!file)
+		throw std::runtime_error("Error opening " + filename + ": " + ::strerror(errno));
+
+	std::vector<char> buffer(1 << 20);
+	std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+	const std::string name = std::string("stlview_bench ") + ShapeName(m_shape);
+
+	if (format == FORMAT_BINARY)
+	{
+		char header[80] = { 0 };
+		std::strncpy(header, name.c_str(), sizeof(header) - 1);
+		std::fwrite(header, sizeof(header), 1, file);
+
+		const uint32_t count = (uint32_t) num_facets;
+		std::fwrite(&count, sizeof(count), 1, file);
+
+		for_each_facet([file](const float* v)
+		{
+			char record[50] = { 0 };
+			float n[3];
+			facet_normal(v, n);
+
+			std::memcpy(record, n, sizeof(n));
+			std::memcpy(record + sizeof(n), v, 9 * sizeof(float));
+			std::fwrite(record, sizeof(record), 1, file);
+		});
+	}
+	else
+	{
+		std::fprintf(file, "solid %s\n", name.c_str());
+
+		for_each_facet([file](const float* v)
+		{
+			float n[3];
+			facet_normal(v, n);
+
+			std::fprintf(file, "  facet normal %e %e %e\n    outer loop\n", n[0], n[1], n[2]);
+			for (int k = 0 ; k < 3 ; k++)
+				std::fprintf(file, "      vertex %e %e %e\n", v[3 * k], v[3 * k + 1], v[3 * k + 2]);
+			std::fprintf(file, "    endloop\n  endfacet\n");
+		});
+
+		std::fprintf(file, "endsolid %s\n", name.c_str());
+	}
+
+	const bool write_error = std::ferror(file) != 0;
+	const long size = std::ftell(file);
+	if (std::fclose(file) != 0 || write_error || size < 0)
+		throw std::runtime_error("Error writing " + filename + ": " + ::strerror(errno));
+
+	return (uint64_t) size;
+}
+
+//static
+const char* SyntheticSTL::ShapeName(Shape shape)
+{
+	return SHAPE_NAMES[shape];
+}
+
+//static
+const char* SyntheticSTL::FormatName(Format format)
+{
+	return FORMAT_NAMES[format];
+}
+
+//static
+bool SyntheticSTL::ParseShape(const std::string& name, Shape& shape)
+{
+	for (int i = 0 ; i < NUM_SHAPES ; i++)
+	{
+		if (name == SHAPE_NAMES[i])
+		{
+			shape = (Shape) i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//static
+bool SyntheticSTL::ParseFormat(const std::string& name, Format& format)
+{
+	for (int i = 0 ; i < NUM_FORMATS ; i++)
+	{
+		if (name == FORMAT_NAMES[i])
+		{
+			format = (Format) i;
+			return true;
+		}
+	}
+
+	return false;
+}
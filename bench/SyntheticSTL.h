@@ -0,0 +1,70 @@
+/*
+ * SyntheticSTL.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef SYNTHETICSTL_H_
+#define SYNTHETICSTL_H_
+
+#include <string>
+#include <cstdint>
+
+/** Makes tessellated test parts of any size and writes them as STL files, for stlview_bench.
+ *
+ *  The shapes are built on regular grids, so the facet count only comes close to
+ *  the one asked for. Vertices shared between facets are computed the same way
+ *  for each facet, so the parts weld exactly.
+ */
+class SyntheticSTL
+{
+public:
+	enum Shape
+	{
+		SHAPE_SPHERE,	///< A subdivided cube pushed out to a sphere: closed, genus 0
+		SHAPE_TORUS,	///< Closed, genus 1
+		SHAPE_NOISE,	///< A height field of value noise over a square: open, with a boundary
+		NUM_SHAPES
+	};
+
+	enum Format
+	{
+		FORMAT_BINARY,
+		FORMAT_ASCII,
+		NUM_FORMATS
+	};
+
+private:
+	Shape		m_shape;
+	uint64_t	m_grid;		///< Grid cells along a side (of each cube face for the sphere)
+
+	/** Calls f(v) with the nine coordinates of each facet, in order */
+	template <typename Function>
+	void for_each_facet(Function f) const;
+
+public:
+	/** A shape with about num_facets facets, never fewer than a handful */
+	SyntheticSTL(Shape shape, uint64_t num_facets);
+
+	Shape GetShape() const { return m_shape; }
+
+	/** The number of facets it really has */
+	uint64_t NumFacets() const;
+
+	/** Writes the part to filename.
+	 *  @returns	The file size in bytes
+	 *  @throws std::runtime_error if the file couldn't be written
+	 */
+	uint64_t Write(const std::string& filename, Format format) const;
+
+	static const char* ShapeName(Shape shape);
+	static const char* FormatName(Format format);
+
+	/** @{ The value for a name, or false if there isn't one */
+	static bool ParseShape(const std::string& name, Shape& shape);
+	static bool ParseFormat(const std::string& name, Format& format);
+	/** @} */
+};
+
+#endif /* SYNTHETICSTL_H_ */
@@ -0,0 +1,672 @@
+/*
+ * stlview_bench.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include <memory>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <ctime>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <GL/gl.h>
+
+#include "SyntheticSTL.h"
+
+#include "MappedFile.h"
+#include "BinarySTLReader.h"
+#include "ASCIISTLReader.h"
+#include "VertexWelder.h"
+#include "IndexedMesh.h"
+#include "HalfEdgeMesh.h"
+#include "MeshStats.h"
+#include "SplitNormals.h"
+#include "MeshGeometry.h"
+#include "MeshLoader.h"
+#include "MeshCache.h"
+#include "DisplayObject.h"
+#include "GLCamera.h"
+#include "ViewSetup.h"
+#include "OffscreenContext.h"
+#include "Parallel.h"
+
+using std::shared_ptr;
+using std::make_shared;
+
+namespace
+{
+	/** What's timed, in the order it's done */
+	enum Stage
+	{
+		STAGE_IMPORT,			///< Reading the file into a triangle soup
+		STAGE_WELD,				///< VertexWelder
+		STAGE_MESH_BUILD,		///< HalfEdgeMesh::Build()
+		STAGE_MESH_INFO,		///< MeshStats, the numbers in the Mesh Info dialog
+		STAGE_NORMALS,			///< SplitNormals on its own
+		STAGE_GEOMETRY,			///< MeshGeometry::Build(): normals, edges and bounding box
+		STAGE_LOAD,				///< MeshLoader::Load() without a mesh cache, all of the above
+		STAGE_LOAD_CACHED,		///< MeshLoader::Load() again, from the cache the first one wrote
+		STAGE_BUILD_LISTS,		///< BuildDisplayLists() for a part and its edges, as display lists
+		STAGE_DRAW_LISTS,		///< One frame of Draw() from display lists
+		STAGE_BUILD_BUFFERS,	///< BuildDisplayLists() for a part and its edges, as buffer objects
+		STAGE_DRAW_BUFFERS,		///< One frame of Draw() from buffer objects
+		NUM_STAGES
+	};
+
+	const char* const STAGE_NAMES[NUM_STAGES] =
+	{
+		"import", "weld", "mesh_build", "mesh_info", "normals", "geometry", "load", "load_cached",
+		"build_display_lists", "draw_display_lists", "build_buffers", "draw_buffers"
+	};
+
+	/** Everything we can be told on the command line */
+	struct options
+	{
+		std::vector<SyntheticSTL::Shape>	shapes = { SyntheticSTL::SHAPE_SPHERE, SyntheticSTL::SHAPE_TORUS, SyntheticSTL::SHAPE_NOISE };
+		std::vector<SyntheticSTL::Format>	formats = { SyntheticSTL::FORMAT_BINARY, SyntheticSTL::FORMAT_ASCII };
+		std::vector<uint64_t>				sizes = { 1000, 10000, 100000, 1000000 };
+		unsigned							repeats = 3;
+		unsigned							frames = 20;
+		unsigned							num_threads = 0;
+		unsigned							width = 1024;
+		unsigned							height = 768;
+		double								weld_tolerance = 0.0;
+		double								crease_angle = SplitNormals::DEFAULT_CREASE_ANGLE;
+		bool								draw = true;
+		bool								keep_files = false;
+		std::string							work_dir = "stlview_bench_files";
+		std::string							output;
+	};
+
+	/** The timings for one generated file */
+	struct bench_case
+	{
+		SyntheticSTL::Shape		shape;
+		SyntheticSTL::Format	format;
+		uint64_t				requested_facets = 0;
+		uint64_t				num_facets = 0;
+		uint64_t				num_vertices = 0;
+		uint64_t				num_edges = 0;
+		uint64_t				file_bytes = 0;
+		double					write_ms = 0.0;
+		std::vector<double>		stage_ms[NUM_STAGES];	///< One per repeat, or per frame for the draw stages
+		std::string				error;
+	};
+
+	/** Output iterator that appends each triangle's corners to a vector, as MeshLoader does for welding */
+	class corner_inserter : public std::iterator<std::output_iterator_tag, void, void, void, void>
+	{
+	private:
+		std::vector<float>*	m_corners;
+
+	public:
+		explicit corner_inserter(std::vector<float>& corners) : m_corners(&corners) { }
+
+		/* std::iterator boilerplate */
+		corner_inserter& operator*() { return *this; }
+		corner_inserter& operator++() { return *this; }
+		corner_inserter& operator++(int) { return *this; }
+
+		corner_inserter& operator=(const STLTriangle& t)
+		{
+			m_corners->insert(m_corners->end(), t.v, t.v + 9);
+			return *this;
+		}
+	};
+
+	double ms_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	std::vector<std::string> split_list(const std::string& list)
+	{
+		std::vector<std::string> items;
+		std::istringstream ss(list);
+
+		std::string item;
+		while (std::getline(ss, item, ','))
+		{
+			if (!item.empty())
+				items.push_back(item);
+		}
+
+		return items;
+	}
+
+	/** A facet count like 5000, 10K or 100M */
+	bool parse_size(const std::string& text, uint64_t& size)
+	{
+		char* end = nullptr;
+		const double value = std::strtod(text.c_str(), &end);
+
+		double multiplier = 1.0;
+		if (*end == 'K' || *end == 'k')
+			multiplier = 1.0e3, end++;
+		else if (*end == 'M' || *end == 'm')
+			multiplier = 1.0e6, end++;
+
+		if (end == text.c_str() || *end != '\0' || !(value > 0.0))
+			return false;
+
+		size = (uint64_t) (value * multiplier + 0.5);
+		return true;
+	}
+
+	bool parse_unsigned(const std::string& text, unsigned& value)
+	{
+		char* end = nullptr;
+		const unsigned long parsed = std::strtoul(text.c_str(), &end, 10);
+		if (end == text.c_str() || *end != '\0')
+			return false;
+
+		value = (unsigned) parsed;
+		return true;
+	}
+
+	void usage(std::ostream& os)
+	{
+		os	<< "Usage: stlview_bench [OPTION...]\n"
+			<< "\n"
+			<< "Writes synthetic STL files, times loading and drawing them, and writes the times as JSON.\n"
+			<< "\n"
+			<< "  --shapes=LIST        sphere, torus and/or noise (default: all)\n"
+			<< "  --formats=LIST       binary and/or ascii (default: both)\n"
+			<< "  --sizes=LIST         Facet counts, like 1K,10K,100M (default: 1K,10K,100K,1M)\n"
+			<< "  --repeat=N           Times to run each stage (default: 3)\n"
+			<< "  --frames=N           Frames to draw for each renderer (default: 20)\n"
+			<< "  --size=WxH           The offscreen viewport (default: 1024x768)\n"
+			<< "  --no-draw            Skip the OpenGL stages\n"
+			<< "  -j, --threads=N      Threads to load with (default: one per core)\n"
+			<< "  --weld-tolerance=D   As for stlview (default: 0, exact)\n"
+			<< "  --crease-angle=D     As for stlview, in degrees\n"
+			<< "  --dir=DIR            Where to write the STL files (default: stlview_bench_files)\n"
+			<< "  --keep-files         Don't delete the STL files afterwards\n"
+			<< "  -o, --output=FILE    Write the JSON to FILE instead of standard output\n"
+			<< "  -h, --help           Show this help\n";
+	}
+
+	/** Fills in opts from argv, or returns false if it can't */
+	bool parse_args(int argc, char** argv, options& opts)
+	{
+		for (int i = 1 ; i < argc ; i++)
+		{
+			std::string arg = argv[i];
+			std::string value;
+
+			// Both --name=value and --name value
+			const size_t equals = arg.find('=');
+			const bool has_value = equals != std::string::npos;
+			if (has_value)
+			{
+				value = arg.substr(equals + 1);
+				arg.resize(equals);
+			}
+
+			auto need_value = [&]() -> bool
+			{
+				if (has_value)
+					return true;
+				if (i + 1 >= argc)
+					return false;
+
+				value = argv[++i];
+				return true;
+			};
+
+			bool ok = true;
+			if (arg == "-h" || arg == "--help")
+			{
+				usage(std::cout);
+				std::exit(0);
+			}
+			else if (arg == "--no-draw")
+				opts.draw = false;
+			else if (arg == "--keep-files")
+				opts.keep_files = true;
+			else if (!need_value())
+				ok = false;
+			else if (arg == "--shapes")
+			{
+				opts.shapes.clear();
+				for (const std::string& name : split_list(value))
+				{
+					SyntheticSTL::Shape shape;
+					ok = ok && SyntheticSTL::ParseShape(name, shape);
+					opts.shapes.push_back(shape);
+				}
+			}
+			else if (arg == "--formats")
+			{
+				opts.formats.clear();
+				for (const std::string& name : split_list(value))
+				{
+					SyntheticSTL::Format format;
+					ok = ok && SyntheticSTL::ParseFormat(name, format);
+					opts.formats.push_back(format);
+				}
+			}
+			else if (arg == "--sizes")
+			{
+				opts.sizes.clear();
+				for (const std::string& text : split_list(value))
+				{
+					uint64_t size = 0;
+					ok = ok && parse_size(text, size);
+					opts.sizes.push_back(size);
+				}
+			}
+			else if (arg == "--repeat")
+				ok = parse_unsigned(value, opts.repeats) && opts.repeats > 0;
+			else if (arg == "--frames")
+				ok = parse_unsigned(value, opts.frames);
+			else if (arg == "-j" || arg == "--threads")
+				ok = parse_unsigned(value, opts.num_threads);
+			else if (arg == "--size")
+			{
+				char extra = 0;
+				ok = std::sscanf(value.c_str(), "%ux%u%c", &opts.width, &opts.height, &extra) == 2 &&
+					 opts.width > 0 && opts.height > 0;
+			}
+			else if (arg == "--weld-tolerance")
+				opts.weld_tolerance = std::atof(value.c_str());
+			else if (arg == "--crease-angle")
+				opts.crease_angle = std::atof(value.c_str());
+			else if (arg == "--dir")
+				opts.work_dir = value;
+			else if (arg == "-o" || arg == "--output")
+				opts.output = value;
+			else
+				ok = false;
+
+			if (!ok)
+			{
+				std::cerr << "Bad option: " << argv[i] << "\n\n";
+				usage(std::cerr);
+				return false;
+			}
+		}
+
+		if (opts.shapes.empty() || opts.formats.empty() || opts.sizes.empty())
+		{
+			std::cerr << "Nothing to do" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	/** Times the stages that don't need OpenGL, and returns the geometry for the ones that do */
+	shared_ptr<MeshGeometry> run_load_stages(const std::string& filename, const options& opts, bench_case& bc)
+	{
+		const unsigned num_threads = opts.num_threads;
+		shared_ptr<MeshGeometry> geometry;
+
+		for (unsigned repeat = 0 ; repeat < opts.repeats ; repeat++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			std::vector<float> corners;
+			{
+				auto mapped_file = make_shared<MappedFile>(filename);
+				mapped_file->AdviseSequential();
+
+				if (BinarySTLReader::IsBinarySTL(*mapped_file))
+				{
+					BinarySTLReader reader(mapped_file);
+					corners.reserve(9 * reader.NumFacets());
+					reader.ImportParallel(corner_inserter(corners), num_threads);
+				}
+				else
+					ASCIISTLReader(mapped_file).ImportParallel(corner_inserter(corners), num_threads);
+			}
+			bc.stage_ms[STAGE_IMPORT].push_back(ms_since(start));
+
+			start = std::chrono::steady_clock::now();
+			IndexedMesh indexed_mesh = VertexWelder(opts.weld_tolerance, num_threads).Weld(corners);
+			bc.stage_ms[STAGE_WELD].push_back(ms_since(start));
+
+			std::vector<float>().swap(corners);
+
+			start = std::chrono::steady_clock::now();
+			HalfEdgeMesh mesh = HalfEdgeMesh::Build(std::move(indexed_mesh), num_threads);
+			bc.stage_ms[STAGE_MESH_BUILD].push_back(ms_since(start));
+
+			start = std::chrono::steady_clock::now();
+			const MeshStats stats = MeshStats::FromHalfEdgeMesh(mesh, "");
+			bc.stage_ms[STAGE_MESH_INFO].push_back(ms_since(start));
+
+			start = std::chrono::steady_clock::now();
+			SplitNormals(opts.crease_angle, num_threads).Compute(mesh);
+			bc.stage_ms[STAGE_NORMALS].push_back(ms_since(start));
+
+			start = std::chrono::steady_clock::now();
+			geometry = MeshGeometry::Build(std::move(mesh), stats, opts.crease_angle, num_threads);
+			bc.stage_ms[STAGE_GEOMETRY].push_back(ms_since(start));
+
+			bc.num_facets = geometry->NumFacets();
+			bc.num_vertices = geometry->NumVertices();
+			bc.num_edges = geometry->NumEdges();
+		}
+
+		// The whole load, as stlview does it: once writing the cache, once reading it back
+		const std::string cache_filename = MeshCache::SidecarPath(filename);
+		for (unsigned repeat = 0 ; repeat < opts.repeats ; repeat++)
+		{
+			::unlink(cache_filename.c_str());
+
+			for (Stage stage : { STAGE_LOAD, STAGE_LOAD_CACHED })
+			{
+				// Only the first load writes the cache, a second miss would just write it again
+				MeshLoader loader(filename, num_threads, opts.weld_tolerance, opts.crease_angle);
+				if (stage == STAGE_LOAD_CACHED)
+					loader.DisableCacheWrite();
+				loader.Load();
+
+				if (loader.GetState() != MeshLoader::STATE_DONE)
+					throw std::runtime_error(loader.Error());
+
+				// Without a writable cache the second load isn't cached, and its time would mislead
+				if (stage == STAGE_LOAD || loader.FromCache())
+					bc.stage_ms[stage].push_back(1000.0 * loader.Seconds());
+			}
+		}
+		::unlink(cache_filename.c_str());
+
+		return geometry;
+	}
+
+	/** Draws frames of the scene the way STLDrawArea does, each one finished before the next */
+	void draw_frames(const shared_ptr<DisplayObject>& part_do, const options& opts, std::vector<double>& frame_ms)
+	{
+		auto scene_do = make_shared<SceneDisplayObject>();
+		scene_do->AddChild(part_do);
+		scene_do->BuildDisplayLists();
+
+		GLCamera camera;
+		ViewSetup::FitCamera(camera, scene_do->GetBBox());
+		ViewSetup::LoadProjection(scene_do->GetBBox(), camera.GetViewDistance(), 1.0, opts.width, opts.height);
+
+		for (unsigned frame = 0 ; frame < opts.frames ; frame++)
+		{
+			auto const start = std::chrono::steady_clock::now();
+
+			glClearColor(1.0, 1.0, 1.0, 1.0);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			camera.GetMatrixForModelview();
+
+			glEnable(GL_CULL_FACE);
+			scene_do->Draw();
+			glDisable(GL_CULL_FACE);
+
+			glFinish();
+			frame_ms.push_back(ms_since(start));
+		}
+
+		DisplayObject::TakeSubmitted();
+	}
+
+	/** Times building and drawing the part, with each renderer the GL has */
+	void run_draw_stages(const shared_ptr<const MeshGeometry>& geometry, const options& opts, bench_case& bc)
+	{
+		for (unsigned repeat = 0 ; repeat < opts.repeats ; repeat++)
+		{
+			// As STLDrawArea::create_part_do() makes it
+			auto start = std::chrono::steady_clock::now();
+			auto part_do = make_shared<MeshDisplayObject>(geometry);
+			part_do->AddChild(make_shared<MeshEdgesDisplayObject>(geometry));
+			part_do->BuildDisplayLists();
+			glFinish();
+			bc.stage_ms[STAGE_BUILD_LISTS].push_back(ms_since(start));
+
+			draw_frames(part_do, opts, bc.stage_ms[STAGE_DRAW_LISTS]);
+		}
+
+		if (!MeshBufferDisplayObject::IsSupported())
+			return;
+
+		shared_ptr<const MeshBufferProgram> program;
+		try
+		{
+			program = make_shared<MeshBufferProgram>();
+		}
+		catch (std::exception& ex)
+		{
+			std::clog << ex.what() << ", skipping the buffer objects" << std::endl;
+			return;
+		}
+
+		for (unsigned repeat = 0 ; repeat < opts.repeats ; repeat++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			auto part_do = make_shared<MeshBufferDisplayObject>(geometry, program);
+			part_do->AddChild(make_shared<MeshEdgesBufferDisplayObject>(geometry));
+			part_do->BuildDisplayLists();
+			glFinish();
+			bc.stage_ms[STAGE_BUILD_BUFFERS].push_back(ms_since(start));
+
+			draw_frames(part_do, opts, bc.stage_ms[STAGE_DRAW_BUFFERS]);
+		}
+	}
+
+	std::string json_string(const std::string& s)
+	{
+		std::ostringstream ss;
+		ss << '"';
+
+		for (unsigned char c : s)
+		{
+			if (c == '"' || c == '\\')
+				ss << '\\' << c;
+			else if (c < 0x20)
+				ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec;
+			else
+				ss << c;
+		}
+
+		ss << '"';
+		return ss.str();
+	}
+
+	/** min, median and mean of some times, in ms */
+	void write_times_json(std::ostream& os, std::vector<double> ms)
+	{
+		std::sort(ms.begin(), ms.end());
+
+		double sum = 0.0;
+		for (double t : ms)
+			sum += t;
+
+		const size_t n = ms.size();
+		const double median = n % 2 ? ms[n / 2] : 0.5 * (ms[n / 2 - 1] + ms[n / 2]);
+
+		os	<< "{\"runs\": " << n << ", \"min_ms\": " << ms.front() << ", \"median_ms\": " << median
+			<< ", \"mean_ms\": " << sum / n << "}";
+	}
+
+	void write_json(std::ostream& os, const options& opts, const std::string& renderer, const std::vector<bench_case>& cases)
+	{
+		char date[32] = "";
+		const std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+		os << std::fixed << std::setprecision(3);
+		os	<< "{\n"
+			<< "  \"benchmark\": \"stlview_bench\",\n"
+			<< "  \"date\": " << json_string(date) << ",\n"
+			<< "  \"threads\": " << ResolveThreadCount(opts.num_threads) << ",\n"
+			<< "  \"repeats\": " << opts.repeats << ",\n"
+			<< "  \"frames\": " << opts.frames << ",\n"
+			<< "  \"viewport\": [" << opts.width << ", " << opts.height << "],\n"
+			<< "  \"weld_tolerance\": " << opts.weld_tolerance << ",\n"
+			<< "  \"crease_angle\": " << opts.crease_angle << ",\n"
+			<< "  \"gl_renderer\": " << (renderer.empty() ? "null" : json_string(renderer)) << ",\n"
+			<< "  \"cases\": [\n";
+
+		for (size_t i = 0 ; i < cases.size() ; i++)
+		{
+			const bench_case& bc = cases[i];
+
+			os	<< "    {\"shape\": \"" << SyntheticSTL::ShapeName(bc.shape) << "\""
+				<< ", \"format\": \"" << SyntheticSTL::FormatName(bc.format) << "\""
+				<< ", \"requested_facets\": " << bc.requested_facets
+				<< ", \"facets\": " << bc.num_facets
+				<< ", \"vertices\": " << bc.num_vertices
+				<< ", \"edges\": " << bc.num_edges
+				<< ", \"file_bytes\": " << bc.file_bytes
+				<< ", \"write_ms\": " << bc.write_ms;
+
+			if (!bc.error.empty())
+				os << ", \"error\": " << json_string(bc.error);
+
+			os << ",\n     \"stages\": {";
+
+			bool first = true;
+			for (int stage = 0 ; stage < NUM_STAGES ; stage++)
+			{
+				if (bc.stage_ms[stage].empty())
+					continue;
+
+				os << (first ? "\n" : ",\n") << "       \"" << STAGE_NAMES[stage] << "\": ";
+				write_times_json(os, bc.stage_ms[stage]);
+				first = false;
+			}
+
+			os << "}}" << (i + 1 < cases.size() ? "," : "") << "\n";
+		}
+
+		os	<< "  ]\n"
+			<< "}" << std::endl;
+	}
+
+	double median_ms(std::vector<double> ms)
+	{
+		if (ms.empty())
+			return 0.0;
+
+		std::nth_element(ms.begin(), ms.begin() + ms.size() / 2, ms.end());
+		return ms[ms.size() / 2];
+	}
+};
+
+int main(int argc, char** argv)
+{
+	options opts;
+	if (!parse_args(argc, argv, opts))
+		return 1;
+
+	if (::mkdir(opts.work_dir.c_str(), 0777) != 0 && errno != EEXIST)
+	{
+		std::cerr << "Error creating " << opts.work_dir << ": " << ::strerror(errno) << std::endl;
+		return 1;
+	}
+
+	// One context for everything, on this thread
+	std::unique_ptr<OffscreenContext> context;
+	std::string renderer;
+	if (opts.draw)
+	{
+		try
+		{
+			context.reset(new OffscreenContext(opts.width, opts.height));
+
+			ViewSetup::SetupLighting();
+			glShadeModel(GL_SMOOTH);
+
+			auto renderer_string = (const char*) glGetString(GL_RENDERER);
+			renderer = renderer_string ? renderer_string : "unknown";
+		}
+		catch (std::exception& ex)
+		{
+			std::clog << ex.what() << ", skipping the drawing" << std::endl;
+		}
+	}
+
+	std::vector<bench_case> cases;
+	bool failed = false;
+
+	for (uint64_t size : opts.sizes)
+	{
+		for (SyntheticSTL::Shape shape : opts.shapes)
+		{
+			const SyntheticSTL part(shape, size);
+
+			for (SyntheticSTL::Format format : opts.formats)
+			{
+				bench_case bc;
+				bc.shape = shape;
+				bc.format = format;
+				bc.requested_facets = size;
+
+				const std::string filename = opts.work_dir + "/" + SyntheticSTL::ShapeName(shape) + "-" +
+											 std::to_string(part.NumFacets()) + "-" + SyntheticSTL::FormatName(format) + ".stl";
+
+				try
+				{
+					auto const start = std::chrono::steady_clock::now();
+					bc.file_bytes = part.Write(filename, format);
+					bc.write_ms = ms_since(start);
+
+					shared_ptr<MeshGeometry> geometry = run_load_stages(filename, opts, bc);
+
+					if (context)
+						run_draw_stages(geometry, opts, bc);
+				}
+				catch (std::exception& ex)
+				{
+					bc.error = ex.what();
+					failed = true;
+				}
+
+				if (!opts.keep_files)
+					::unlink(filename.c_str());
+
+				std::clog << SyntheticSTL::ShapeName(shape) << " " << SyntheticSTL::FormatName(format) << " "
+						  << part.NumFacets() << " facets:";
+				if (!bc.error.empty())
+					std::clog << " " << bc.error;
+				for (Stage stage : { STAGE_IMPORT, STAGE_LOAD, STAGE_LOAD_CACHED, STAGE_DRAW_LISTS, STAGE_DRAW_BUFFERS })
+				{
+					if (!bc.stage_ms[stage].empty())
+						std::clog << " " << STAGE_NAMES[stage] << " " << std::fixed << std::setprecision(1)
+								  << median_ms(bc.stage_ms[stage]) << " ms";
+				}
+				std::clog << std::endl;
+
+				cases.push_back(std::move(bc));
+			}
+		}
+	}
+
+	std::ofstream output_file;
+	if (!opts.output.empty())
+	{
+		output_file.open(opts.output.c_str());
+		if (output_file.fail())
+		{
+			std::cerr << "Error opening " << opts.output << ": " << ::strerror(errno) << std::endl;
+			return 1;
+		}
+	}
+
+	write_json(opts.output.empty() ? std::cout : output_file, opts, renderer, cases);
+
+	return failed ? 2 : 0;
+}
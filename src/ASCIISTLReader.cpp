@@ -0,0 +1,228 @@
+/*
+ * ASCIISTLReader.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "ASCIISTLReader.h"
+
+#include <stdexcept>
+#include <charconv>
+#include <cctype>
+#include <algorithm>
+
+namespace
+{
+	const char		ENDFACET[] = "endfacet";
+	const size_t	ENDFACET_LEN = sizeof(ENDFACET) - 1;
+
+	inline bool is_space(char c)
+	{
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+	}
+
+	inline const char* skip_space(const char* p, const char* end)
+	{
+		while (p < end && is_space(*p))
+			++p;
+
+		return p;
+	}
+
+	inline const char* skip_token(const char* p, const char* end)
+	{
+		while (p < end && !is_space(*p))
+			++p;
+
+		return p;
+	}
+
+	/** Case-insensitive compare of the token [p, p + len) with the lowercase keyword kw */
+	inline bool is_keyword(const char* p, size_t len, const char* kw, size_t kw_len)
+	{
+		if (len != kw_len)
+			return false;
+
+		for (size_t i = 0 ; i < len ; i++)
+			if ((p[i] | 0x20) != kw[i])
+				return false;
+
+		return true;
+	}
+
+	/** The end of the first "endfacet" in any case, or end */
+	const char* find_endfacet(const char* p, const char* end)
+	{
+		for ( ; (size_t) (end - p) >= ENDFACET_LEN ; ++p)
+		{
+			if ((*p | 0x20) == 'e' && is_keyword(p, ENDFACET_LEN, ENDFACET, ENDFACET_LEN))
+				return p + ENDFACET_LEN;
+		}
+
+		return end;
+	}
+
+	const char* parse_coord(const char* p, const char* end, double& value)
+	{
+		p = skip_space(p, end);
+
+		// from_chars doesn't accept a leading '+', strtod does (but not "+-1" or "++1")
+		if (end - p >= 2 && *p == '+' && (std::isdigit((unsigned char) p[1]) || p[1] == '.'))
+			++p;
+
+		const std::from_chars_result result = std::from_chars(p, end, value);
+		if (result.ec != std::errc() || (result.ptr < end && !is_space(*result.ptr)))
+			throw std::runtime_error("Malformed vertex in ASCII STL file");
+
+		return result.ptr;
+	}
+};
+
+ASCIISTLReader::ASCIISTLReader(const std::shared_ptr<const MappedFile>& file)
+: m_file(file)
+, m_begin(nullptr)
+, m_end(nullptr)
+, m_num_blocks(0)
+{
+	if (!m_file || !IsASCIISTL(*m_file))
+		throw std::runtime_error("Not an ASCII STL file");
+
+	m_begin = m_file->Data();
+	m_end = m_begin + m_file->Size();
+	m_num_blocks = (m_file->Size() + BLOCK_BYTES - 1) / BLOCK_BYTES;
+}
+
+//static
+bool ASCIISTLReader::IsASCIISTL(const MappedFile& file)
+{
+	const char* end = file.Data() + file.Size();
+	const char* p = skip_space(file.Data(), end);
+	const char* token_end = skip_token(p, end);
+
+	return is_keyword(p, token_end - p, "solid", 5);
+}
+
+const char* ASCIISTLReader::block_start(size_t i) const
+{
+	if (i == 0)
+		return m_begin;
+
+	if (i >= m_num_blocks)
+		return m_end;
+
+	return find_endfacet(m_begin + i * BLOCK_BYTES, m_end);
+}
+
+//static
+std::string ASCIISTLReader::ParseName(const char* begin, const char* end)
+{
+	const char* p = skip_token(skip_space(begin, end), end);	// "solid"
+
+	while (p < end && (*p == ' ' || *p == '\t'))
+		++p;
+
+	const char* name_end = p;
+	while (name_end < end && *name_end != '\n' && *name_end != '\r')
+		++name_end;
+
+	while (name_end > p && is_space(*(name_end - 1)))
+		--name_end;
+
+	return std::string(p, name_end);
+}
+
+//static
+const char* ASCIISTLReader::FindLastEndFacet(const char* begin, const char* end)
+{
+	for (const char* p = end ; (size_t) (p - begin) >= ENDFACET_LEN ; --p)
+	{
+		if (is_keyword(p - ENDFACET_LEN, ENDFACET_LEN, ENDFACET, ENDFACET_LEN))
+			return p;
+	}
+
+	return begin;
+}
+
+//static
+bool ASCIISTLReader::LooksLikeASCIISTL(const char* begin, const char* end)
+{
+	const char* p = skip_space(begin, end);
+	const char* token_end = skip_token(p, end);
+
+	if (!is_keyword(p, token_end - p, "solid", 5))
+		return false;
+
+	// Skip the rest of the "solid" line, which is the name
+	p = std::find(token_end, end, '\n');
+
+	p = skip_space(p, end);
+	token_end = skip_token(p, end);
+
+	return is_keyword(p, token_end - p, "facet", 5) || is_keyword(p, token_end - p, "endsolid", 8);
+}
+
+size_t ASCIISTLReader::EstimatedNumFacets() const
+{
+	const size_t sample_facets = 64;
+
+	const char* p = m_begin;
+	size_t num_sampled = 0;
+	while (num_sampled < sample_facets)
+	{
+		const char* next = find_endfacet(p, m_end);
+		if (next == m_end)
+			break;
+
+		p = next;
+		num_sampled++;
+	}
+
+	if (num_sampled < sample_facets)
+		return num_sampled;	// we've seen the whole file
+
+	const size_t sample_bytes = p - m_begin;
+
+	return (m_file->Size() * num_sampled) / sample_bytes;
+}
+
+//static
+void ASCIISTLReader::ParseRange(const char* begin, const char* end, std::vector<STLTriangle>& triangles)
+{
+	double v[9];
+	int num_coords = 0;
+
+	const char* p = begin;
+	while (p < end)
+	{
+		p = skip_space(p, end);
+		const char* token_end = skip_token(p, end);
+
+		if (is_keyword(p, token_end - p, "vertex", 6))
+		{
+			if (num_coords == 9)
+				throw std::runtime_error("Facet with more than three vertices in ASCII STL file");
+
+			p = token_end;
+			p = parse_coord(p, end, v[num_coords++]);
+			p = parse_coord(p, end, v[num_coords++]);
+			p = parse_coord(p, end, v[num_coords++]);
+
+			continue;
+		}
+
+		if (is_keyword(p, token_end - p, "endloop", 7))
+		{
+			if (num_coords != 9)
+				throw std::runtime_error("Facet with fewer than three vertices in ASCII STL file");
+
+			STLTriangle t;
+			std::copy(v, v + 9, t.v);
+			triangles.push_back(t);
+
+			num_coords = 0;
+		}
+
+		p = token_end;
+	}
+}
@@ -0,0 +1,102 @@
+/*
+ * ASCIISTLReader.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef ASCIISTLREADER_H_
+#define ASCIISTLREADER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "TriangleBatch.h"
+
+/** Reads an ASCII STL file out of a memory mapping.
+ *
+ *  The text is cut into blocks that end just past an "endfacet" keyword,
+ *  so every block holds whole facets and can be parsed independently.
+ *  Numbers are parsed with std::from_chars, which is locale independent and
+ *  correctly rounded, so the result is the same as reading them with strtod()
+ *  in the "C" locale.
+ */
+class ASCIISTLReader
+{
+public:
+	static const size_t BLOCK_BYTES = 1 << 20;	///< Nominal block size for ImportParallel()
+
+private:
+	std::shared_ptr<const MappedFile>	m_file;
+	const char*							m_begin;
+	const char*							m_end;
+	size_t								m_num_blocks;
+
+	/** Returns the start of block i, which is just past the first "endfacet" at
+	 *  or after i * BLOCK_BYTES (or the end of the text if there isn't one).
+	 */
+	const char* block_start(size_t i) const;
+
+public:
+	/** Constructor.
+	 *  @throws std::runtime_error if the mapped file does not look like an ASCII STL file
+	 */
+	explicit ASCIISTLReader(const std::shared_ptr<const MappedFile>& file);
+
+	/** Returns true if the file starts with the "solid" keyword */
+	static bool IsASCIISTL(const MappedFile& file);
+
+	/** The solid name from the first line of the file */
+	std::string Name() const { return ParseName(m_begin, m_end); }
+
+	/** The solid name from the first line of the text [begin, end) */
+	static std::string ParseName(const char* begin, const char* end);
+
+	/** Returns the position just past the last "endfacet" (in any case) in [begin, end),
+	 *  or begin if there isn't one.
+	 */
+	static const char* FindLastEndFacet(const char* begin, const char* end);
+
+	/** Returns true if [begin, end) starts with the "solid" keyword, and the
+	 *  first keyword after that line is "facet" or "endsolid".
+	 *  Stricter than IsASCIISTL(), for when we can't check a binary file's size.
+	 */
+	static bool LooksLikeASCIISTL(const char* begin, const char* end);
+
+	/** An estimate of the number of facets in the file, from the size of the first few */
+	size_t EstimatedNumFacets() const;
+
+	/** Parses the facets in [begin, end) and appends them to triangles.
+	 *  [begin, end) must not split a facet.
+	 *  @throws std::runtime_error if a vertex is malformed
+	 */
+	static void ParseRange(const char* begin, const char* end, std::vector<STLTriangle>& triangles);
+
+	/** Writes every facet in the file to out as an STLTriangle */
+	template <typename OutputIterator>
+	void Import(OutputIterator out) const { ImportParallel(out, 1); }
+
+	/** Parses blocks of the file on num_threads worker threads (0 for the default).
+	 *  The triangles arrive at out in file order, on the calling thread.
+	 */
+	template <typename OutputIterator>
+	void ImportParallel(OutputIterator out, unsigned num_threads) const
+	{
+		ParallelOrderedBlocks<std::vector<STLTriangle>>(m_num_blocks, num_threads,
+			[this](size_t block, std::vector<STLTriangle>& triangles)
+			{
+				triangles.clear();
+				ParseRange(block_start(block), block_start(block + 1), triangles);
+			},
+			[&out](size_t, std::vector<STLTriangle>& triangles)
+			{
+				out = std::copy(triangles.begin(), triangles.end(), out);
+			});
+	}
+};
+
+#endif /* ASCIISTLREADER_H_ */
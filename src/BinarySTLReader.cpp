@@ -0,0 +1,58 @@
+/*
+ * BinarySTLReader.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "BinarySTLReader.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+	uint32_t read_facet_count(const MappedFile& file)
+	{
+		uint32_t count = 0;
+		std::memcpy(&count, file.Data() + BinarySTLReader::HEADER_SIZE, sizeof(count));
+
+		return count;
+	}
+};
+
+BinarySTLReader::BinarySTLReader(const std::shared_ptr<const MappedFile>& file)
+: m_file(file)
+, m_records(nullptr)
+, m_num_facets(0)
+{
+	if (!m_file || !IsBinarySTL(*m_file))
+		throw std::runtime_error("Not a binary STL file (facet count does not match file size)");
+
+	m_num_facets = read_facet_count(*m_file);
+	m_records = m_file->Data() + HEADER_SIZE + COUNT_SIZE;
+}
+
+//static
+bool BinarySTLReader::IsBinarySTL(const MappedFile& file)
+{
+	if (file.Size() < HEADER_SIZE + COUNT_SIZE)
+		return false;
+
+	const uint64_t num_facets = read_facet_count(file);
+
+	return (file.Size() - HEADER_SIZE - COUNT_SIZE) == num_facets * RECORD_SIZE;
+}
+
+//static
+std::string BinarySTLReader::HeaderName(const char* header)
+{
+	const char* header_end = std::find(header, header + HEADER_SIZE, '\0');
+
+	std::string name(header, header_end);
+	while (!name.empty() && std::isspace((unsigned char) name.back()))
+		name.pop_back();
+
+	return name;
+}
@@ -0,0 +1,124 @@
+/*
+ * BinarySTLReader.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef BINARYSTLREADER_H_
+#define BINARYSTLREADER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "TriangleBatch.h"
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "BinarySTLReader reads STL records in place and assumes a little-endian host"
+#endif
+
+/** Reads a binary STL file directly out of a memory mapping.
+ *
+ *  A binary STL is an 80 byte header, a 32-bit facet count, and then
+ *  one 50 byte record per facet (normal, three vertices, attribute word).
+ *  The records are decoded in place; nothing is copied out of the mapping
+ *  other than the coordinates we hand to the output iterator.
+ */
+class BinarySTLReader
+{
+public:
+	static const size_t HEADER_SIZE = 80;
+	static const size_t COUNT_SIZE = 4;
+	static const size_t RECORD_SIZE = 50;
+	static const size_t BLOCK_FACETS = 16384;	///< Facets per work item for ImportParallel()
+
+private:
+	std::shared_ptr<const MappedFile>	m_file;
+	const char*							m_records;
+	size_t								m_num_facets;
+
+public:
+	/** Constructor.
+	 *  @throws std::runtime_error if the mapped file is not a binary STL file
+	 */
+	explicit BinarySTLReader(const std::shared_ptr<const MappedFile>& file);
+
+	/** Returns true if the header facet count agrees with the file size */
+	static bool IsBinarySTL(const MappedFile& file);
+
+	size_t NumFacets() const { return m_num_facets; }
+
+	/** The header text, up to the first NUL, with trailing whitespace removed */
+	std::string Name() const { return HeaderName(m_file->Data()); }
+
+	/** The name in an 80 byte binary STL header */
+	static std::string HeaderName(const char* header);
+
+	/** Decodes the vertices of one 50 byte facet record */
+	static void DecodeRecord(const char* record, STLTriangle& t)
+	{
+		// Skip the facet normal, it gets recomputed from the vertices anyway
+		float v[9];
+		std::memcpy(v, record + 3 * sizeof(float), sizeof(v));
+
+		std::copy(v, v + 9, t.v);
+	}
+
+	/** Writes every facet in the file to out as an STLTriangle */
+	template <typename OutputIterator>
+	void Import(OutputIterator out) const { Import(out, 0, m_num_facets); }
+
+	/** Writes facets [begin, end) to out as STLTriangles */
+	template <typename OutputIterator>
+	void Import(OutputIterator out, size_t begin, size_t end) const
+	{
+		for (size_t i = begin ; i < end ; i++)
+		{
+			STLTriangle t;
+			DecodeRecord(m_records + i * RECORD_SIZE, t);
+
+			*out++ = t;
+		}
+	}
+
+	/** Like Import(), but the records are decoded in blocks of BLOCK_FACETS
+	 *  on num_threads worker threads (0 for the default).
+	 *  The triangles still arrive at out in file order, on the calling thread.
+	 */
+	template <typename OutputIterator>
+	void ImportParallel(OutputIterator out, unsigned num_threads) const
+	{
+		num_threads = ResolveThreadCount(num_threads);
+		if (num_threads == 1)
+		{
+			Import(out);
+			return;
+		}
+
+		const size_t num_blocks = (m_num_facets + BLOCK_FACETS - 1) / BLOCK_FACETS;
+
+		ParallelOrderedBlocks<std::vector<STLTriangle>>(num_blocks, num_threads,
+			[this](size_t block, std::vector<STLTriangle>& triangles)
+			{
+				const size_t begin = block * BLOCK_FACETS;
+				const size_t end = std::min(begin + BLOCK_FACETS, m_num_facets);
+
+				triangles.clear();
+				triangles.reserve(end - begin);
+				Import(std::back_inserter(triangles), begin, end);
+			},
+			[&out](size_t, std::vector<STLTriangle>& triangles)
+			{
+				out = std::copy(triangles.begin(), triangles.end(), out);
+			});
+	}
+};
+
+#endif /* BINARYSTLREADER_H_ */
@@ -5,21 +5,82 @@
  *      Author: cds
  */
 
+#define GL_GLEXT_PROTOTYPES	// Buffer objects are OpenGL 1.5, shaders 2.0
+
 #include <vectors.h>
-#include <triangle_mesh.h>
 
 #include <exception>
 #include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <limits>
+#include <cstdio>
+#include <cstddef>
+#include <cmath>
 
 #include <GL/gl.h>
+#include <GL/glext.h>
 
 #include "DisplayObject.h"
+#include "MeshGeometry.h"
 
 using maths::vector3d;
 using maths::bbox3d;
 
 using std::shared_ptr;
 
+namespace
+{
+	/** The most facets in one of MeshDisplayObject's display lists, the unit it culls in */
+	const size_t LIST_CHUNK_FACETS = 8192;
+
+	/** Per thread, as thumbnails are drawn on several threads, each with its own context */
+	thread_local DisplayObject::Submitted submitted;
+
+	/** Dequantizes MeshBuffers::Vertex, and lights it as GL_LIGHT0 and GL_COLOR_MATERIAL would,
+	 *  in the color MeshDisplayObject gives its facets, but from the corner normal
+	 */
+	const char* const MESH_VERTEX_SHADER =
+		"uniform vec3 position_offset;\n"
+		"uniform vec3 position_scale;\n"
+		"uniform bool lighting;\n"
+		"attribute vec2 octahedral_normal;\n"
+		"\n"
+		"vec3 decode_normal(vec2 e)\n"
+		"{\n"
+		"	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+		"	if (n.z < 0.0)\n"
+		"		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);\n"
+		"	return normalize(n);\n"
+		"}\n"
+		"\n"
+		"void main()\n"
+		"{\n"
+		"	vec4 position = vec4(position_offset + position_scale * gl_Vertex.xyz, 1.0);\n"
+		"	vec3 normal = decode_normal(clamp(octahedral_normal / 127.0, -1.0, 1.0));\n"
+		"	vec4 color = vec4(abs(normal), 1.0);\n"
+		"\n"
+		"	if (lighting)\n"
+		"	{\n"
+		"		vec4 eye = gl_ModelViewMatrix * position;\n"
+		"		vec4 light_position = gl_LightSource[0].position;\n"
+		"		vec3 light = light_position.w == 0.0 ? light_position.xyz : light_position.xyz - eye.xyz / eye.w;\n"
+		"		float diffuse = max(dot(normalize(gl_NormalMatrix * normal), normalize(light)), 0.0);\n"
+		"		color.rgb *= gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb + diffuse * gl_LightSource[0].diffuse.rgb;\n"
+		"	}\n"
+		"\n"
+		"	gl_FrontColor = color;\n"
+		"	gl_Position = gl_ModelViewProjectionMatrix * position;\n"
+		"}\n";
+
+	const char* const MESH_FRAGMENT_SHADER =
+		"void main()\n"
+		"{\n"
+		"	gl_FragColor = gl_Color;\n"
+		"}\n";
+};
+
 DisplayObject::DisplayObject()
 : m_display_id(glGenLists(1))
 , m_transform(4, 4)
@@ -64,9 +125,32 @@ void DisplayObject::RemoveChild(const DOPtr& display_object)
 		m_children.erase(child_it);
 }
 
-void DisplayObject::Draw() const
+//virtual
+void DisplayObject::draw_self() const
 {
 	glCallList(display_id());
+}
+
+//static
+void DisplayObject::count_submitted(size_t triangles, size_t lines, size_t points)
+{
+	submitted.triangles += triangles;
+	submitted.lines += lines;
+	submitted.points += points;
+}
+
+//static
+DisplayObject::Submitted DisplayObject::TakeSubmitted()
+{
+	const Submitted taken = submitted;
+	submitted = Submitted();
+
+	return taken;
+}
+
+void DisplayObject::Draw() const
+{
+	draw_self();
 
 	std::vector<DOPtr> child_do_queue(m_children);
 
@@ -77,7 +161,7 @@ void DisplayObject::Draw() const
 
 		if (!display_obj->Suppressed())
 		{
-			glCallList(display_obj->display_id());
+			display_obj->draw_self();
 
 			const std::vector<DOPtr> display_obj_children = display_obj->GetChildren();
 			child_do_queue.insert(child_do_queue.end(), display_obj_children.begin(), display_obj_children.end());
@@ -85,98 +169,331 @@ void DisplayObject::Draw() const
 	}
 }
 
+//virtual
+void DisplayObject::DrawProxy(size_t max_facets) const
+{
+	draw_self();
+}
+
+///////////////////////////
+// SceneDisplayObject
+
+SceneDisplayObject::SceneDisplayObject()
+{
+	BuildDisplayLists();
+}
+
+//virtual
+void SceneDisplayObject::BuildDisplayLists()
+{
+	glNewList(display_id(), GL_COMPILE);
+	glEndList();
+
+	build_child_display_lists();
+}
+
+vector3d SceneDisplayObject::GetCenter() const
+{
+	const bbox3d bbox = parts_bbox();
+
+	return bbox.is_empty() ? vector3d(0.0, 0.0, 0.0) : bbox.center();
+}
+
+bbox3d SceneDisplayObject::parts_bbox() const
+{
+	bool empty = true;
+	double bbox_min[3] = { 0.0, 0.0, 0.0 };
+	double bbox_max[3] = { 0.0, 0.0, 0.0 };
+
+	for (const DOPtr& part : children())
+	{
+		const bbox3d part_bbox = part->GetBBox();
+		if (part_bbox.is_empty())
+			continue;
+
+		const vector3d c = part_bbox.center();
+		const double part_min[3] = {	c.x() - 0.5 * part_bbox.extent_x(),
+										c.y() - 0.5 * part_bbox.extent_y(),
+										c.z() - 0.5 * part_bbox.extent_z() };
+		const double part_max[3] = {	c.x() + 0.5 * part_bbox.extent_x(),
+										c.y() + 0.5 * part_bbox.extent_y(),
+										c.z() + 0.5 * part_bbox.extent_z() };
+
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			bbox_min[k] = empty ? part_min[k] : std::min(bbox_min[k], part_min[k]);
+			bbox_max[k] = empty ? part_max[k] : std::max(bbox_max[k], part_max[k]);
+		}
+
+		empty = false;
+	}
+
+	if (empty)
+		return bbox3d();
+
+	return bbox3d(	vector3d(bbox_min[0], bbox_min[1], bbox_min[2]),
+					vector3d(bbox_max[0], bbox_max[1], bbox_max[2]));
+}
+
+//virtual
+bbox3d SceneDisplayObject::GetBBox() const
+{
+	const bbox3d bbox = parts_bbox();
+	if (bbox.is_empty())
+		return bbox;
+
+	// Drawn centered on the origin
+	const double hx = 0.5 * bbox.extent_x();
+	const double hy = 0.5 * bbox.extent_y();
+	const double hz = 0.5 * bbox.extent_z();
+
+	return bbox3d(vector3d(-hx, -hy, -hz), vector3d(hx, hy, hz));
+}
+
+//virtual
+void SceneDisplayObject::Draw() const
+{
+	const vector3d center = GetCenter();
+
+	glPushMatrix();
+	glTranslated(-center.x(), -center.y(), -center.z());
+
+	DisplayObject::Draw();
+
+	glPopMatrix();
+}
+
+//virtual
+void SceneDisplayObject::DrawProxy(size_t max_facets) const
+{
+	const vector3d center = GetCenter();
+
+	glPushMatrix();
+	glTranslated(-center.x(), -center.y(), -center.z());
+
+	size_t num_facets = 0;
+	for (const DOPtr& part : children())
+		num_facets += part->NumFacets();
+
+	for (const DOPtr& part : children())
+	{
+		if (part->Suppressed())
+			continue;
+
+		const double share = num_facets > 0 ? (double) part->NumFacets() / num_facets : 1.0;
+		part->DrawProxy((size_t) (share * max_facets));
+	}
+
+	glPopMatrix();
+}
+
 ///////////////////////////
 // MeshDisplayObject
 
-MeshDisplayObject::MeshDisplayObject(shared_ptr<triangle_mesh> mesh)
-: m_mesh(mesh)
+MeshDisplayObject::MeshDisplayObject(shared_ptr<const MeshGeometry> geometry)
+: m_geometry(geometry)
+, m_first_chunk_id(0)
+, m_num_chunks(0)
 {
 
 }
 
-//static
-bool MeshDisplayObject::is_sharp_edge_boundary(const mesh_facet & f1, const mesh_facet & f2)
+MeshDisplayObject::~MeshDisplayObject()
+{
+	delete_chunk_lists();
+}
+
+void MeshDisplayObject::delete_chunk_lists()
 {
-	// TODO - Maybe this should only be for convex facet edges
-	// Also TODO - gank mesh edge concavity code from work ;)
-	const double tol = 1.0e-4;
-	const double cos_norms = f1.get_normal() * f2.get_normal();
-	return cos_norms < M_PI_4 - tol;
+	if (m_num_chunks > 0)
+		glDeleteLists(m_first_chunk_id, m_num_chunks);
+
+	m_first_chunk_id = 0;
+	m_num_chunks = 0;
+	m_bvh = MeshBVH();
 }
 
 //virtual
 void MeshDisplayObject::BuildDisplayLists()
 {
-	glNewList(display_id(), GL_COMPILE);
+	auto const compile_start = std::chrono::steady_clock::now();
 
-	const std::vector<mesh_facet_ptr>& mesh_facets = m_mesh->get_facets();
+	delete_chunk_lists();
 
-	const maths::vector3d x(1.0, 0.0, 0.0);
-	const maths::vector3d y(0.0, 1.0, 0.0);
-	const maths::vector3d z(0.0, 0.0, 1.0);
+	const MeshGeometry& geometry = *m_geometry;
+	const std::vector<uint32_t> order = MeshBVH::SpatialOrder(geometry);
+	const GLsizei num_chunks = (GLsizei) ((order.size() + LIST_CHUNK_FACETS - 1) / LIST_CHUNK_FACETS);
 
-	//glColor4fv(green);
-	glBegin(GL_TRIANGLES);
+	if (num_chunks > 0)
 	{
-		for (const mesh_facet_ptr& facet : mesh_facets)
-		{
-			std::vector<mesh_vertex_ptr> verts = facet->get_verts();
+		m_first_chunk_id = glGenLists(num_chunks);
+		if (m_first_chunk_id == 0)
+			throw std::runtime_error("Error creating display lists");
 
-			const vector3d& facet_normal = facet->get_normal();
-			// TODO - enable per-facet normal
+		m_num_chunks = num_chunks;
+	}
 
-			const double facet_x = maths::abs(facet_normal * x);
-			const double facet_y = maths::abs(facet_normal * y);
-			const double facet_z = maths::abs(facet_normal * z);
+	std::vector<MeshBVH::Box> boxes(num_chunks);
+	for (GLsizei c = 0 ; c < num_chunks ; c++)
+	{
+		MeshBVH::Box& box = boxes[c];
+		std::fill(box.min, box.min + 3, std::numeric_limits<float>::max());
+		std::fill(box.max, box.max + 3, -std::numeric_limits<float>::max());
 
-			glColor3d(facet_x, facet_y, facet_z);
+		const size_t first = c * LIST_CHUNK_FACETS;
+		const size_t last = std::min(order.size(), first + LIST_CHUNK_FACETS);
 
-			//assert(verts.size() == 3);
-			for (int i = 0 ; i < 3 ; i++)
+		glNewList(m_first_chunk_id + c, GL_COMPILE);
+		glBegin(GL_TRIANGLES);
+		{
+			for (size_t i = first ; i < last ; i++)
 			{
-				mesh_vertex_ptr vert = verts[i];
-				const vector3d v_point = vert->get_point();
-				const vector3d v_normal = vert->get_normal();	// TODO - option for per-vertex normals
-
-				// If the vertex has any adjacent triangles with facet normals > 45 degrees
-				// from eachother, then just use the facet normal rather than the vertex normal.
-				std::vector<mesh_facet_ptr> vert_facets = vert->get_adjacent_facets();
-				std::vector<mesh_facet_ptr>::iterator sharp_neighbor =
-					std::find_if(vert_facets.begin(), vert_facets.end(),
-						[&facet](const mesh_facet_ptr & vf)
-						{ return MeshDisplayObject::is_sharp_edge_boundary(*facet, *vf); });
-
-				if (sharp_neighbor != vert_facets.end())
-					glNormal3d(facet_normal.x(), facet_normal.y(), facet_normal.z());	// found sharp edge
-				else
-					glNormal3d(v_normal.x(), v_normal.y(), v_normal.z());
-
-				glVertex3d(v_point.x(), v_point.y(), v_point.z());
+				const size_t f = order[i];
+
+				float facet_normal[3];
+				geometry.FacetNormal(f, facet_normal);
+
+				glColor3f(std::fabs(facet_normal[0]), std::fabs(facet_normal[1]), std::fabs(facet_normal[2]));
+
+				// The corner normals are already split along sharp edges
+				for (int k = 0 ; k < 3 ; k++)
+				{
+					const float* p = geometry.CornerPosition(f, k);
+					for (int j = 0 ; j < 3 ; j++)
+					{
+						box.min[j] = std::min(box.min[j], p[j]);
+						box.max[j] = std::max(box.max[j], p[j]);
+					}
+
+					glNormal3fv(&geometry.normals[9 * f + 3 * k]);
+					glVertex3fv(p);
+				}
 			}
 		}
+		glEnd(); // GL_TRIANGLES
+		glEndList();
 	}
-	glEnd(); // GL_TRIANGLES
 
+	m_bvh = MeshBVH::Build(boxes);
+
+	// Nothing goes in the object's own list, draw_self() calls the chunks
+	glNewList(display_id(), GL_COMPILE);
 	glEndList();
 
+	std::chrono::duration<double, std::milli> const compile_time = std::chrono::steady_clock::now() - compile_start;
+	std::clog	<< "Compiled " << m_num_chunks << " display lists for " << geometry.NumFacets() << " facets in "
+				<< std::fixed << std::setprecision(1) << compile_time.count() << " ms" << std::endl;
+
 	build_child_display_lists();
 }
 
+//virtual
+void MeshDisplayObject::draw_self() const
+{
+	m_bvh.Cull(Frustum::FromGL(),
+		[this](uint32_t first_chunk, uint32_t num_chunks)
+		{
+			for (uint32_t c = first_chunk ; c < first_chunk + num_chunks ; c++)
+				glCallList(m_first_chunk_id + c);
+
+			const size_t first_facet = first_chunk * LIST_CHUNK_FACETS;
+			count_submitted(std::min(m_geometry->NumFacets(), first_facet + num_chunks * LIST_CHUNK_FACETS) - first_facet, 0);
+		});
+}
+
+//virtual
+void MeshDisplayObject::DrawProxy(size_t max_facets) const
+{
+	const MeshGeometry& geometry = *m_geometry;
+	if (geometry.NumFacets() <= max_facets)
+	{
+		draw_self();
+		return;
+	}
+
+	// Points are cheaper than facets, but not by as much in immediate mode
+	const size_t stride = (geometry.NumFacets() + max_facets) / std::max<size_t>(1, max_facets);
+
+	glPushAttrib(GL_POINT_BIT);
+	glPointSize(2.0f);
+
+	glBegin(GL_POINTS);
+	for (size_t f = 0 ; f < geometry.NumFacets() ; f += stride)
+	{
+		float facet_normal[3];
+		geometry.FacetNormal(f, facet_normal);
+
+		glColor3f(std::fabs(facet_normal[0]), std::fabs(facet_normal[1]), std::fabs(facet_normal[2]));
+		glNormal3fv(&geometry.normals[9 * f]);
+		glVertex3fv(geometry.CornerPosition(f, 0));
+	}
+	glEnd(); // GL_POINTS
+
+	glPopAttrib();
+
+	count_submitted(0, 0, (geometry.NumFacets() + stride - 1) / stride);
+}
+
+//virtual
+size_t MeshDisplayObject::NumFacets() const
+{
+	return m_geometry->NumFacets();
+}
+
 //virtual
 bbox3d MeshDisplayObject::GetBBox() const
 {
-	return m_mesh->bbox();
+	return m_geometry->BBox();
+}
+
+///////////////////////////
+// EdgesDisplayObject
+
+EdgesDisplayObject::EdgesDisplayObject(shared_ptr<const MeshGeometry> geometry)
+: m_geometry(geometry)
+, m_feature_angle(0.0)
+{
+
+}
+
+size_t EdgesDisplayObject::num_edges_to_draw() const
+{
+	return m_geometry->NumFeatureEdges(m_feature_angle);
+}
+
+//virtual
+bbox3d EdgesDisplayObject::GetBBox() const
+{
+	return m_geometry->BBox();
 }
 
 ///////////////////////////
 // MeshEdgesDisplayObject
 
-MeshEdgesDisplayObject::MeshEdgesDisplayObject(shared_ptr<triangle_mesh> mesh)
-: m_mesh(mesh)
+MeshEdgesDisplayObject::MeshEdgesDisplayObject(shared_ptr<const MeshGeometry> geometry)
+: EdgesDisplayObject(geometry)
+, m_num_lines(0)
 {
 
 }
 
+//virtual
+void MeshEdgesDisplayObject::draw_self() const
+{
+	DisplayObject::draw_self();
+	count_submitted(0, m_num_lines);
+}
+
+//virtual
+void MeshEdgesDisplayObject::SetFeatureAngle(double feature_angle)
+{
+	if (feature_angle == m_feature_angle)
+		return;
+
+	EdgesDisplayObject::SetFeatureAngle(feature_angle);
+	BuildDisplayLists();
+}
+
 //virtual
 void MeshEdgesDisplayObject::BuildDisplayLists()
 {
@@ -191,44 +508,558 @@ void MeshEdgesDisplayObject::BuildDisplayLists()
 	glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
 	glHint(GL_POLYGON_SMOOTH_HINT, GL_NICEST);
 
+	const MeshGeometry& geometry = *m_geometry;
+
 	glBegin(GL_LINES);
 
 	// First, do the edges in the mesh
 	glColor3d(0, 0, 0);
 
-	const auto& mesh_edges = m_mesh->get_edges();
-	for (const auto& mesh_edge : mesh_edges)
+	const size_t num_edges = num_edges_to_draw();
+	for (size_t i = 0 ; i < 2 * num_edges ; i++)
+		glVertex3fv(&geometry.positions[3 * geometry.edges[i]]);
+
+	// Next, do the lamina edges
+	glColor3d(1.0, 1.0, 0.0);
+
+	for (uint32_t v : geometry.lamina_edges)
+		glVertex3fv(&geometry.positions[3 * v]);
+
+	glEnd(); // GL_LINES
+
+	glDisable(GL_BLEND);
+
+	glEndList();
+
+	m_num_lines = num_edges + geometry.lamina_edges.size() / 2;
+
+	build_child_display_lists();
+}
+
+///////////////////////////
+// MeshBufferProgram
+
+MeshBufferProgram::MeshBufferProgram()
+: m_program(MESH_VERTEX_SHADER, MESH_FRAGMENT_SHADER)
+, position_offset_location(m_program.UniformLocation("position_offset"))
+, position_scale_location(m_program.UniformLocation("position_scale"))
+, lighting_location(m_program.UniformLocation("lighting"))
+, normal_location(m_program.AttribLocation("octahedral_normal"))
+{
+
+}
+
+///////////////////////////
+// MeshBufferDisplayObject
+
+MeshBufferDisplayObject::MeshBufferDisplayObject(shared_ptr<const MeshGeometry> geometry, shared_ptr<const MeshBufferProgram> program)
+: m_geometry(geometry)
+, m_program(program)
+, m_vertex_buffer(GL_ARRAY_BUFFER)
+, m_index_buffer(GL_ELEMENT_ARRAY_BUFFER)
+, m_uploaded(false)
+{
+	std::fill(m_position_offset, m_position_offset + 3, 0.0f);
+	std::fill(m_position_scale, m_position_scale + 3, 1.0f);
+}
+
+//static
+bool MeshBufferDisplayObject::IsSupported()
+{
+	auto version_string = (const char*) glGetString(GL_VERSION);
+
+	int major = 0, minor = 0;
+	if (!version_string || std::sscanf(version_string, "%d.%d", &major, &minor) != 2)
+		return false;
+
+	return major >= 2;
+}
+
+void MeshBufferDisplayObject::Stage(const shared_ptr<const MeshBuffers>& buffers)
+{
+	m_staged = buffers;
+	m_chunks = buffers->chunks;
+	m_bvh = buffers->bvh;
+	m_meshlets = buffers->meshlets;
+	std::copy(buffers->position_offset, buffers->position_offset + 3, m_position_offset);
+	std::copy(buffers->position_scale, buffers->position_scale + 3, m_position_scale);
+	m_uploaded = false;
+
+	m_vertex_buffer.Stage(buffers->vertices.data(), buffers->vertices.size() * sizeof(MeshBuffers::Vertex));
+	m_index_buffer.Stage(buffers->indices.data(), buffers->indices.size() * sizeof(uint32_t));
+}
+
+bool MeshBufferDisplayObject::Upload(size_t max_bytes)
+{
+	if (m_uploaded)
+		return true;
+
+	max_bytes -= m_vertex_buffer.Upload(max_bytes);
+	m_index_buffer.Upload(max_bytes);
+
+	m_uploaded = m_vertex_buffer.IsUploaded() && m_index_buffer.IsUploaded();
+	if (m_uploaded)
+		m_staged.reset();
+
+	return m_uploaded;
+}
+
+//virtual
+void MeshBufferDisplayObject::BuildDisplayLists()
+{
+	auto const compile_start = std::chrono::steady_clock::now();
+
+	// Draw calls bigger than these may fall off the driver's fast path
+	GLint max_indices = 0, max_vertices = 0;
+	glGetIntegerv(GL_MAX_ELEMENTS_INDICES, &max_indices);
+	glGetIntegerv(GL_MAX_ELEMENTS_VERTICES, &max_vertices);
+
+	const size_t default_max = 1 << 16;
+	auto buffers = std::make_shared<MeshBuffers>(MeshBuffers::Build(*m_geometry,
+		max_indices > 0 ? (size_t) max_indices : default_max,
+		max_vertices > 0 ? (size_t) max_vertices : default_max));
+
+	Stage(buffers);
+	Upload(std::numeric_limits<size_t>::max());
+
+	// Nothing goes in the display list, draw_self() draws the buffers
+	glNewList(display_id(), GL_COMPILE);
+	glEndList();
+
+	std::chrono::duration<double, std::milli> const compile_time = std::chrono::steady_clock::now() - compile_start;
+	std::clog	<< "Built buffers for " << m_geometry->NumFacets() << " facets: " << buffers->vertices.size() << " vertices, "
+				<< m_chunks.size() << " draw calls, " << std::fixed << std::setprecision(1)
+				<< buffers->SizeBytes() / (1024.0 * 1024.0) << " MB in " << compile_time.count() << " ms, ACMR "
+				<< std::setprecision(2) << buffers->acmr << " (was " << buffers->unoptimized_acmr << ")" << std::endl;
+
+	build_child_display_lists();
+}
+
+void MeshBufferDisplayObject::begin_vertices() const
+{
+	const GLsizei stride = (GLsizei) sizeof(MeshBuffers::Vertex);
+
+	m_program->Use();
+	glUniform3fv(m_program->position_offset_location, 1, m_position_offset);
+	glUniform3fv(m_program->position_scale_location, 1, m_position_scale);
+	glUniform1i(m_program->lighting_location, glIsEnabled(GL_LIGHTING) ? 1 : 0);
+
+	m_vertex_buffer.Bind();
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_SHORT, stride, (const GLvoid*) offsetof(MeshBuffers::Vertex, position));
+
+	if (m_program->normal_location >= 0)
 	{
-		const vector3d start_pt = mesh_edge->p0();
-		const vector3d end_pt = mesh_edge->p1();
+		glEnableVertexAttribArray(m_program->normal_location);
+		glVertexAttribPointer(m_program->normal_location, 2, GL_BYTE, GL_FALSE, stride, (const GLvoid*) offsetof(MeshBuffers::Vertex, normal));
+	}
+}
+
+void MeshBufferDisplayObject::end_vertices() const
+{
+	if (m_program->normal_location >= 0)
+		glDisableVertexAttribArray(m_program->normal_location);
+
+	m_vertex_buffer.Unbind();
+	m_program->Unuse();
+}
+
+//virtual
+void MeshBufferDisplayObject::draw_self() const
+{
+	if (!m_uploaded)
+		return;
+
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
 
-		glVertex3d(start_pt.x(), start_pt.y(), start_pt.z());
-		glVertex3d(end_pt.x(), end_pt.y(), end_pt.z());
+	begin_vertices();
+	m_index_buffer.Bind();
+
+	const Frustum frustum = Frustum::FromGL();
+
+	// Only what the GL would cull anyway can be skipped
+	GLint cull_mode = 0, front_face = 0;
+	glGetIntegerv(GL_CULL_FACE_MODE, &cull_mode);
+	glGetIntegerv(GL_FRONT_FACE, &front_face);
+	const bool cull_meshlets = glIsEnabled(GL_CULL_FACE) && cull_mode == GL_BACK && front_face == GL_CCW &&
+							   m_meshlets.Size() > 0;
+
+	if (cull_meshlets)
+	{
+		m_meshlets.FrontFacing(frustum, m_front);
+		m_draw_counts.clear();
+		m_draw_offsets.clear();
 	}
 
-	// Next, do the lamina halfedges
-	glColor3d(1.0, 1.0, 0.0);
-	const auto lamina_halfedges = m_mesh->get_lamina_halfedges();
-	for (const auto& mesh_lamina_he : lamina_halfedges)
+	m_bvh.Cull(frustum,
+		[this, cull_meshlets](uint32_t first_chunk, uint32_t num_chunks)
+		{
+			for (uint32_t c = first_chunk ; c < first_chunk + num_chunks ; c++)
+			{
+				const MeshBuffers::Chunk& chunk = m_chunks[c];
+				if (!cull_meshlets)
+				{
+					glDrawRangeElements(GL_TRIANGLES, chunk.min_vertex, chunk.max_vertex, (GLsizei) chunk.num_indices,
+										GL_UNSIGNED_INT, (const GLvoid*) (chunk.first_index * sizeof(uint32_t)));
+					count_submitted(chunk.num_indices / 3, 0);
+					continue;
+				}
+
+				// Consecutive front facing meshlets in a chunk make one range
+				bool extend = false;
+				for (uint32_t m = chunk.first_meshlet ; m < chunk.first_meshlet + chunk.num_meshlets ; m++)
+				{
+					if (!m_front[m])
+					{
+						extend = false;
+						continue;
+					}
+
+					count_submitted(m_meshlets.num_indices[m] / 3, 0);
+
+					if (extend)
+					{
+						m_draw_counts.back() += (GLsizei) m_meshlets.num_indices[m];
+					}
+					else
+					{
+						m_draw_counts.push_back((GLsizei) m_meshlets.num_indices[m]);
+						m_draw_offsets.push_back((const GLvoid*) (m_meshlets.first_index[m] * sizeof(uint32_t)));
+						extend = true;
+					}
+				}
+			}
+		});
+
+	if (cull_meshlets && !m_draw_counts.empty())
 	{
-		const vector3d start_pt = mesh_lamina_he->get_start_point();
-		const vector3d end_pt = mesh_lamina_he->get_end_point();
+		glMultiDrawElements(GL_TRIANGLES, m_draw_counts.data(), GL_UNSIGNED_INT,
+							m_draw_offsets.data(), (GLsizei) m_draw_counts.size());
+	}
+
+	m_index_buffer.Unbind();
+	end_vertices();
+
+	glPopClientAttrib();
+}
 
-		glVertex3d(start_pt.x(), start_pt.y(), start_pt.z());
-		glVertex3d(end_pt.x(), end_pt.y(), end_pt.z());
+//virtual
+void MeshBufferDisplayObject::DrawProxy(size_t max_facets) const
+{
+	if (m_geometry->NumFacets() <= max_facets)
+	{
+		draw_self();
+		return;
 	}
 
-	glEnd(); // GL_LINES
+	if (!m_uploaded || !m_vertex_buffer.Size())
+		return;
 
-	glDisable(GL_BLEND);
+	// Every so many vertices, one single point draw each. Stepping over the others in the
+	// vertex pointer instead would soon pass the GL's maximum attribute stride.
+	const size_t num_vertices = m_vertex_buffer.Size() / sizeof(MeshBuffers::Vertex);
+	const size_t vertex_stride = (m_geometry->NumFacets() + max_facets) / std::max<size_t>(1, max_facets);
+	const size_t num_points = (num_vertices + vertex_stride - 1) / vertex_stride;
+
+	m_draw_firsts.resize(num_points);
+	m_draw_counts.assign(num_points, 1);
+	for (size_t i = 0 ; i < num_points ; i++)
+		m_draw_firsts[i] = (GLint) (i * vertex_stride);
+
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glPushAttrib(GL_POINT_BIT);
+	glPointSize(2.0f);
+
+	begin_vertices();
 
+	glMultiDrawArrays(GL_POINTS, m_draw_firsts.data(), m_draw_counts.data(), (GLsizei) num_points);
+	count_submitted(0, 0, num_points);
+
+	end_vertices();
+
+	glPopAttrib();
+	glPopClientAttrib();
+}
+
+//virtual
+size_t MeshBufferDisplayObject::NumFacets() const
+{
+	return m_geometry->NumFacets();
+}
+
+//virtual
+bbox3d MeshBufferDisplayObject::GetBBox() const
+{
+	return m_geometry->BBox();
+}
+
+///////////////////////////
+// MeshEdgesBufferDisplayObject
+
+MeshEdgesBufferDisplayObject::MeshEdgesBufferDisplayObject(shared_ptr<const MeshGeometry> geometry)
+: EdgesDisplayObject(geometry)
+, m_position_buffer(GL_ARRAY_BUFFER)
+, m_index_buffer(GL_ELEMENT_ARRAY_BUFFER)
+, m_num_indices(0)
+, m_num_lamina_indices(0)
+, m_uploaded(false)
+{
+	std::fill(m_position_offset, m_position_offset + 3, 0.0f);
+	std::fill(m_position_scale, m_position_scale + 3, 1.0f);
+}
+
+void MeshEdgesBufferDisplayObject::Stage(const shared_ptr<const MeshBuffers>& buffers)
+{
+	m_staged = buffers;
+	m_num_indices = buffers->edge_indices.size();
+	m_num_lamina_indices = buffers->num_lamina_indices;
+	std::copy(buffers->position_offset, buffers->position_offset + 3, m_position_offset);
+	std::copy(buffers->position_scale, buffers->position_scale + 3, m_position_scale);
+	m_uploaded = false;
+
+	m_position_buffer.Stage(buffers->edge_positions.data(), buffers->edge_positions.size() * sizeof(int16_t));
+	m_index_buffer.Stage(buffers->edge_indices.data(), buffers->edge_indices.size() * sizeof(uint32_t));
+}
+
+bool MeshEdgesBufferDisplayObject::Upload(size_t max_bytes)
+{
+	if (m_uploaded)
+		return true;
+
+	max_bytes -= m_position_buffer.Upload(max_bytes);
+	m_index_buffer.Upload(max_bytes);
+
+	m_uploaded = m_position_buffer.IsUploaded() && m_index_buffer.IsUploaded();
+	if (m_uploaded)
+		m_staged.reset();
+
+	return m_uploaded;
+}
+
+//virtual
+void MeshEdgesBufferDisplayObject::BuildDisplayLists()
+{
+	Stage(std::make_shared<MeshBuffers>(MeshBuffers::BuildEdges(*m_geometry)));
+	Upload(std::numeric_limits<size_t>::max());
+
+	glNewList(display_id(), GL_COMPILE);
 	glEndList();
 
 	build_child_display_lists();
 }
 
 //virtual
-bbox3d MeshEdgesDisplayObject::GetBBox() const
+void MeshEdgesBufferDisplayObject::draw_self() const
 {
-	return m_mesh->bbox();
+	if (!m_uploaded)
+		return;
+
+	// The same look as MeshEdgesDisplayObject
+	glPushAttrib(GL_ENABLE_BIT | GL_LINE_BIT | GL_COLOR_BUFFER_BIT | GL_HINT_BIT | GL_CURRENT_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+	glLineWidth(2.5);
+	glEnable(GL_BLEND);
+	glBlendColor(0.0, 0.8, 0.2, 1.0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_LINE_SMOOTH);
+	glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+
+	m_position_buffer.Bind();
+	m_index_buffer.Bind();
+
+	// Dequantized as MeshBufferProgram does for the facets, so the edges don't sink into them
+	glPushMatrix();
+	glTranslatef(m_position_offset[0], m_position_offset[1], m_position_offset[2]);
+	glScalef(m_position_scale[0], m_position_scale[1], m_position_scale[2]);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_SHORT, 0, nullptr);
+
+	// The edges come sharpest first, so the feature edges are the first ones
+	const size_t num_edge_indices = m_num_indices - m_num_lamina_indices;
+	const size_t num_draw_indices = std::min(num_edge_indices, 2 * num_edges_to_draw());
+
+	// First, do the edges in the mesh
+	glColor3d(0, 0, 0);
+	glDrawElements(GL_LINES, (GLsizei) num_draw_indices, GL_UNSIGNED_INT, nullptr);
+
+	// Next, do the lamina edges
+	glColor3d(1.0, 1.0, 0.0);
+	glDrawElements(GL_LINES, (GLsizei) m_num_lamina_indices, GL_UNSIGNED_INT, (const GLvoid*) (num_edge_indices * sizeof(uint32_t)));
+
+	count_submitted(0, (num_draw_indices + m_num_lamina_indices) / 2);
+
+	glPopMatrix();
+
+	m_index_buffer.Unbind();
+	m_position_buffer.Unbind();
+
+	glPopClientAttrib();
+	glPopAttrib();
+}
+
+///////////////////////////
+// LODDisplayObject
+
+LODDisplayObject::LODDisplayObject(const DOPtr& full_detail)
+: m_selected(0)
+{
+	m_levels.push_back({ full_detail, 0.0 });
+
+	BuildDisplayLists();
+}
+
+void LODDisplayObject::AddLevel(const DOPtr& display_object, double error)
+{
+	m_levels.push_back({ display_object, error });
+}
+
+bool LODDisplayObject::SelectLevel(double pixels_per_unit, double max_pixel_error)
+{
+	// The errors grow with the levels
+	size_t selected = 0;
+	while (selected + 1 < m_levels.size() && m_levels[selected + 1].error * pixels_per_unit <= max_pixel_error)
+		selected++;
+
+	const bool changed = selected != m_selected;
+	m_selected = selected;
+
+	return changed;
+}
+
+//virtual
+void LODDisplayObject::draw_self() const
+{
+	m_levels[m_selected].display_object->Draw();
+}
+
+//virtual
+void LODDisplayObject::BuildDisplayLists()
+{
+	// Nothing of our own, the levels are built by whoever made them
+	glNewList(display_id(), GL_COMPILE);
+	glEndList();
+}
+
+//virtual
+bbox3d LODDisplayObject::GetBBox() const
+{
+	return m_levels.front().display_object->GetBBox();
+}
+
+//virtual
+void LODDisplayObject::DrawProxy(size_t max_facets) const
+{
+	size_t level = m_selected;
+	while (level + 1 < m_levels.size() && m_levels[level].display_object->NumFacets() > max_facets)
+		level++;
+
+	m_levels[level].display_object->DrawProxy(max_facets);
+}
+
+//virtual
+size_t LODDisplayObject::NumFacets() const
+{
+	return m_levels.front().display_object->NumFacets();
+}
+
+///////////////////////////
+// PreviewDisplayObject
+
+PreviewDisplayObject::PreviewDisplayObject()
+: m_num_triangles(0)
+{
+	std::fill(m_bbox_min, m_bbox_min + 3, std::numeric_limits<float>::infinity());
+	std::fill(m_bbox_max, m_bbox_max + 3, -std::numeric_limits<float>::infinity());
+
+	BuildDisplayLists();
+}
+
+PreviewDisplayObject::~PreviewDisplayObject()
+{
+	for (GLuint batch_id : m_batch_ids)
+		glDeleteLists(batch_id, 1);
+}
+
+void PreviewDisplayObject::AppendTriangles(const std::vector<float>& corners)
+{
+	if (corners.size() < 9)
+		return;
+
+	const GLuint batch_id = glGenLists(1);
+	if (batch_id == 0)
+		throw std::runtime_error("Error creating display list");
+
+	glNewList(batch_id, GL_COMPILE);
+	glBegin(GL_TRIANGLES);
+
+	for (size_t i = 0 ; i + 9 <= corners.size() ; i += 9)
+	{
+		const float* c = &corners[i];
+
+		// Flat shaded; we don't have any adjacency yet
+		const float e1[3] = { c[3] - c[0], c[4] - c[1], c[5] - c[2] };
+		const float e2[3] = { c[6] - c[0], c[7] - c[1], c[8] - c[2] };
+		float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+		const float n_len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (n_len > 0.0f)
+		{
+			n[0] /= n_len;
+			n[1] /= n_len;
+			n[2] /= n_len;
+		}
+
+		glColor3f(std::fabs(n[0]), std::fabs(n[1]), std::fabs(n[2]));
+		glNormal3fv(n);
+
+		for (int k = 0 ; k < 9 ; k += 3)
+		{
+			glVertex3fv(c + k);
+
+			for (int j = 0 ; j < 3 ; j++)
+			{
+				m_bbox_min[j] = std::min(m_bbox_min[j], c[k + j]);
+				m_bbox_max[j] = std::max(m_bbox_max[j], c[k + j]);
+			}
+		}
+	}
+
+	glEnd(); // GL_TRIANGLES
+	glEndList();
+
+	m_batch_ids.push_back(batch_id);
+	m_num_triangles += corners.size() / 9;
+
+	BuildDisplayLists();
+}
+
+//virtual
+void PreviewDisplayObject::draw_self() const
+{
+	DisplayObject::draw_self();
+	count_submitted(m_num_triangles, 0);
+}
+
+//virtual
+void PreviewDisplayObject::BuildDisplayLists()
+{
+	glNewList(display_id(), GL_COMPILE);
+
+	for (GLuint batch_id : m_batch_ids)
+		glCallList(batch_id);
+
+	glEndList();
+}
+
+//virtual
+bbox3d PreviewDisplayObject::GetBBox() const
+{
+	if (m_num_triangles == 0)
+		return bbox3d();
+
+	return bbox3d(	vector3d(m_bbox_min[0], m_bbox_min[1], m_bbox_min[2]),
+					vector3d(m_bbox_max[0], m_bbox_max[1], m_bbox_max[2]));
 }
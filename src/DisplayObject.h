@@ -14,7 +14,12 @@
 #include <vector>
 #include <memory>
 
-class triangle_mesh;
+#include "MeshBuffers.h"
+#include "MeshBVH.h"
+#include "GLBuffer.h"
+#include "GLProgram.h"
+
+struct MeshGeometry;
 
 // An OpenGL display object
 // All displayed objects must subclass this object
@@ -24,6 +29,14 @@ public:
 	typedef std::shared_ptr<DisplayObject>			DOPtr;
 	typedef std::shared_ptr<const DisplayObject>	ConstDOPtr;
 
+	/** What the display objects have sent to the GL, for the frame statistics */
+	struct Submitted
+	{
+		size_t	triangles = 0;
+		size_t	lines = 0;
+		size_t	points = 0;
+	};
+
 private:
 	GLuint						m_display_id;
 	maths::matrix<float>		m_transform;
@@ -33,9 +46,18 @@ private:
 protected:
 	void 	build_child_display_lists();
 	GLuint	display_id() const 							{ return m_display_id; }
+	const	std::vector<DOPtr>& children() const		{ return m_children; }
 			maths::matrix<float>& transform() 			{ return m_transform; }
 	const 	maths::matrix<float>& transform() const 	{ return m_transform; }
 
+	/** Draws this object, but not its children.
+	 *  Calls the display list, unless the object draws some other way.
+	 */
+	virtual void draw_self() const;
+
+	/** Adds to what the calling thread has sent to the GL */
+	static void count_submitted(size_t triangles, size_t lines, size_t points = 0);
+
 public:
 	DisplayObject();
 	virtual ~DisplayObject();
@@ -60,31 +82,312 @@ public:
 	/** @} */
 
 	/** Calls all display lists */
-	void Draw() const;
+	virtual void Draw() const;
+
+	/** Draws a cheap stand-in for this object, for while the view is being dragged:
+	 *  no more than about max_facets facets' worth, and no children (so no edges).
+	 *  By default, the object itself.
+	 */
+	virtual void DrawProxy(size_t max_facets) const;
+
+	/** The number of facets the object draws, not counting its children */
+	virtual size_t NumFacets() const { return 0; }
+
+	/** What the calling thread has sent to the GL since the last call, which starts counting again */
+	static Submitted TakeSubmitted();
 };
 
+/** The root of a scene made of several parts.
+ *  Draws nothing itself; each part is a child. The parts keep their
+ *  positions relative to each other, and the whole scene is drawn
+ *  centered on the origin so it rotates about its middle.
+ */
+class SceneDisplayObject : public DisplayObject
+{
+private:
+	/** The combined bounding box of the parts, in file coordinates */
+	maths::bbox3d parts_bbox() const;
+
+public:
+	SceneDisplayObject();
+
+	virtual void BuildDisplayLists();
+	virtual maths::bbox3d GetBBox() const;
+	virtual void Draw() const;
+
+	/** Shares max_facets between the parts, by their size */
+	virtual void DrawProxy(size_t max_facets) const;
+
+	/** The center of the parts' combined bounding box, in file coordinates */
+	maths::vector3d GetCenter() const;
+};
+
+/** Draws a mesh from display lists, one per chunk of nearby facets,
+ *  skipping the chunks that are out of view (see MeshBVH)
+ */
 class MeshDisplayObject : public DisplayObject
 {
 private:
-	// Maybe this should be a weak_ptr
-	std::shared_ptr<triangle_mesh> m_mesh;
+	std::shared_ptr<const MeshGeometry> m_geometry;
+
+	GLuint		m_first_chunk_id;
+	GLsizei		m_num_chunks;
+	MeshBVH		m_bvh;
+
+	void delete_chunk_lists();
+
+protected:
+	virtual void draw_self() const;
+
+public:
+	MeshDisplayObject(std::shared_ptr<const MeshGeometry> geometry);
+	virtual ~MeshDisplayObject();
+
+	virtual void BuildDisplayLists();
+	virtual maths::bbox3d GetBBox() const;
+
+	/** The mesh, or a point at every so many facets if it's too big */
+	virtual void DrawProxy(size_t max_facets) const;
+	virtual size_t NumFacets() const;
+};
+
+/** The edges of a mesh: either all of them, or just the feature edges
+ *  (see MeshGeometry::NumFeatureEdges()). Lamina edges are always drawn.
+ */
+class EdgesDisplayObject : public DisplayObject
+{
+protected:
+	std::shared_ptr<const MeshGeometry>	m_geometry;
+	double								m_feature_angle;
+
+	/** The number of edges to draw, from the start of MeshGeometry::edges */
+	size_t num_edges_to_draw() const;
+
+public:
+	EdgesDisplayObject(std::shared_ptr<const MeshGeometry> geometry);
+
+	/** Only draws the edges whose facets meet at more than feature_angle degrees,
+	 *  or all of them if it's 0. Takes effect on the next draw.
+	 */
+	virtual void SetFeatureAngle(double feature_angle) { m_feature_angle = feature_angle; }
+	double GetFeatureAngle() const { return m_feature_angle; }
+
+	virtual maths::bbox3d GetBBox() const;
+};
+
+class MeshEdgesDisplayObject : public EdgesDisplayObject
+{
+private:
+	size_t	m_num_lines;	///< In the display list
+
+protected:
+	virtual void draw_self() const;
+
+public:
+	MeshEdgesDisplayObject(std::shared_ptr<const MeshGeometry> geometry);
+
+	/** Recompiles the display list */
+	virtual void SetFeatureAngle(double feature_angle);
+
+	virtual void BuildDisplayLists();
+};
+
+/** The shader program MeshBufferDisplayObject draws with, and where its inputs are.
+ *  Compile one per GL context and share it between the display objects.
+ */
+class MeshBufferProgram
+{
+private:
+	GLProgram	m_program;
+
+public:
+	const GLint	position_offset_location;
+	const GLint	position_scale_location;
+	const GLint	lighting_location;
+	const GLint	normal_location;
+
+	/** Needs a current context.
+	 *  @throws std::runtime_error if the shaders don't compile or link
+	 */
+	MeshBufferProgram();
+
+	void Use() const	{ m_program.Use(); }
+	void Unuse() const	{ m_program.Unuse(); }
+};
+
+/** Draws a mesh from vertex and index buffer objects instead of a display list.
+ *  Needs OpenGL 2.0 (see IsSupported()). Only the chunks in view are drawn, and
+ *  with back face culling on, only their meshlets that face the view.
+ *
+ *  A shader decodes the compact MeshBuffers::Vertex, and lights it as the fixed
+ *  function pipeline would with GL_LIGHT0 and GL_COLOR_MATERIAL, colored by its normal.
+ *
+ *  BuildDisplayLists() builds and uploads everything at once. Alternatively, build
+ *  the MeshBuffers on a worker thread, then Stage() them and Upload() a slice at a
+ *  time. Nothing is drawn until the upload is finished.
+ */
+class MeshBufferDisplayObject : public DisplayObject
+{
+private:
+	std::shared_ptr<const MeshGeometry>	m_geometry;
+	std::shared_ptr<const MeshBuffers>	m_staged;	///< Kept until the upload is finished
+
+	std::shared_ptr<const MeshBufferProgram>	m_program;
+
+	GLBuffer							m_vertex_buffer;
+	GLBuffer							m_index_buffer;
+	float								m_position_offset[3];
+	float								m_position_scale[3];
+	std::vector<MeshBuffers::Chunk>		m_chunks;
+	MeshBVH								m_bvh;
+	MeshBuffers::Meshlets				m_meshlets;
+	bool								m_uploaded;
+
+	// Per draw scratch space, kept to save reallocating it every frame
+	mutable std::vector<uint8_t>		m_front;
+	mutable std::vector<GLsizei>		m_draw_counts;
+	mutable std::vector<const GLvoid*>	m_draw_offsets;
+	mutable std::vector<GLint>			m_draw_firsts;
+
+	/** Sets up the program and the vertex arrays */
+	void begin_vertices() const;
+	void end_vertices() const;
+
+protected:
+	virtual void draw_self() const;
+
+public:
+	/** @param program	The context's program, see MeshBufferProgram */
+	MeshBufferDisplayObject(std::shared_ptr<const MeshGeometry> geometry, std::shared_ptr<const MeshBufferProgram> program);
+
+	/** Whether the current GL context has buffer objects and shaders.
+	 *  The shaders can still fail to compile, which MeshBufferProgram reports.
+	 */
+	static bool IsSupported();
+
+	/** Sets the buffers to upload, replacing whatever was uploaded before */
+	void Stage(const std::shared_ptr<const MeshBuffers>& buffers);
+
+	/** Uploads up to max_bytes more of the staged buffers.
+	 *  @returns	true once everything is uploaded
+	 */
+	bool Upload(size_t max_bytes);
+
+	virtual void BuildDisplayLists();
+	virtual maths::bbox3d GetBBox() const;
+
+	/** The mesh, or every so many of its vertices as points if it's too big */
+	virtual void DrawProxy(size_t max_facets) const;
+	virtual size_t NumFacets() const;
+};
+
+/** Draws the edges of a mesh from buffer objects, like MeshEdgesDisplayObject.
+ *  Built and uploaded the same way as MeshBufferDisplayObject.
+ */
+class MeshEdgesBufferDisplayObject : public EdgesDisplayObject
+{
+private:
+	std::shared_ptr<const MeshBuffers>	m_staged;
+
+	GLBuffer							m_position_buffer;
+	GLBuffer							m_index_buffer;
+	float								m_position_offset[3];
+	float								m_position_scale[3];
+	size_t								m_num_indices;
+	size_t								m_num_lamina_indices;
+	bool								m_uploaded;
 
-	static bool is_sharp_edge_boundary(const mesh_facet & f1, const mesh_facet & f2);
+protected:
+	virtual void draw_self() const;
 
 public:
-	MeshDisplayObject(std::shared_ptr<triangle_mesh> mesh);
+	MeshEdgesBufferDisplayObject(std::shared_ptr<const MeshGeometry> geometry);
+
+	/** Sets the edges to upload, from buffers.edge_positions and buffers.edge_indices */
+	void Stage(const std::shared_ptr<const MeshBuffers>& buffers);
+
+	/** Uploads up to max_bytes more.
+	 *  @returns	true once everything is uploaded
+	 */
+	bool Upload(size_t max_bytes);
+
+	virtual void BuildDisplayLists();
+};
+
+/** A part with several levels of detail, of which only one is drawn.
+ *  Each level is a complete display object (with its edges as children, say),
+ *  and the levels go from full detail to coarsest. The levels aren't children,
+ *  so Draw() on the parent doesn't reach them.
+ */
+class LODDisplayObject : public DisplayObject
+{
+private:
+	struct level
+	{
+		DOPtr	display_object;
+		double	error;
+	};
+
+	std::vector<level>	m_levels;
+	size_t				m_selected;
+
+protected:
+	virtual void draw_self() const;
+
+public:
+	/** Constructor.
+	 *  @param	full_detail		Level 0, with no error
+	 */
+	LODDisplayObject(const DOPtr& full_detail);
+
+	/** Adds a coarser level. It should be ready to draw.
+	 *  @param	error	How far the level may be from the full detail surface, in model units
+	 */
+	void AddLevel(const DOPtr& display_object, double error);
+
+	size_t NumLevels() const { return m_levels.size(); }
+	const DOPtr& GetLevel(size_t i) const { return m_levels[i].display_object; }
+
+	/** Picks the coarsest level whose error is at most max_pixel_error pixels on screen
+	 *  @param	pixels_per_unit	The current scale of the view
+	 *  @returns				true if that's a different level than before
+	 */
+	bool SelectLevel(double pixels_per_unit, double max_pixel_error);
+	size_t GetSelectedLevel() const { return m_selected; }
 
 	virtual void BuildDisplayLists();
 	virtual maths::bbox3d GetBBox() const;
+
+	/** The finest level, no finer than the selected one, that fits in max_facets */
+	virtual void DrawProxy(size_t max_facets) const;
+	virtual size_t NumFacets() const;
 };
 
-class MeshEdgesDisplayObject : public DisplayObject
+/** Shows the triangles of a mesh that is still being loaded.
+ *  Each call to AppendTriangles() compiles one more display list,
+ *  so nothing that has already been uploaded gets rebuilt.
+ */
+class PreviewDisplayObject : public DisplayObject
 {
 private:
-	std::shared_ptr<triangle_mesh> m_mesh;
+	std::vector<GLuint>	m_batch_ids;
+	size_t				m_num_triangles;
+	float				m_bbox_min[3];
+	float				m_bbox_max[3];
+
+protected:
+	virtual void draw_self() const;
 
 public:
-	MeshEdgesDisplayObject(std::shared_ptr<triangle_mesh> mesh);
+	PreviewDisplayObject();
+	virtual ~PreviewDisplayObject();
+
+	/** Adds triangles to the preview.
+	 *  @param corners	Nine floats (three x, y, z corners) per triangle
+	 */
+	void AppendTriangles(const std::vector<float>& corners);
+
+	size_t NumTriangles() const { return m_num_triangles; }
 
 	virtual void BuildDisplayLists();
 	virtual maths::bbox3d GetBBox() const;
@@ -0,0 +1,387 @@
+/*
+ * FrameStats.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#define GL_GLEXT_PROTOTYPES	// Timer queries are OpenGL 3.3
+
+#include "FrameStats.h"
+
+#include <ostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include <GL/glext.h>
+
+namespace
+{
+	const char* const PHASE_NAMES[FrameStats::NUM_PHASES] = { "setup", "draw", "overlay", "swap" };
+
+	// The overlay's layout, in pixels
+	const int OVERLAY_MARGIN = 8;
+	const int OVERLAY_PADDING = 6;
+	const int OVERLAY_WIDTH = 420;
+	const int HISTOGRAM_HEIGHT = 60;
+
+	bool has_timer_queries()
+	{
+		auto version_string = (const char*) glGetString(GL_VERSION);
+
+		int major = 0, minor = 0;
+		if (version_string && std::sscanf(version_string, "%d.%d", &major, &minor) == 2 &&
+			(major > 3 || (major == 3 && minor >= 3)))
+			return true;
+
+		auto extensions = (const char*) glGetString(GL_EXTENSIONS);
+		return extensions && std::strstr(extensions, "GL_ARB_timer_query");
+	}
+
+	void draw_text(int x, int y, const std::string& text, GLuint font_base)
+	{
+		glRasterPos2i(x, y);
+		glListBase(font_base);
+		glCallLists((GLsizei) text.size(), GL_UNSIGNED_BYTE, text.data());
+	}
+};
+
+//static
+const size_t FrameStats::HISTORY_FRAMES;
+
+//static
+const size_t FrameStats::NUM_HISTOGRAM_BINS;
+
+//static
+const size_t FrameStats::NUM_QUERIES;
+
+FrameStats::FrameStats()
+: m_initialized(false)
+, m_timer_queries(false)
+, m_current_query(nullptr)
+, m_num_frames(0)
+, m_current()
+, m_phase(PHASE_SETUP)
+{
+	for (gpu_query& query : m_queries)
+		query = { 0, 0, false };
+
+	m_frames.reserve(HISTORY_FRAMES);
+}
+
+FrameStats::~FrameStats()
+{
+	if (m_timer_queries)
+	{
+		for (gpu_query& query : m_queries)
+			glDeleteQueries(1, &query.id);
+	}
+}
+
+void FrameStats::init_gl()
+{
+	m_initialized = true;
+	m_timer_queries = has_timer_queries();
+
+	if (m_timer_queries)
+	{
+		for (gpu_query& query : m_queries)
+			glGenQueries(1, &query.id);
+	}
+}
+
+void FrameStats::BeginFrame()
+{
+	if (!m_initialized)
+		init_gl();
+
+	collect_queries(false);
+
+	m_current = Frame();
+	m_current.start = std::chrono::steady_clock::now();
+	m_current.gpu_ms = -1.0;
+
+	m_phase = PHASE_SETUP;
+	m_phase_start = m_current.start;
+
+	// If the query for this slot still has no result, this frame goes untimed rather than wait for it
+	m_current_query = nullptr;
+	gpu_query& query = m_queries[m_num_frames % NUM_QUERIES];
+	if (m_timer_queries && !query.active)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, query.id);
+		query.frame = m_num_frames;
+		query.active = true;
+		m_current_query = &query;
+	}
+}
+
+void FrameStats::BeginPhase(Phase phase)
+{
+	end_phase();
+
+	// The GPU time is for the scene, not for the overlay or the swap
+	if (phase >= PHASE_OVERLAY)
+		end_query();
+
+	m_phase = phase;
+}
+
+void FrameStats::EndFrame(size_t triangles, size_t lines, size_t points, bool wait_for_gpu)
+{
+	end_phase();
+	end_query();
+
+	m_current.cpu_ms = 0.0;
+	for (double ms : m_current.phase_ms)
+		m_current.cpu_ms += ms;
+
+	m_current.triangles = triangles;
+	m_current.lines = lines;
+	m_current.points = points;
+
+	if (m_frames.size() < HISTORY_FRAMES)
+		m_frames.push_back(m_current);
+	else
+		m_frames[m_num_frames % HISTORY_FRAMES] = m_current;
+
+	m_num_frames++;
+
+	collect_queries(wait_for_gpu);
+}
+
+void FrameStats::end_phase()
+{
+	auto const now = std::chrono::steady_clock::now();
+	m_current.phase_ms[m_phase] += std::chrono::duration<double, std::milli>(now - m_phase_start).count();
+	m_phase_start = now;
+}
+
+void FrameStats::end_query()
+{
+	if (!m_current_query)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_current_query = nullptr;
+}
+
+void FrameStats::collect_queries(bool wait)
+{
+	for (gpu_query& query : m_queries)
+	{
+		if (!query.active || &query == m_current_query)
+			continue;
+
+		if (!wait)
+		{
+			GLuint available = GL_FALSE;
+			glGetQueryObjectuiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				continue;
+		}
+
+		GLuint64 elapsed_ns = 0;
+		glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &elapsed_ns);
+		query.active = false;
+
+		Frame* frame = get_frame(query.frame);
+		if (frame)
+			frame->gpu_ms = elapsed_ns / 1.0e6;
+	}
+}
+
+FrameStats::Frame* FrameStats::get_frame(size_t frame)
+{
+	if (frame >= m_num_frames || frame + m_frames.size() < m_num_frames)
+		return nullptr;
+
+	return &m_frames[frame % HISTORY_FRAMES];
+}
+
+const FrameStats::Frame& FrameStats::LastFrame() const
+{
+	return m_frames[(m_num_frames - 1) % HISTORY_FRAMES];
+}
+
+double FrameStats::LatestGPUTime() const
+{
+	for (size_t i = 0 ; i < m_frames.size() ; i++)
+	{
+		const Frame& frame = m_frames[(m_num_frames - 1 - i) % HISTORY_FRAMES];
+		if (frame.gpu_ms >= 0.0)
+			return frame.gpu_ms;
+	}
+
+	return -1.0;
+}
+
+size_t FrameStats::FramesPerSecond() const
+{
+	auto const since = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+
+	return std::count_if(m_frames.begin(), m_frames.end(), [since](const Frame& frame) { return frame.start >= since; });
+}
+
+//static
+double FrameStats::HistogramBinLimit(size_t bin)
+{
+	if (bin + 1 >= NUM_HISTOGRAM_BINS)
+		return std::numeric_limits<double>::infinity();
+
+	return (double) (2 << bin);
+}
+
+std::vector<size_t> FrameStats::Histogram() const
+{
+	std::vector<size_t> histogram(NUM_HISTOGRAM_BINS, 0);
+	for (const Frame& frame : m_frames)
+	{
+		size_t bin = 0;
+		while (frame.cpu_ms > HistogramBinLimit(bin))
+			bin++;
+
+		histogram[bin]++;
+	}
+
+	return histogram;
+}
+
+std::vector<std::string> FrameStats::Describe() const
+{
+	std::vector<std::string> lines;
+	if (m_num_frames == 0)
+		return lines;
+
+	const Frame& frame = LastFrame();
+
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(2) << "CPU ms:";
+	for (int phase = 0 ; phase < NUM_PHASES ; phase++)
+		line << " " << PHASE_NAMES[phase] << " " << frame.phase_ms[phase];
+	lines.push_back(line.str());
+
+	line.str("");
+	const double gpu_ms = LatestGPUTime();
+	if (!m_timer_queries)
+		line << "GPU ms: n/a (no timer queries)";
+	else if (gpu_ms < 0.0)
+		line << "GPU ms: waiting";
+	else
+		line << "GPU ms: " << std::fixed << std::setprecision(2) << gpu_ms;
+	lines.push_back(line.str());
+
+	line.str("");
+	line << frame.triangles << " triangles, " << frame.lines << " lines, " << frame.points << " points";
+	lines.push_back(line.str());
+
+	line.str("");
+	line << FramesPerSecond() << " fps, frame " << std::fixed << std::setprecision(2) << frame.cpu_ms << " ms CPU";
+	lines.push_back(line.str());
+
+	return lines;
+}
+
+void FrameStats::LogLastFrame(std::ostream& os, const char* what) const
+{
+	if (m_num_frames == 0)
+		return;
+
+	const Frame& frame = LastFrame();
+
+	os << "Drew the " << what << " in " << std::fixed << std::setprecision(2) << frame.cpu_ms << " ms (";
+	for (int phase = 0 ; phase < NUM_PHASES ; phase++)
+		os << (phase > 0 ? ", " : "") << PHASE_NAMES[phase] << " " << frame.phase_ms[phase];
+	os << ")";
+
+	if (frame.gpu_ms >= 0.0)
+		os << ", GPU " << frame.gpu_ms << " ms";
+
+	os << ", " << frame.triangles << " triangles, " << frame.lines << " lines, " << frame.points << " points" << std::endl;
+}
+
+void FrameStats::DrawOverlay(int width, int height, GLuint font_base, int line_height) const
+{
+	const std::vector<std::string> lines = Describe();
+	if (lines.empty())
+		return;
+
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT | GL_LIST_BIT | GL_TRANSFORM_BIT);
+
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Pixels, y down from the top left
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0.0, width, height, 0.0, -1.0, 1.0);
+
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	const int left = OVERLAY_MARGIN;
+	const int top = OVERLAY_MARGIN;
+	const int text_height = (int) (lines.size() + 1) * line_height;
+	const int histogram_top = top + OVERLAY_PADDING + text_height;
+	const int bottom = histogram_top + HISTOGRAM_HEIGHT + line_height + OVERLAY_PADDING;
+	const int right = left + OVERLAY_WIDTH;
+
+	glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+	glRecti(left, top, right, bottom);
+
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	for (size_t i = 0 ; i < lines.size() ; i++)
+		draw_text(left + OVERLAY_PADDING, top + OVERLAY_PADDING + (int) (i + 1) * line_height, lines[i], font_base);
+
+	std::ostringstream title;
+	title << "Frame times, last " << m_frames.size() << " frames:";
+	draw_text(left + OVERLAY_PADDING, top + OVERLAY_PADDING + text_height, title.str(), font_base);
+
+	// The histogram, each bar scaled to the biggest
+	const std::vector<size_t> histogram = Histogram();
+	const size_t max_count = std::max<size_t>(1, *std::max_element(histogram.begin(), histogram.end()));
+	const int bar_width = (OVERLAY_WIDTH - 2 * OVERLAY_PADDING) / (int) NUM_HISTOGRAM_BINS;
+	const int histogram_bottom = histogram_top + HISTOGRAM_HEIGHT;
+
+	for (size_t bin = 0 ; bin < NUM_HISTOGRAM_BINS ; bin++)
+	{
+		const int x = left + OVERLAY_PADDING + (int) bin * bar_width;
+		const int bar_height = (int) (HISTOGRAM_HEIGHT * histogram[bin] / max_count);
+
+		// Green within a 60 Hz frame, then yellow, then red
+		const double limit = HistogramBinLimit(bin);
+		if (limit <= 16.0)
+			glColor4f(0.2f, 0.8f, 0.2f, 0.9f);
+		else if (limit <= 32.0)
+			glColor4f(0.9f, 0.8f, 0.2f, 0.9f);
+		else
+			glColor4f(0.9f, 0.2f, 0.2f, 0.9f);
+
+		glRecti(x + 1, histogram_bottom - bar_height, x + bar_width - 1, histogram_bottom);
+
+		std::ostringstream label;
+		if (bin + 1 < NUM_HISTOGRAM_BINS)
+			label << "<" << limit;
+		else
+			label << "more";
+
+		glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+		draw_text(x + 2, histogram_bottom + line_height, label.str(), font_base);
+	}
+
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+
+	glPopAttrib();
+}
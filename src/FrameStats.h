@@ -0,0 +1,145 @@
+/*
+ * FrameStats.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef FRAMESTATS_H_
+#define FRAMESTATS_H_
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iosfwd>
+#include <cstddef>
+
+#include <GL/gl.h>
+
+/** Times the frames the view draws, to tell whether it's CPU, driver or GPU bound.
+ *
+ *  Each frame is split into phases, timed on the CPU. If the GL has timer queries
+ *  (OpenGL 3.3 or ARB_timer_query), the GPU time of each frame is measured too.
+ *  The results come back a few frames later, so reading them never stalls the GL.
+ *
+ *  Keeps the last HISTORY_FRAMES frames, for the frame rate and a histogram of
+ *  frame times, and can draw all of it over the view.
+ */
+class FrameStats
+{
+public:
+	enum Phase
+	{
+		PHASE_SETUP,	///< Clearing, matrices and state
+		PHASE_DRAW,		///< DisplayObject::Draw() (or DrawProxy())
+		PHASE_OVERLAY,	///< Drawing these statistics
+		PHASE_SWAP,		///< Swapping buffers
+		NUM_PHASES
+	};
+
+	struct Frame
+	{
+		std::chrono::steady_clock::time_point	start;
+		double	phase_ms[NUM_PHASES];	///< CPU time in each phase
+		double	cpu_ms;					///< CPU time for the whole frame
+		double	gpu_ms;					///< GPU time for the frame, less than 0 if unknown
+		size_t	triangles;				///< What was sent to the GL
+		size_t	lines;
+		size_t	points;
+	};
+
+	/** How many frames the frame rate and histogram cover */
+	static const size_t HISTORY_FRAMES = 240;
+
+	/** The histogram bins are frame times up to 2, 4, 8, ... ms, and the last has the rest */
+	static const size_t NUM_HISTOGRAM_BINS = 8;
+
+private:
+	/** A timer query for one frame */
+	struct gpu_query
+	{
+		GLuint	id;
+		size_t	frame;		///< The number of the frame it times
+		bool	active;
+	};
+
+	/** Enough that a result is normally ready by the time its query comes round again */
+	static const size_t NUM_QUERIES = 4;
+
+	bool					m_initialized;
+	bool					m_timer_queries;	///< Whether the GL has them
+	gpu_query				m_queries[NUM_QUERIES];
+	gpu_query*				m_current_query;	///< The query timing this frame, if any
+
+	std::vector<Frame>		m_frames;		///< The last HISTORY_FRAMES, oldest first from m_num_frames % HISTORY_FRAMES
+	size_t					m_num_frames;	///< Frames started so far
+	Frame					m_current;
+	Phase					m_phase;
+	std::chrono::steady_clock::time_point	m_phase_start;
+
+	/** Checks for timer queries. Needs the GL context. */
+	void init_gl();
+
+	/** Ends the current phase and adds it to the current frame */
+	void end_phase();
+
+	/** Ends the current GPU query, if there is one */
+	void end_query();
+
+	/** Fills in the GPU times of frames whose queries are done.
+	 *  @param	wait	Wait for the results that aren't ready yet
+	 */
+	void collect_queries(bool wait);
+
+	/** The stored frame with the given number, or null if it's too old or not finished */
+	Frame* get_frame(size_t frame);
+
+public:
+	FrameStats();
+	~FrameStats();
+
+	/** Starts a frame, in the setup phase. The GL context must be current. */
+	void BeginFrame();
+
+	/** Ends the current phase and starts the next */
+	void BeginPhase(Phase phase);
+
+	/** Ends the frame.
+	 *  @param	triangles, lines, points	What the frame sent to the GL
+	 *  @param	wait_for_gpu				Wait for the frame's GPU time, so LastFrame() has it
+	 */
+	void EndFrame(size_t triangles, size_t lines, size_t points, bool wait_for_gpu);
+
+	/** The number of frames finished */
+	size_t NumFrames() const { return m_num_frames; }
+
+	/** The last frame finished. Only valid if NumFrames() > 0. */
+	const Frame& LastFrame() const;
+
+	/** The most recent GPU frame time known, less than 0 if none is */
+	double LatestGPUTime() const;
+
+	/** The frames started in the last second */
+	size_t FramesPerSecond() const;
+
+	/** How many of the stored frames took (on the CPU) up to 2, 4, 8, ... ms */
+	std::vector<size_t> Histogram() const;
+
+	/** The upper limit of histogram bin i, in ms (infinite for the last) */
+	static double HistogramBinLimit(size_t bin);
+
+	/** The statistics as lines of text */
+	std::vector<std::string> Describe() const;
+
+	/** Writes the last frame on one line */
+	void LogLastFrame(std::ostream& os, const char* what) const;
+
+	/** Draws the statistics in the top left corner of the viewport.
+	 *  @param	width, height	The viewport size, in pixels
+	 *  @param	font_base		The display lists of a bitmap font, one per ASCII character
+	 *  @param	line_height		The font's line spacing, in pixels
+	 */
+	void DrawOverlay(int width, int height, GLuint font_base, int line_height) const;
+};
+
+#endif /* FRAMESTATS_H_ */
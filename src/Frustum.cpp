@@ -0,0 +1,118 @@
+/*
+ * Frustum.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "Frustum.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <GL/gl.h>
+
+Frustum::Frustum()
+: m_orthographic(true)
+{
+	for (float* plane : m_planes)
+	{
+		std::fill(plane, plane + 3, 0.0f);
+		plane[3] = 1.0f;
+	}
+
+	m_view[0] = m_view[1] = 0.0f;
+	m_view[2] = -1.0f;
+}
+
+//static
+Frustum Frustum::FromMatrices(const float projection[16], const float modelview[16])
+{
+	// clip = projection * modelview
+	float clip[16];
+	for (int col = 0 ; col < 4 ; col++)
+	{
+		for (int row = 0 ; row < 4 ; row++)
+		{
+			float sum = 0.0f;
+			for (int k = 0 ; k < 4 ; k++)
+				sum += projection[4 * k + row] * modelview[4 * col + k];
+
+			clip[4 * col + row] = sum;
+		}
+	}
+
+	// Inside is -w <= x, y, z <= w, so each plane is the w row plus or minus another row
+	Frustum frustum;
+	for (int i = 0 ; i < 6 ; i++)
+	{
+		const int row = i / 2;
+		const float sign = i % 2 == 0 ? 1.0f : -1.0f;
+
+		for (int col = 0 ; col < 4 ; col++)
+			frustum.m_planes[i][col] = clip[4 * col + 3] + sign * clip[4 * col + row];
+	}
+
+	// Our modelviews are a rotation and a translation (zoom is in the projection),
+	// so the inverse rotation is the transpose.
+	// In eye coordinates the view looks down -z, from the origin.
+	frustum.m_orthographic = projection[3] == 0.0f && projection[7] == 0.0f && projection[11] == 0.0f;
+	if (frustum.m_orthographic)
+	{
+		float len = 0.0f;
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			frustum.m_view[k] = -modelview[4 * k + 2];
+			len += frustum.m_view[k] * frustum.m_view[k];
+		}
+
+		len = std::sqrt(len);
+		for (int k = 0 ; k < 3 && len > 0.0f ; k++)
+			frustum.m_view[k] /= len;
+	}
+	else
+	{
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			frustum.m_view[k] = -(	modelview[4 * k + 0] * modelview[12] +
+									modelview[4 * k + 1] * modelview[13] +
+									modelview[4 * k + 2] * modelview[14]);
+		}
+	}
+
+	return frustum;
+}
+
+//static
+Frustum Frustum::FromGL()
+{
+	float projection[16], modelview[16];
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+
+	return FromMatrices(projection, modelview);
+}
+
+Frustum::Containment Frustum::Classify(const float box_min[3], const float box_max[3]) const
+{
+	Containment containment = INSIDE;
+
+	for (const float* plane : m_planes)
+	{
+		// The box corners furthest in and furthest out along the plane normal
+		float inner = plane[3], outer = plane[3];
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			inner += plane[k] * (plane[k] >= 0.0f ? box_max[k] : box_min[k]);
+			outer += plane[k] * (plane[k] >= 0.0f ? box_min[k] : box_max[k]);
+		}
+
+		if (inner < 0.0f)
+			return OUTSIDE;
+
+		if (outer < 0.0f)
+			containment = INTERSECTS;
+	}
+
+	return containment;
+}
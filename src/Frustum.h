@@ -0,0 +1,54 @@
+/*
+ * Frustum.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+/** The six planes of a view volume, for culling boxes against it.
+ *  Works for orthographic and perspective projections alike.
+ */
+class Frustum
+{
+public:
+	enum Containment
+	{
+		OUTSIDE,		///< Entirely outside the view
+		INTERSECTS,		///< Partly inside, or too close to tell
+		INSIDE			///< Entirely inside the view
+	};
+
+private:
+	float	m_planes[6][4];	///< a, b, c, d with a x + b y + c z + d >= 0 inside
+	bool	m_orthographic;
+	float	m_view[3];		///< The view direction if orthographic, otherwise the eye position
+
+public:
+	/** A frustum that contains everything */
+	Frustum();
+
+	/** The frustum of projection * modelview (column major, like OpenGL's),
+	 *  in the coordinates the modelview matrix transforms from
+	 */
+	static Frustum FromMatrices(const float projection[16], const float modelview[16]);
+
+	/** The frustum of the current OpenGL projection and modelview matrices */
+	static Frustum FromGL();
+
+	/** Where the axis-aligned box [box_min, box_max] is */
+	Containment Classify(const float box_min[3], const float box_max[3]) const;
+
+	/** Whether the projection is orthographic, so the view direction is the same everywhere */
+	bool IsOrthographic() const { return m_orthographic; }
+
+	/** The unit direction the view looks in, for an orthographic projection */
+	const float* ViewDirection() const { return m_view; }
+
+	/** Where the eye is, for a perspective projection */
+	const float* EyePosition() const { return m_view; }
+};
+
+#endif /* FRUSTUM_H_ */
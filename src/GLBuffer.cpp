@@ -0,0 +1,73 @@
+/*
+ * GLBuffer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#define GL_GLEXT_PROTOTYPES	// Buffer objects are OpenGL 1.5
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include <stdexcept>
+#include <algorithm>
+
+#include "GLBuffer.h"
+
+GLBuffer::GLBuffer(GLenum target)
+: m_target(target)
+, m_id(0)
+, m_data(nullptr)
+, m_size(0)
+, m_uploaded(0)
+{
+	glGenBuffers(1, &m_id);
+
+	if (m_id == 0)
+		throw std::runtime_error("Error creating buffer object");
+}
+
+GLBuffer::~GLBuffer()
+{
+	if (m_id > 0)
+		glDeleteBuffers(1, &m_id);
+}
+
+void GLBuffer::Stage(const void* data, size_t size)
+{
+	m_data = static_cast<const char*>(data);
+	m_size = size;
+	m_uploaded = 0;
+
+	glBindBuffer(m_target, m_id);
+	glBufferData(m_target, (GLsizeiptr) size, nullptr, GL_STATIC_DRAW);
+	glBindBuffer(m_target, 0);
+}
+
+size_t GLBuffer::Upload(size_t max_bytes)
+{
+	const size_t num_bytes = std::min(max_bytes, m_size - m_uploaded);
+	if (num_bytes == 0)
+		return 0;
+
+	glBindBuffer(m_target, m_id);
+	glBufferSubData(m_target, (GLintptr) m_uploaded, (GLsizeiptr) num_bytes, m_data + m_uploaded);
+	glBindBuffer(m_target, 0);
+
+	m_uploaded += num_bytes;
+	if (IsUploaded())
+		m_data = nullptr;
+
+	return num_bytes;
+}
+
+void GLBuffer::Bind() const
+{
+	glBindBuffer(m_target, m_id);
+}
+
+void GLBuffer::Unbind() const
+{
+	glBindBuffer(m_target, 0);
+}
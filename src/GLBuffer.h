@@ -0,0 +1,53 @@
+/*
+ * GLBuffer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef GLBUFFER_H_
+#define GLBUFFER_H_
+
+#include <GL/gl.h>
+
+#include <cstddef>
+
+/** An OpenGL buffer object whose data can be uploaded a slice at a time,
+ *  so a big upload can be spread over several main loop iterations.
+ *  Needs OpenGL 1.5, and a current context for everything but the accessors.
+ */
+class GLBuffer
+{
+private:
+	GLenum		m_target;
+	GLuint		m_id;
+	const char*	m_data;		///< What's left to upload, not owned
+	size_t		m_size;
+	size_t		m_uploaded;
+
+public:
+	/** @param target	GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER */
+	explicit GLBuffer(GLenum target);
+	~GLBuffer();
+
+	GLBuffer(const GLBuffer&) = delete;
+	GLBuffer& operator=(const GLBuffer&) = delete;
+
+	/** Allocates the buffer and sets the data to upload.
+	 *  The data must stay valid until IsUploaded().
+	 */
+	void Stage(const void* data, size_t size);
+
+	/** Uploads up to max_bytes more of the staged data.
+	 *  @returns	The number of bytes uploaded
+	 */
+	size_t Upload(size_t max_bytes);
+
+	bool IsUploaded() const { return m_uploaded == m_size; }
+	size_t Size() const { return m_size; }
+
+	void Bind() const;
+	void Unbind() const;
+};
+
+#endif /* GLBUFFER_H_ */
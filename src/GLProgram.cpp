@@ -0,0 +1,132 @@
+/*
+ * GLProgram.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#define GL_GLEXT_PROTOTYPES	// Shaders are OpenGL 2.0
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "GLProgram.h"
+
+namespace
+{
+	std::string shader_log(GLuint shader)
+	{
+		GLint length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+
+		std::vector<GLchar> log(std::max(1, length), '\0');
+		glGetShaderInfoLog(shader, (GLsizei) log.size(), nullptr, log.data());
+
+		return log.data();
+	}
+
+	std::string program_log(GLuint program)
+	{
+		GLint length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+		std::vector<GLchar> log(std::max(1, length), '\0');
+		glGetProgramInfoLog(program, (GLsizei) log.size(), nullptr, log.data());
+
+		return log.data();
+	}
+
+	GLuint compile_shader(GLenum type, const char* source)
+	{
+		const GLuint shader = glCreateShader(type);
+		if (shader == 0)
+			throw std::runtime_error("Error creating shader");
+
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint compiled = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+		if (!compiled)
+		{
+			const std::string log = shader_log(shader);
+			glDeleteShader(shader);
+			throw std::runtime_error(std::string("Error compiling ") + (type == GL_VERTEX_SHADER ? "vertex" : "fragment") +
+									 " shader: " + log);
+		}
+
+		return shader;
+	}
+};
+
+GLProgram::GLProgram(const char* vertex_source, const char* fragment_source)
+: m_id(0)
+{
+	const GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_source);
+
+	GLuint fragment_shader = 0;
+	try
+	{
+		fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source);
+	}
+	catch (...)
+	{
+		glDeleteShader(vertex_shader);
+		throw;
+	}
+
+	m_id = glCreateProgram();
+	if (m_id != 0)
+	{
+		glAttachShader(m_id, vertex_shader);
+		glAttachShader(m_id, fragment_shader);
+		glLinkProgram(m_id);
+	}
+
+	// The program keeps them until it goes
+	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
+
+	if (m_id == 0)
+		throw std::runtime_error("Error creating shader program");
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(m_id, GL_LINK_STATUS, &linked);
+	if (!linked)
+	{
+		const std::string log = program_log(m_id);
+		glDeleteProgram(m_id);
+		throw std::runtime_error("Error linking shader program: " + log);
+	}
+}
+
+GLProgram::~GLProgram()
+{
+	if (m_id > 0)
+		glDeleteProgram(m_id);
+}
+
+GLint GLProgram::UniformLocation(const char* name) const
+{
+	return glGetUniformLocation(m_id, name);
+}
+
+GLint GLProgram::AttribLocation(const char* name) const
+{
+	return glGetAttribLocation(m_id, name);
+}
+
+void GLProgram::Use() const
+{
+	glUseProgram(m_id);
+}
+
+void GLProgram::Unuse() const
+{
+	glUseProgram(0);
+}
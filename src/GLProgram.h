@@ -0,0 +1,41 @@
+/*
+ * GLProgram.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef GLPROGRAM_H_
+#define GLPROGRAM_H_
+
+#include <GL/gl.h>
+
+/** A linked GLSL program of a vertex and a fragment shader.
+ *  Needs OpenGL 2.0, and a current context for everything.
+ */
+class GLProgram
+{
+private:
+	GLuint	m_id;
+
+public:
+	/** Compiles and links the shaders.
+	 *  @throws std::runtime_error with the info log if either doesn't compile, or they don't link
+	 */
+	GLProgram(const char* vertex_source, const char* fragment_source);
+	~GLProgram();
+
+	GLProgram(const GLProgram&) = delete;
+	GLProgram& operator=(const GLProgram&) = delete;
+
+	/** -1 if there's no such uniform, or it's unused */
+	GLint UniformLocation(const char* name) const;
+
+	/** -1 if there's no such attribute, or it's unused */
+	GLint AttribLocation(const char* name) const;
+
+	void Use() const;
+	void Unuse() const;
+};
+
+#endif /* GLPROGRAM_H_ */
@@ -0,0 +1,107 @@
+/*
+ * HalfEdgeMesh.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "HalfEdgeMesh.h"
+#include "IndexedMesh.h"
+#include "Parallel.h"
+
+#include <algorithm>
+
+namespace
+{
+	/** A half-edge, with its edge as the sorted vertex pair */
+	struct edge_halfedge
+	{
+		uint64_t	key;
+		uint32_t	halfedge;
+
+		bool operator<(const edge_halfedge& rhs) const
+		{
+			return key != rhs.key ? key < rhs.key : halfedge < rhs.halfedge;
+		}
+	};
+};
+
+//static
+const uint32_t HalfEdgeMesh::NONE;
+
+//static
+HalfEdgeMesh HalfEdgeMesh::Build(IndexedMesh&& mesh, unsigned num_threads, const std::atomic<bool>* cancel)
+{
+	HalfEdgeMesh he;
+	he.positions = std::move(mesh.positions);
+	he.indices = std::move(mesh.indices);
+
+	const size_t num_halfedges = he.indices.size();
+
+	// The half-edges of each edge end up next to each other, in ascending order
+	std::vector<edge_halfedge> keys(num_halfedges);
+	ParallelFor(0, he.NumFacets(), num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (size_t h = 3 * begin ; h < 3 * end ; h++)
+			{
+				if (h % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+					return;
+
+				const uint32_t a = he.indices[h];
+				const uint32_t b = he.indices[Next((uint32_t) h)];
+
+				keys[h].key = ((uint64_t) std::min(a, b) << 32) | std::max(a, b);
+				keys[h].halfedge = (uint32_t) h;
+			}
+		});
+
+	ParallelSort(keys, std::less<edge_halfedge>(), num_threads, cancel);
+	if (IsCanceled(cancel))
+		return HalfEdgeMesh();
+
+	he.twins.resize(num_halfedges);
+	size_t next_cancel_check = 0;
+	for (size_t i = 0 ; i < keys.size() ; )
+	{
+		if (i >= next_cancel_check)
+		{
+			if (IsCanceled(cancel))
+				return HalfEdgeMesh();
+
+			next_cancel_check = i + CANCEL_CHECK_INTERVAL;
+		}
+
+		size_t run_end = i + 1;
+		while (run_end < keys.size() && keys[run_end].key == keys[i].key)
+			run_end++;
+
+		for (size_t j = i ; j + 1 < run_end ; j++)
+			he.twins[keys[j].halfedge] = keys[j + 1].halfedge;
+		he.twins[keys[run_end - 1].halfedge] = keys[i].halfedge;
+
+		he.num_edges++;
+		if (run_end - i == 1)
+			he.num_lamina_edges++;
+		else if (run_end - i > 2)
+			he.num_non_manifold_edges++;
+
+		i = run_end;
+	}
+
+	std::vector<edge_halfedge>().swap(keys);
+
+	// A boundary half-edge where there is one, so turning around the vertex from it sees every facet of the fan
+	he.vertex_halfedges.assign(he.NumVertices(), NONE);
+	for (size_t h = 0 ; h < num_halfedges ; h++)
+	{
+		if (h % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+			return HalfEdgeMesh();
+
+		uint32_t& vertex_halfedge = he.vertex_halfedges[he.indices[h]];
+		if (vertex_halfedge == NONE || (!he.IsManifold((uint32_t) h) && he.IsManifold(vertex_halfedge)))
+			vertex_halfedge = (uint32_t) h;
+	}
+
+	return he;
+}
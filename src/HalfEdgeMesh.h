@@ -0,0 +1,216 @@
+/*
+ * HalfEdgeMesh.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef HALFEDGEMESH_H_
+#define HALFEDGEMESH_H_
+
+#include <vector>
+#include <limits>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+struct IndexedMesh;
+
+/** A triangle mesh as flat arrays, with the half-edges that connect its facets.
+ *
+ *  Vertices, facets and half-edges are integer handles into the arrays. Half-edge h
+ *  runs from vertex indices[h] along side h % 3 of facet h / 3, so the facet and the
+ *  next and previous half-edges are implied and only the twins are stored.
+ *
+ *  twins links the half-edges of each edge in a cycle, in ascending order: a boundary
+ *  (lamina) half-edge is its own twin, a manifold edge's two half-edges are each other's,
+ *  and where more than two facets share an edge the cycle goes through all of them.
+ *
+ *  The adjacency ranges walk the arrays in place, so nothing is allocated per element,
+ *  building included.
+ */
+struct HalfEdgeMesh
+{
+	static const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+	std::vector<float>		positions;			///< x, y, z per vertex
+	std::vector<uint32_t>	indices;			///< Three vertex indices per facet, the start of each half-edge
+	std::vector<uint32_t>	twins;				///< Per half-edge, the next half-edge of the same edge
+	std::vector<uint32_t>	vertex_halfedges;	///< Per vertex, a half-edge leaving it (on the boundary if there is one), or NONE
+
+	size_t					num_edges = 0;
+	size_t					num_lamina_edges = 0;		///< Edges with only one facet
+	size_t					num_non_manifold_edges = 0;	///< Edges with more than two facets
+
+	size_t NumVertices() const	{ return positions.size() / 3; }
+	size_t NumFacets() const	{ return indices.size() / 3; }
+	size_t NumHalfEdges() const	{ return indices.size(); }
+
+	static uint32_t Facet(uint32_t h)	{ return h / 3; }
+	static uint32_t Next(uint32_t h)	{ return h % 3 == 2 ? h - 2 : h + 1; }
+	static uint32_t Prev(uint32_t h)	{ return h % 3 == 0 ? h + 2 : h - 1; }
+
+	uint32_t From(uint32_t h) const		{ return indices[h]; }
+	uint32_t To(uint32_t h) const		{ return indices[Next(h)]; }
+
+	bool IsBoundary(uint32_t h) const	{ return twins[h] == h; }
+	bool IsManifold(uint32_t h) const	{ return twins[h] != h && twins[twins[h]] == h; }
+
+	/** True for exactly one half-edge of each edge (the last of its cycle), for visiting each edge once */
+	bool IsEdgeRepresentative(uint32_t h) const { return twins[h] <= h; }
+
+	/** Every edge has two facets */
+	bool IsClosed() const { return num_lamina_edges == 0 && num_non_manifold_edges == 0; }
+
+	/** The half-edges of h's edge, starting with h */
+	class RadialRange
+	{
+	public:
+		class iterator
+		{
+		private:
+			const HalfEdgeMesh*	m_mesh;
+			uint32_t			m_start;
+			uint32_t			m_halfedge;
+
+		public:
+			iterator(const HalfEdgeMesh* mesh, uint32_t start, uint32_t halfedge) : m_mesh(mesh), m_start(start), m_halfedge(halfedge) { }
+
+			uint32_t operator*() const { return m_halfedge; }
+
+			iterator& operator++()
+			{
+				m_halfedge = m_mesh->twins[m_halfedge];
+				if (m_halfedge == m_start)
+					m_halfedge = NONE;
+				return *this;
+			}
+
+			bool operator==(const iterator& rhs) const { return m_halfedge == rhs.m_halfedge; }
+			bool operator!=(const iterator& rhs) const { return m_halfedge != rhs.m_halfedge; }
+		};
+
+	private:
+		const HalfEdgeMesh*	m_mesh;
+		uint32_t			m_start;
+
+	public:
+		RadialRange(const HalfEdgeMesh* mesh, uint32_t h) : m_mesh(mesh), m_start(h) { }
+
+		iterator begin() const	{ return iterator(m_mesh, m_start, m_start); }
+		iterator end() const	{ return iterator(m_mesh, m_start, NONE); }
+	};
+
+	/** The facets across f's edges, once per facet per shared edge */
+	class AdjacentFacetRange
+	{
+	public:
+		class iterator
+		{
+		private:
+			const HalfEdgeMesh*	m_mesh;
+			uint32_t			m_facet;
+			uint32_t			m_side;		///< 3 at the end
+			uint32_t			m_halfedge;	///< Around the edge on m_side
+
+			/** Moves on to the next side until m_halfedge is another facet's */
+			void skip_own()
+			{
+				while (m_side < 3 && m_halfedge == 3 * m_facet + m_side)
+				{
+					if (++m_side < 3)
+						m_halfedge = m_mesh->twins[3 * m_facet + m_side];
+				}
+			}
+
+		public:
+			iterator(const HalfEdgeMesh* mesh, uint32_t facet, uint32_t side)
+			: m_mesh(mesh), m_facet(facet), m_side(side), m_halfedge(side < 3 ? mesh->twins[3 * facet + side] : NONE)
+			{
+				skip_own();
+			}
+
+			uint32_t operator*() const { return Facet(m_halfedge); }
+
+			/** The neighbor's half-edge on the shared edge */
+			uint32_t HalfEdge() const { return m_halfedge; }
+
+			iterator& operator++()
+			{
+				m_halfedge = m_mesh->twins[m_halfedge];
+				skip_own();
+				return *this;
+			}
+
+			bool operator==(const iterator& rhs) const { return m_side == rhs.m_side && (m_side == 3 || m_halfedge == rhs.m_halfedge); }
+			bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+		};
+
+	private:
+		const HalfEdgeMesh*	m_mesh;
+		uint32_t			m_facet;
+
+	public:
+		AdjacentFacetRange(const HalfEdgeMesh* mesh, uint32_t f) : m_mesh(mesh), m_facet(f) { }
+
+		iterator begin() const	{ return iterator(m_mesh, m_facet, 0); }
+		iterator end() const	{ return iterator(m_mesh, m_facet, 3); }
+	};
+
+	/** The half-edges leaving v, turning across manifold edges from vertex_halfedges[v].
+	 *  At a vertex where the facets meet in more than one fan (a non-manifold vertex, or
+	 *  where neighboring facets wind opposite ways), only the first fan.
+	 */
+	class OutgoingRange
+	{
+	public:
+		class iterator
+		{
+		private:
+			const HalfEdgeMesh*	m_mesh;
+			uint32_t			m_start;
+			uint32_t			m_halfedge;
+
+		public:
+			iterator(const HalfEdgeMesh* mesh, uint32_t start, uint32_t halfedge) : m_mesh(mesh), m_start(start), m_halfedge(halfedge) { }
+
+			uint32_t operator*() const { return m_halfedge; }
+
+			iterator& operator++()
+			{
+				// Back into this vertex, and out again on the other side of that edge
+				const uint32_t in = Prev(m_halfedge);
+				const uint32_t out = m_mesh->twins[in];
+
+				m_halfedge = m_mesh->IsManifold(in) && m_mesh->indices[out] == m_mesh->indices[m_start] && out != m_start ? out : NONE;
+				return *this;
+			}
+
+			bool operator==(const iterator& rhs) const { return m_halfedge == rhs.m_halfedge; }
+			bool operator!=(const iterator& rhs) const { return m_halfedge != rhs.m_halfedge; }
+		};
+
+	private:
+		const HalfEdgeMesh*	m_mesh;
+		uint32_t			m_start;
+
+	public:
+		OutgoingRange(const HalfEdgeMesh* mesh, uint32_t v) : m_mesh(mesh), m_start(mesh->vertex_halfedges[v]) { }
+
+		iterator begin() const	{ return iterator(m_mesh, m_start, m_start); }
+		iterator end() const	{ return iterator(m_mesh, m_start, NONE); }
+	};
+
+	RadialRange			RadialHalfEdges(uint32_t h) const	{ return RadialRange(this, h); }
+	AdjacentFacetRange	AdjacentFacets(uint32_t f) const	{ return AdjacentFacetRange(this, f); }
+	OutgoingRange		OutgoingHalfEdges(uint32_t v) const	{ return OutgoingRange(this, v); }
+
+	/** Builds the half-edges for a welded mesh.
+	 *  @param	mesh			The welded mesh. Its arrays are moved into the half-edge mesh.
+	 *  @param	num_threads		The number of threads to use, 0 for the default
+	 *  @param	cancel			If not null, Build() gives up soon after this is set and returns an empty mesh
+	 */
+	static HalfEdgeMesh Build(IndexedMesh&& mesh, unsigned num_threads = 0, const std::atomic<bool>* cancel = nullptr);
+};
+
+#endif /* HALFEDGEMESH_H_ */
@@ -0,0 +1,44 @@
+/*
+ * IndexedMesh.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "IndexedMesh.h"
+
+#include <triangle_mesh.h>
+
+#include <unordered_map>
+
+//static
+IndexedMesh IndexedMesh::FromTriangleMesh(const triangle_mesh& mesh)
+{
+	IndexedMesh indexed;
+
+	const auto& vertices = mesh.get_vertices();
+	const auto& facets = mesh.get_facets();
+
+	std::unordered_map<const mesh_vertex*, uint32_t> vertex_index;
+	vertex_index.reserve(vertices.size());
+
+	indexed.positions.reserve(3 * vertices.size());
+	for (const mesh_vertex_ptr& vert : vertices)
+	{
+		const maths::vector3d p = vert->get_point();
+
+		vertex_index.emplace(vert.get(), (uint32_t) (indexed.positions.size() / 3));
+		indexed.positions.push_back((float) p.x());
+		indexed.positions.push_back((float) p.y());
+		indexed.positions.push_back((float) p.z());
+	}
+
+	indexed.indices.reserve(3 * facets.size());
+	for (const mesh_facet_ptr& facet : facets)
+	{
+		for (const mesh_vertex_ptr& vert : facet->get_verts())
+			indexed.indices.push_back(vertex_index.at(vert.get()));
+	}
+
+	return indexed;
+}
@@ -0,0 +1,30 @@
+/*
+ * IndexedMesh.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef INDEXEDMESH_H_
+#define INDEXEDMESH_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class triangle_mesh;
+
+/** A triangle mesh as a shared vertex array plus a triangle index buffer */
+struct IndexedMesh
+{
+	std::vector<float>		positions;	///< x, y, z per vertex
+	std::vector<uint32_t>	indices;	///< three vertex indices per triangle
+
+	size_t NumVertices() const { return positions.size() / 3; }
+	size_t NumTriangles() const { return indices.size() / 3; }
+
+	/** Builds the vertex and index arrays from the vertices and facets of a triangle_mesh */
+	static IndexedMesh FromTriangleMesh(const triangle_mesh& mesh);
+};
+
+#endif /* INDEXEDMESH_H_ */
@@ -8,9 +8,12 @@
 #include "MainWindow.h"
 #include "STLDrawArea.h"
 #include "DisplayObject.h"
-
-#include "stl_importer.h"
-#include "triangle_mesh.h"
+#include "MeshStats.h"
+#include "MeshGeometry.h"
+#include "MeshLoader.h"
+#include "WorkerPool.h"
+#include "SplitNormals.h"
+#include "Parallel.h"
 
 #include <gtkmm/accelgroup.h>
 
@@ -19,11 +22,15 @@
 #include <exception>
 #include <memory>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
 
 #include <string.h>
-#include <errno.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <sys/stat.h>
 
 #include <type_traits>
 #include <sigc++/sigc++.h>
@@ -33,10 +40,24 @@ const Glib::ustring MainWindow::MENU_ITEM_DATA_KEYNAME = "MENU_ITEM_DATA";
 
 const size_t MainWindow::MENU_ITEM_MESH_INFO_ID 			= 0x8001;
 const size_t MainWindow::MENU_ITEM_FILE_EXPORT_POINTS_ID	= 0x8002;
+const size_t MainWindow::MENU_ITEM_FEATURE_EDGES_ID		= 0x8003;
+const size_t MainWindow::MENU_ITEM_FRAME_STATS_ID		= 0x8004;
 
 using std::shared_ptr;
 using std::unique_ptr;
 
+namespace
+{
+	/** Logs a load that came from the mesh cache, with how much faster it was than the import */
+	void log_cached_load(const std::string& name, const MeshLoader& loader)
+	{
+		std::clog	<< "Loaded " << name << ": " << loader.Geometry()->NumFacets() << " facets from cache in "
+					<< std::fixed << std::setprecision(3) << loader.Seconds() << " s (full import took "
+					<< loader.CachedImportSeconds() << " s, " << std::setprecision(1)
+					<< loader.CachedImportSeconds() / std::max(loader.Seconds(), 1.0e-6) << "x faster)" << std::endl;
+	}
+};
+
 // Supposedly, this allows lambdas to work with sigc
 //namespace sigc
 //{
@@ -51,119 +72,6 @@ using std::unique_ptr;
 //	};
 //};
 
-namespace
-{
-	class mesh_triangle_dispatcher : public std::iterator<std::output_iterator_tag, void, void, void, void>
-	{
-	private:
-		triangle_mesh&	m_mesh;
-		Glib::Mutex&	m_mutex;
-		bool&			m_done;
-
-	public:
-		mesh_triangle_dispatcher() = delete;
-		mesh_triangle_dispatcher(triangle_mesh& mesh, Glib::Mutex& mutex, bool& done)
-		: m_mesh(mesh)
-		, m_mutex(mutex)
-		, m_done(done)
-		{
-
-		}
-
-		/* std::iterator boilerplate */
-		mesh_triangle_dispatcher& operator*() { return *this; }
-		mesh_triangle_dispatcher& operator++() { return *this; }
-		mesh_triangle_dispatcher& operator++(int) { return *this; }
-
-		mesh_triangle_dispatcher& operator=(const maths::triangle3d& t)
-		{
-			Glib::Mutex::Lock lock(m_mutex);
-
-			if (!m_done)
-				m_mesh.add_triangle(t);
-			else
-				throw stl_util::import_cancel_exception();
-
-			return *this;
-		}
-	};
-
-	class process_stl
-	{
-	private:
-		std::shared_ptr<triangle_mesh>				m_mesh;
-		std::unique_ptr<mesh_triangle_dispatcher>	m_dispatcher;
-		stl_util::stl_importer&						m_importer;
-		bool										m_done;
-
-		Glib::Thread*			m_thread;
-		Glib::Mutex				m_mutex;
-
-		Glib::Dispatcher		m_sig_done;
-
-		void run()
-		{
-			m_dispatcher.reset(new mesh_triangle_dispatcher(*m_mesh, m_mutex, m_done));
-			m_importer.import(*m_dispatcher);
-
-			//Glib::Mutex::Lock lock(m_mutex);
-			if (!m_done)	// user canceled
-			{
-				m_mesh->center();
-				m_mesh->name() = m_importer.name();
-
-				m_sig_done();
-			}
-		}
-
-	public:
-		process_stl(const std::shared_ptr<triangle_mesh>& mesh, stl_util::stl_importer& importer)
-		: m_mesh(mesh)
-		, m_importer(importer)
-		, m_done(false)
-		, m_thread(nullptr)
-		{
-
-		}
-
-		~process_stl()
-		{
-			if (m_thread)
-				m_thread->join();	// block until exit
-		}
-
-		Glib::Mutex& mutex() { return m_mutex; }
-
-		Glib::Dispatcher& sig_done() { return m_sig_done; }
-
-		size_t get_facets_processed()
-		{
-			Glib::Mutex::Lock lock(m_mutex);
-
-			return m_mesh->get_facets().size();
-		}
-
-		void start()
-		{
-			if (m_thread)
-				return;
-
-			m_thread = Glib::Thread::create(sigc::mem_fun(*this, &process_stl::run));
-		}
-
-		void cancel()
-		{
-			if (!m_thread)
-				return;
-
-			{
-				Glib::Mutex::Lock lock(m_mutex);
-				m_done = true;
-			}
-		}
-	};
-};
-
 ScopedWaitCursor::ScopedWaitCursor(Gtk::Widget& widget)
 : m_window(widget.get_window())
 {
@@ -189,6 +97,11 @@ MainWindow::MainWindow()
 : m_stlDrawArea(new STLDrawArea)
 , m_vBox(false /* homogeneous */, 0 /* spacing */)
 , m_show_edges(true)
+, m_import_threads(0)
+, m_weld_tolerance(0.0)
+, m_crease_angle(SplitNormals::DEFAULT_CREASE_ANGLE)
+, m_feature_edges(false)
+, m_feature_angle(30.0)
 {
 	set_window_title("");
 
@@ -208,7 +121,10 @@ MainWindow::MainWindow()
 	Gtk::MenuItem*		view_menubar_item	= Gtk::manage(new Gtk::MenuItem("View"));
 	Gtk::Menu*			view_menu			= Gtk::manage(new Gtk::Menu());
 	Gtk::CheckMenuItem*	view_show_edges		= Gtk::manage(new Gtk::CheckMenuItem("Show Edges"));
+	Gtk::CheckMenuItem*	view_feature_edges	= Gtk::manage(new Gtk::CheckMenuItem("Feature Edges Only"));
+	Gtk::MenuItem*		view_feature_angle	= Gtk::manage(new Gtk::MenuItem("Feature Edge Angle..."));
 	Gtk::CheckMenuItem* view_enable_bfc		= Gtk::manage(new Gtk::CheckMenuItem("Enable Back-Face Culling"));
+	Gtk::CheckMenuItem*	view_frame_stats	= Gtk::manage(new Gtk::CheckMenuItem("Frame Statistics"));
 	Gtk::MenuItem* 		view_mesh_info		= Gtk::manage(new Gtk::MenuItem("Mesh Info..."));
 
 	Gtk::MenuItem*	help_menubar_item	= Gtk::manage(new Gtk::MenuItem("Help"));
@@ -220,7 +136,7 @@ MainWindow::MainWindow()
 	file_open->show();
 
 	file_menu->append(*file_write_vertices);
-	file_write_vertices->set_sensitive(!!m_mesh);
+	file_write_vertices->set_sensitive(!m_parts.empty());
 	file_write_vertices->set_data(MENU_ITEM_DATA_KEYNAME, (void *) MENU_ITEM_FILE_EXPORT_POINTS_ID);
 	file_write_vertices->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_file_export_vertices));
 	file_write_vertices->show();
@@ -237,13 +153,29 @@ MainWindow::MainWindow()
 	view_show_edges->signal_toggled().connect(sigc::mem_fun(*this, &MainWindow::on_view_show_edges));
 	view_show_edges->show();
 
+	view_menu->append(*view_feature_edges);
+	view_feature_edges->set_active(m_feature_edges);
+	view_feature_edges->set_data(MENU_ITEM_DATA_KEYNAME, (void *) MENU_ITEM_FEATURE_EDGES_ID);
+	view_feature_edges->signal_toggled().connect(sigc::mem_fun(*this, &MainWindow::on_view_feature_edges));
+	view_feature_edges->show();
+
+	view_menu->append(*view_feature_angle);
+	view_feature_angle->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_view_feature_angle));
+	view_feature_angle->show();
+
 	view_menu->append(*view_enable_bfc);
 	view_enable_bfc->set_active(true);
 	view_enable_bfc->signal_toggled().connect(sigc::mem_fun(*this, &MainWindow::on_view_enable_back_face_culling));
 	view_enable_bfc->show();
 
+	view_menu->append(*view_frame_stats);
+	view_frame_stats->set_active(m_stlDrawArea->FrameStatsShown());
+	view_frame_stats->set_data(MENU_ITEM_DATA_KEYNAME, (void *) MENU_ITEM_FRAME_STATS_ID);
+	view_frame_stats->signal_toggled().connect(sigc::mem_fun(*this, &MainWindow::on_view_frame_stats));
+	view_frame_stats->show();
+
 	view_menu->append(*view_mesh_info);
-	view_mesh_info->set_sensitive(!!m_mesh);
+	view_mesh_info->set_sensitive(!m_parts.empty());
 	view_mesh_info->set_data(MENU_ITEM_DATA_KEYNAME, (void *) MENU_ITEM_MESH_INFO_ID);
 	view_mesh_info->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_view_mesh_info));
 	view_mesh_info->show();
@@ -301,117 +233,394 @@ void MainWindow::FileOpen(const Glib::ustring& filename)
 {
 	ScopedWaitCursor wc(*this);
 
-	shared_ptr<triangle_mesh> mesh;
+	shared_ptr<const MeshGeometry> geometry;
 	try
 	{
-		auto in_stream = std::make_shared<std::ifstream>();
-		in_stream->open(filename.c_str(), std::fstream::binary);
+		geometry = import_stl(filename);
+		if (!geometry)
+			return;	// user canceled
+	}
+	catch (std::exception& ex)
+	{
+		m_stlDrawArea->EndPreview();
 
-		if (in_stream->fail())
-			throw std::runtime_error(std::string("Error opening file: ") + ::strerror(errno));
+		std::stringstream ss;
+		ss << "There was an error reading the STL file: " << std::endl << ex.what();
 
-		stl_util::stl_importer importer(in_stream);
+		DoMessageBox("Error", ss.str().c_str());
 
-		auto tmesh = std::make_shared<triangle_mesh>();
+		return;
+	}
 
-		// Create the progress dialog
-		char* path = new char[filename.length() + 1];
-		path[filename.length()] = '\0';
-		std::copy(filename.begin(), filename.end(), path);
-		Glib::ustring fn_base(::basename(path));
-		delete[] path;
+	// We should have a mesh now
+	if (!geometry)
+		throw std::runtime_error("no mesh (weird)");
 
-		std::unique_ptr<Gtk::Dialog> progress_dialog(new Gtk::Dialog("Opening " + fn_base + " ..."));
-		Gtk::ProgressBar progress_bar;
+	set_window_title(filename);
 
-		progress_dialog->set_size_request(300, 75);
-		progress_dialog->set_border_width(5);
-		progress_dialog->set_resizable(false);
-		progress_dialog->set_deletable(false);
-		Gtk::Button* open_cancel = progress_dialog->add_button("Cancel", Gtk::RESPONSE_CANCEL);
-		progress_dialog->get_vbox()->pack_start(progress_bar, Gtk::PACK_EXPAND_WIDGET, 0);
-		progress_dialog->set_transient_for(*this);
-		progress_dialog->show_all();
+	// This is fuckin awful
+	Gtk::MenuItem* mesh_info_item = get_menu_item(MENU_ITEM_MESH_INFO_ID);
+	Gtk::MenuItem* export_vertices_item = get_menu_item(MENU_ITEM_FILE_EXPORT_POINTS_ID);
+	mesh_info_item->set_sensitive(true);
+	export_vertices_item->set_sensitive(true);
 
-		size_t const num_facets = importer.num_facets_expected();
+	m_parts.assign(1, geometry);
 
-		process_stl stl_processor(tmesh, importer);
+	m_stlDrawArea->InitMeshDO(geometry, m_show_edges);
+	m_stlDrawArea->CenterView();
+}
 
-		int const update_value_ms = 5;
-		auto timeout_connection = Glib::signal_timeout().connect(
-			[&]()
-			{
-				progress_bar.set_fraction((double) stl_processor.get_facets_processed() / (double) num_facets);
+void MainWindow::OpenFiles(const std::vector<Glib::ustring>& filenames)
+{
+	if (filenames.empty())
+		return;
 
-				return true;
-			}, update_value_ms);
+	// One file gets the progressive preview
+	if (filenames.size() == 1)
+	{
+		FileOpen(filenames.front());
+		return;
+	}
 
-		auto cancel_connection = open_cancel->signal_clicked().connect(
-			[&]()
-			{
-				timeout_connection.disconnect();
-				stl_processor.cancel();
+	ScopedWaitCursor wc(*this);
+
+	const unsigned num_threads = ResolveThreadCount(m_import_threads);
+	const size_t num_parts = filenames.size();
+
+	// Every part loads on its own worker. Spare cores (if there are more cores than parts)
+	// go to parsing the parts in parallel.
+	WorkerPool pool((unsigned) std::min<size_t>(num_threads, num_parts));
+	const unsigned part_threads = std::max(1u, num_threads / pool.NumThreads());
+
+	std::vector<std::unique_ptr<MeshLoader>> loaders;
+	std::vector<size_t> file_sizes(num_parts, 0);
+	for (size_t i = 0 ; i < num_parts ; i++)
+	{
+		loaders.emplace_back(new MeshLoader(filenames[i], part_threads, m_weld_tolerance, m_crease_angle));
+
+		struct stat st;
+		if (::stat(filenames[i].c_str(), &st) == 0)
+			file_sizes[i] = (size_t) st.st_size;
+	}
 
-				progress_dialog.reset();
+	// Start the biggest parts first, so the total time is bounded by the biggest part
+	// rather than by whichever part happened to be queued last
+	std::vector<size_t> load_order(num_parts);
+	for (size_t i = 0 ; i < num_parts ; i++)
+		load_order[i] = i;
+
+	std::stable_sort(load_order.begin(), load_order.end(),
+		[&file_sizes](size_t a, size_t b) { return file_sizes[a] > file_sizes[b]; });
+
+	const size_t total_size = std::max<size_t>(1, std::accumulate(file_sizes.begin(), file_sizes.end(), (size_t) 0));
+
+	auto const load_start = std::chrono::steady_clock::now();
+
+	for (size_t i : load_order)
+	{
+		MeshLoader* loader = loaders[i].get();
+		pool.Submit([loader]() { loader->Load(); });
+	}
+
+	// Progress dialog: the overall progress, and a row per part with its own cancel button
+	std::unique_ptr<Gtk::Dialog> progress_dialog(new Gtk::Dialog("Opening " + std::to_string(num_parts) + " files ..."));
+	Gtk::ProgressBar progress_bar;
+	Gtk::ScrolledWindow parts_window;
+	Gtk::Table parts_table((guint) num_parts, 3);
+
+	struct part_row
+	{
+		Gtk::ProgressBar*	progress_bar;
+		Gtk::Button*		cancel_button;
+		bool				finished;
+	};
+
+	std::vector<part_row> part_rows(num_parts);
+	for (size_t i = 0 ; i < num_parts ; i++)
+	{
+		char* path = new char[filenames[i].length() + 1];
+		path[filenames[i].length()] = '\0';
+		std::copy(filenames[i].begin(), filenames[i].end(), path);
+		Gtk::Label* name_label = Gtk::manage(new Gtk::Label(::basename(path)));
+		delete[] path;
 
-				tmesh.reset();
+		name_label->set_alignment(0.0, 0.5);
+		name_label->set_ellipsize(Pango::ELLIPSIZE_MIDDLE);
+
+		part_rows[i].progress_bar = Gtk::manage(new Gtk::ProgressBar);
+		part_rows[i].cancel_button = Gtk::manage(new Gtk::Button("Cancel"));
+		part_rows[i].finished = false;
+
+		MeshLoader* loader = loaders[i].get();
+		Gtk::Button* cancel_button = part_rows[i].cancel_button;
+		cancel_button->signal_clicked().connect(
+			[loader, cancel_button]()
+			{
+				loader->Cancel();
+				cancel_button->set_sensitive(false);
 			});
 
-		stl_processor.sig_done().connect(
-			[&]()
+		parts_table.attach(*name_label, 0, 1, (guint) i, (guint) i + 1, Gtk::FILL | Gtk::EXPAND, Gtk::SHRINK, 2, 2);
+		parts_table.attach(*part_rows[i].progress_bar, 1, 2, (guint) i, (guint) i + 1, Gtk::FILL, Gtk::SHRINK, 2, 2);
+		parts_table.attach(*cancel_button, 2, 3, (guint) i, (guint) i + 1, Gtk::SHRINK, Gtk::SHRINK, 2, 2);
+	}
+
+	parts_window.set_policy(Gtk::POLICY_NEVER, Gtk::POLICY_AUTOMATIC);
+	parts_window.add(parts_table);
+
+	progress_dialog->set_size_request(450, 300);
+	progress_dialog->set_border_width(5);
+	progress_dialog->set_deletable(false);
+	progress_dialog->add_button("Cancel All", Gtk::RESPONSE_CANCEL);
+	progress_dialog->get_vbox()->pack_start(progress_bar, Gtk::PACK_SHRINK, 0);
+	progress_dialog->get_vbox()->pack_start(parts_window, Gtk::PACK_EXPAND_WIDGET, 0);
+	progress_dialog->set_transient_for(*this);
+	progress_dialog->show_all();
+
+	std::vector<shared_ptr<const MeshGeometry>> parts;
+	std::vector<std::string> errors;
+	size_t num_finished = 0;
+	size_t num_facets = 0;
+	double slowest_part = 0.0;
+
+	// Picks up the parts that have finished since the last call, true once they all have
+	auto update_parts =
+		[&]()
+		{
+			double done_size = 0.0;
+			for (size_t i = 0 ; i < num_parts ; i++)
 			{
-				cancel_connection.disconnect();
+				const MeshLoader& loader = *loaders[i];
+				part_row& row = part_rows[i];
 
-				progress_bar.set_fraction(1.0);
-				open_cancel->set_sensitive(false);
+				const double part_progress = loader.Progress();
+				done_size += part_progress * file_sizes[i];
 
-				progress_dialog->queue_draw();
-				Gtk::Main::iteration();
+				if (row.finished)
+					continue;
 
-				// I guess we shouldn't rely on the main loop to do this
-				timeout_connection.disconnect();
+				row.progress_bar->set_fraction(part_progress);
 
-				progress_dialog.reset();
-			});
+				const MeshLoader::State state = loader.GetState();
+				if (state == MeshLoader::STATE_PENDING || state == MeshLoader::STATE_LOADING)
+					continue;
 
-		stl_processor.start();
+				row.finished = true;
+				row.cancel_button->set_sensitive(false);
+				num_finished++;
 
-		progress_dialog->run();
+				switch (state)
+				{
+				case MeshLoader::STATE_DONE:
+					// Show each part as soon as it's in
+					if (parts.empty())
+						m_stlDrawArea->InitSceneDO();
 
-		if (timeout_connection.connected())
-			timeout_connection.disconnect();
+					parts.push_back(loader.Geometry());
+					m_stlDrawArea->AddScenePart(loader.Geometry(), m_show_edges);
 
-		if (tmesh)
-			mesh = tmesh;
-		else
-			return;	// user canceled
+					num_facets += loader.Geometry()->NumFacets();
+					slowest_part = std::max(slowest_part, loader.Seconds());
+					row.progress_bar->set_text(loader.FromCache() ? "Cached" : "Done");
+
+					if (loader.FromCache())
+						log_cached_load(loader.Filename(), loader);
+					break;
+
+				case MeshLoader::STATE_FAILED:
+					errors.push_back(loader.Filename() + ": " + loader.Error());
+					row.progress_bar->set_text("Failed");
+					break;
+
+				default:
+					row.progress_bar->set_text("Canceled");
+					break;
+				}
+			}
+
+			progress_bar.set_fraction(std::min(1.0, done_size / total_size));
+			progress_bar.set_text(std::to_string(num_finished) + " of " + std::to_string(num_parts));
+
+			return num_finished == num_parts;
+		};
+
+	int const update_value_ms = 20;
+	auto timeout_connection = Glib::signal_timeout().connect(
+		[&]()
+		{
+			if (!update_parts())
+				return true;
+
+			progress_dialog->response(Gtk::RESPONSE_OK);
+			return false;
+		}, update_value_ms);
+
+	// Cancel All, or the dialog closed some other way (Escape)
+	if (progress_dialog->run() != Gtk::RESPONSE_OK)
+	{
+		pool.CancelPending();
+
+		for (const auto& loader : loaders)
+			loader->Cancel();
 	}
-	catch (std::exception& ex)
+
+	if (timeout_connection.connected())
+		timeout_connection.disconnect();
+
+	progress_dialog->hide();
+
+	// Let the running parts notice they've been canceled, and keep the ones that finished first
+	pool.Wait();
+	update_parts();
+
+	progress_dialog.reset();
+
+	std::chrono::duration<double> const load_time = std::chrono::steady_clock::now() - load_start;
+	std::clog	<< "Loaded " << parts.size() << " of " << num_parts << " parts, " << num_facets << " facets in "
+				<< std::fixed << std::setprecision(3) << load_time.count() << " s (slowest part "
+				<< slowest_part << " s, " << pool.NumThreads() << " parts at a time)" << std::endl;
+
+	if (!errors.empty())
 	{
 		std::stringstream ss;
-		ss << "There was an error reading the STL file: " << std::endl << ex.what();
+		ss << "There were errors reading " << errors.size() << " of the files:" << std::endl;
+		for (const std::string& error : errors)
+			ss << std::endl << error;
 
-		DoMessageBox("Error", ss.str().c_str());
+		DoMessageBox("Error", ss.str());
+	}
+
+	if (parts.empty())
+	{
+		// Nothing loaded, put back what we had before
+		if (!m_parts.empty())
+		{
+			m_stlDrawArea->InitSceneDO();
+			for (const auto& part : m_parts)
+				m_stlDrawArea->AddScenePart(part, m_show_edges);
+		}
 
 		return;
 	}
 
-	// We should have a mesh now
-	if (!mesh)
-		throw std::runtime_error("no mesh (weird)");
+	set_window_title(filenames.front());
 
-	set_window_title(filename);
+	get_menu_item(MENU_ITEM_MESH_INFO_ID)->set_sensitive(true);
+	get_menu_item(MENU_ITEM_FILE_EXPORT_POINTS_ID)->set_sensitive(true);
 
-	// This is fuckin awful
-	Gtk::MenuItem* mesh_info_item = get_menu_item(MENU_ITEM_MESH_INFO_ID);
-	Gtk::MenuItem* export_vertices_item = get_menu_item(MENU_ITEM_FILE_EXPORT_POINTS_ID);
-	mesh_info_item->set_sensitive(true);
-	export_vertices_item->set_sensitive(true);
+	m_parts = parts;
+}
 
-	m_mesh = mesh;
+shared_ptr<MeshGeometry> MainWindow::import_stl(const Glib::ustring& filename)
+{
+	// Everything happens on the loader's thread, this one shows the progress and the preview
+	MeshLoader loader(filename, m_import_threads, m_weld_tolerance, m_crease_angle);
+	loader.EnablePreview();
+
+	WorkerPool pool(1);
+	pool.Submit([&loader]() { loader.Load(); });
+
+	// Create the progress dialog
+	char* path = new char[filename.length() + 1];
+	path[filename.length()] = '\0';
+	std::copy(filename.begin(), filename.end(), path);
+	Glib::ustring fn_base(::basename(path));
+	delete[] path;
+
+	std::unique_ptr<Gtk::Dialog> progress_dialog(new Gtk::Dialog("Opening " + fn_base + " ..."));
+	Gtk::ProgressBar progress_bar;
+
+	progress_dialog->set_size_request(300, 75);
+	progress_dialog->set_border_width(5);
+	progress_dialog->set_resizable(false);
+	progress_dialog->set_deletable(false);
+	Gtk::Button* open_cancel = progress_dialog->add_button("Cancel", Gtk::RESPONSE_CANCEL);
+	progress_dialog->get_vbox()->pack_start(progress_bar, Gtk::PACK_EXPAND_WIDGET, 0);
+	progress_dialog->set_transient_for(*this);
+	progress_dialog->show_all();
+
+	auto const load_start = std::chrono::steady_clock::now();
+	auto last_preview = load_start;
+	bool first_preview = true;
+	std::vector<float> preview_corners;
+
+	int const update_value_ms = 5;
+	int const preview_interval_ms = 100;
+	auto timeout_connection = Glib::signal_timeout().connect(
+		[&]()
+		{
+			const MeshLoader::State state = loader.GetState();
+			if (state != MeshLoader::STATE_PENDING && state != MeshLoader::STATE_LOADING)
+			{
+				progress_bar.set_fraction(1.0);
+				open_cancel->set_sensitive(false);
 
-	m_stlDrawArea->InitMeshDO(m_mesh, m_show_edges);
-	m_stlDrawArea->CenterView();
+				progress_dialog->response(Gtk::RESPONSE_OK);
+				return false;
+			}
+
+			progress_bar.set_fraction(loader.Progress());
+
+			// Show the triangles as they come in. Nothing comes from the mesh cache,
+			// so the current mesh stays up until there's something to show instead.
+			auto const now = std::chrono::steady_clock::now();
+			if (first_preview || now - last_preview >= std::chrono::milliseconds(preview_interval_ms))
+			{
+				loader.TakePreview(preview_corners);
+				if (!preview_corners.empty())
+				{
+					m_stlDrawArea->BeginPreview();
+					m_stlDrawArea->AppendPreview(preview_corners);
+					last_preview = now;
+
+					if (first_preview)
+					{
+						std::chrono::duration<double, std::milli> const first_pixel = std::chrono::steady_clock::now() - load_start;
+						std::clog << "First preview of " << fn_base << " after " << first_pixel.count() << " ms" << std::endl;
+
+						first_preview = false;
+					}
+				}
+			}
+
+			return true;
+		}, update_value_ms);
+
+	// Cancel, or the dialog closed some other way (Escape)
+	if (progress_dialog->run() != Gtk::RESPONSE_OK)
+		loader.Cancel();
+
+	if (timeout_connection.connected())
+		timeout_connection.disconnect();
+
+	progress_dialog.reset();
+
+	pool.Wait();
+
+	switch (loader.GetState())
+	{
+	case MeshLoader::STATE_DONE:
+		break;
+
+	case MeshLoader::STATE_FAILED:
+		throw std::runtime_error(loader.Error());
+
+	default:
+		m_stlDrawArea->EndPreview();
+		return shared_ptr<MeshGeometry>();	// user canceled
+	}
+
+	if (loader.FromCache())
+	{
+		log_cached_load(fn_base, loader);
+	}
+	else
+	{
+		std::clog	<< "Loaded " << fn_base << ": " << loader.Geometry()->NumFacets() << " facets in "
+					<< std::fixed << std::setprecision(3) << loader.Seconds() << " s" << std::endl;
+	}
+
+	return loader.Geometry();
 }
 
 void MainWindow::do_file_open_dialog()
@@ -424,6 +633,10 @@ void MainWindow::do_file_open_dialog()
 	stl_files.set_name("STL Files");
 	stl_files.add_pattern("*.stl");
 	stl_files.add_pattern("*.STL");
+	stl_files.add_pattern("*.stl.gz");
+	stl_files.add_pattern("*.STL.GZ");
+	stl_files.add_pattern("*.stl.zst");
+	stl_files.add_pattern("*.STL.ZST");
 	fcd.add_filter(stl_files);
 
 	Gtk::FileFilter all_files;
@@ -431,17 +644,19 @@ void MainWindow::do_file_open_dialog()
 	all_files.add_pattern("*");
 	fcd.add_filter(all_files);
 
+	fcd.set_select_multiple(true);
+
 	const int response = fcd.run();
-	const Glib::ustring filename = fcd.get_filename();
+	const std::vector<Glib::ustring> filenames = fcd.get_filenames();
 
 	fcd.hide_all();
 	if (response == Gtk::RESPONSE_OK)
-		FileOpen(filename);
+		OpenFiles(filenames);
 }
 
 void MainWindow::on_file_export_vertices()
 {
-	if (!m_mesh)
+	if (m_parts.empty())
 		return;
 
 	Gtk::FileChooserDialog fcd(*this /* parent */, "Export Vertices");
@@ -476,8 +691,6 @@ void MainWindow::on_file_export_vertices()
 	if (response != Gtk::RESPONSE_OK)
 		return;
 
-	const auto& vertices = m_mesh->get_vertices();
-
 	std::ofstream os(filename.c_str());
 	if (os.fail())
 	{
@@ -487,11 +700,12 @@ void MainWindow::on_file_export_vertices()
 
 	ScopedWaitCursor wc(*this);
 
-	for (const auto& vert : vertices)
+	for (const auto& part : m_parts)
 	{
-		const auto& vp = vert->get_point();
+		const GeometryArray<float>& positions = part->positions;
 
-		os << vp.x() << " " << vp.y() << " " << vp.z() << std::endl;
+		for (size_t i = 0 ; i < positions.size() ; i += 3)
+			os << positions[i] << " " << positions[i + 1] << " " << positions[i + 2] << std::endl;
 	}
 }
 
@@ -499,17 +713,63 @@ void MainWindow::on_view_show_edges()
 {
 	m_show_edges = !m_show_edges;
 
-	if (!m_mesh)
+	if (m_parts.empty())
 		return;
 
 	ScopedWaitCursor wc(*this);
 
-	auto& do_children = m_stlDrawArea->GetDisplayObject()->GetChildren();
-	DisplayObject::DOPtr& mesh_edges = do_children.front();
+	m_stlDrawArea->ShowEdges(m_show_edges);
+}
 
-	mesh_edges->Suppressed() = !m_show_edges;
+void MainWindow::SetFeatureAngle(double feature_angle)
+{
+	if (feature_angle > 0.0)
+		m_feature_angle = feature_angle;
+
+	Gtk::CheckMenuItem* feature_edges_item = dynamic_cast<Gtk::CheckMenuItem*>(get_menu_item(MENU_ITEM_FEATURE_EDGES_ID));
+	if (feature_edges_item && feature_edges_item->get_active() != (feature_angle > 0.0))
+		feature_edges_item->set_active(feature_angle > 0.0);	// calls on_view_feature_edges()
+	else
+		m_stlDrawArea->SetFeatureAngle(m_feature_edges ? m_feature_angle : 0.0);
+}
 
-	m_stlDrawArea->Redraw();
+void MainWindow::on_view_feature_edges()
+{
+	m_feature_edges = !m_feature_edges;
+
+	// Nothing gets rebuilt, the edges are already sorted by angle
+	m_stlDrawArea->SetFeatureAngle(m_feature_edges ? m_feature_angle : 0.0);
+}
+
+void MainWindow::on_view_feature_angle()
+{
+	// Adjusting the angle only makes sense when we're showing feature edges
+	if (!m_feature_edges)
+		SetFeatureAngle(m_feature_angle);
+
+	Gtk::Dialog dlg("Feature Edge Angle");
+	Gtk::Label label("Show edges where the facets meet at more than (degrees):");
+	Gtk::HScale angle_scale(1.0, 180.0, 1.0);
+
+	angle_scale.set_digits(0);
+	angle_scale.set_value(m_feature_angle);
+	angle_scale.set_size_request(300, -1);
+
+	// The view follows the slider
+	angle_scale.signal_value_changed().connect(
+		[this, &angle_scale]()
+		{
+			SetFeatureAngle(angle_scale.get_value());
+		});
+
+	dlg.get_vbox()->pack_start(label, Gtk::PACK_SHRINK, 0);
+	dlg.get_vbox()->pack_start(angle_scale, Gtk::PACK_EXPAND_WIDGET, 0);
+	dlg.get_vbox()->set_border_width(10);
+	dlg.add_button("Close", Gtk::RESPONSE_CLOSE);
+	dlg.set_transient_for(*this);
+	dlg.show_all();
+
+	dlg.run();
 }
 
 void MainWindow::on_view_enable_back_face_culling()
@@ -519,39 +779,76 @@ void MainWindow::on_view_enable_back_face_culling()
 	m_stlDrawArea->Redraw();
 }
 
+void MainWindow::SetShowFrameStats(bool show_frame_stats)
+{
+	Gtk::CheckMenuItem* frame_stats_item = dynamic_cast<Gtk::CheckMenuItem*>(get_menu_item(MENU_ITEM_FRAME_STATS_ID));
+	if (frame_stats_item && frame_stats_item->get_active() != show_frame_stats)
+		frame_stats_item->set_active(show_frame_stats);	// calls on_view_frame_stats()
+	else
+		m_stlDrawArea->ShowFrameStats(show_frame_stats);
+}
+
+void MainWindow::on_view_frame_stats()
+{
+	m_stlDrawArea->ShowFrameStats(!m_stlDrawArea->FrameStatsShown());
+}
+
 void MainWindow::on_view_mesh_info()
 {
-	if (!m_mesh)
+	if (m_parts.empty())
 		return;
 
-	std::string mesh_info;
+	MeshStats stats = m_parts.front()->stats;
 
+	// For an assembly, add up the parts
+	if (m_parts.size() > 1)
 	{
-		ScopedWaitCursor wc(*this);
+		stats = MeshStats();
+		stats.name = std::to_string(m_parts.size()) + " parts";
+		stats.is_closed = true;
 
-		int const num_facets = m_mesh->get_facets().size();
-		int const num_edges = m_mesh->get_edges().size();
-		int const num_vertices = m_mesh->get_vertices().size();
+		float bbox_min[3], bbox_max[3];
+		std::copy(m_parts.front()->bbox_min, m_parts.front()->bbox_min + 3, bbox_min);
+		std::copy(m_parts.front()->bbox_max, m_parts.front()->bbox_max + 3, bbox_max);
 
-		std::stringstream ss;
-		ss	<< "Name: " << m_mesh->name() << std::endl
-			<< "Number of facets: " << num_facets << std::endl
-			<< "Number of edges: " << num_edges << std::endl
-			<< "Number of vertices: " << num_vertices << std::endl
-			<< "Euler characteristic " << (num_vertices - num_edges + num_facets) << std::endl
-			<< "Number of lamina edges: " << m_mesh->get_lamina_halfedges().size() << std::endl
-			<< "Volume: " << m_mesh->volume() << std::endl
-			<< "Area: " << m_mesh->area() << std::endl
-			<< "Is Closed: " << (m_mesh->is_manifold() ? "TRUE" : "FALSE") << std::endl << std::endl
-			<< "BBox dimensions: " << std::endl <<
-			std::setprecision(4) << "X: " << m_mesh->bbox().extent_x() << " "
-								 << "Y: " << m_mesh->bbox().extent_y() << " "
-								 << "Z: " << m_mesh->bbox().extent_z() << std::endl;
-
-		mesh_info = ss.str();
+		for (const auto& part : m_parts)
+		{
+			const MeshStats& part_stats = part->stats;
+			stats.num_facets += part_stats.num_facets;
+			stats.num_edges += part_stats.num_edges;
+			stats.num_vertices += part_stats.num_vertices;
+			stats.num_lamina_edges += part_stats.num_lamina_edges;
+			stats.volume += part_stats.volume;
+			stats.area += part_stats.area;
+			stats.is_closed = stats.is_closed && part_stats.is_closed;
+
+			for (int k = 0 ; k < 3 ; k++)
+			{
+				bbox_min[k] = std::min(bbox_min[k], part->bbox_min[k]);
+				bbox_max[k] = std::max(bbox_max[k], part->bbox_max[k]);
+			}
+		}
+
+		for (int k = 0 ; k < 3 ; k++)
+			stats.extent[k] = bbox_max[k] - bbox_min[k];
 	}
 
-	DoMessageBox("Mesh Info", mesh_info);
+	std::stringstream ss;
+	ss	<< "Name: " << stats.name << std::endl
+		<< "Number of facets: " << stats.num_facets << std::endl
+		<< "Number of edges: " << stats.num_edges << std::endl
+		<< "Number of vertices: " << stats.num_vertices << std::endl
+		<< "Euler characteristic " << stats.EulerCharacteristic() << std::endl
+		<< "Number of lamina edges: " << stats.num_lamina_edges << std::endl
+		<< "Volume: " << stats.volume << std::endl
+		<< "Area: " << stats.area << std::endl
+		<< "Is Closed: " << (stats.is_closed ? "TRUE" : "FALSE") << std::endl << std::endl
+		<< "BBox dimensions: " << std::endl <<
+		std::setprecision(4) << "X: " << stats.extent[0] << " "
+							 << "Y: " << stats.extent[1] << " "
+							 << "Z: " << stats.extent[2] << std::endl;
+
+	DoMessageBox("Mesh Info", ss.str());
 }
 
 void MainWindow::on_help_opengl_info()
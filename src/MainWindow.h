@@ -11,11 +11,12 @@
 #include "STLDrawArea.h"
 
 #include <string>
+#include <vector>
 #include <memory>
 #include <gtkmm.h>
 #include <gtkmm/box.h>
 
-class triangle_mesh;
+struct MeshGeometry;
 
 /**	Displays a wait cursor for the given window until the object goes out of scope
  *  Does Gtkmm not have this? */
@@ -40,7 +41,7 @@ class MainWindow : public Gtk::Window
 {
 private:
 	std::unique_ptr<STLDrawArea>	m_stlDrawArea;
-	std::shared_ptr<triangle_mesh>	m_mesh;	// The current mesh to display
+	std::vector<std::shared_ptr<const MeshGeometry>>	m_parts;	// The meshes currently displayed
 
 	Gtk::VBox		m_vBox;
 	Gtk::MenuBar	m_menuBar;
@@ -48,12 +49,19 @@ private:
 	Glib::ustring	m_current_filename;
 
 	bool 			m_show_edges;
+	unsigned		m_import_threads;	// 0 for one per core
+	double			m_weld_tolerance;	// 0 to only weld coincident vertices
+	double			m_crease_angle;		// degrees
+	bool			m_feature_edges;	// only show the feature edges
+	double			m_feature_angle;	// degrees
 
 	static const Glib::ustring		APP_NAME;
 	static const Glib::ustring		MENU_ITEM_DATA_KEYNAME;
 
 	static const size_t				MENU_ITEM_MESH_INFO_ID;
 	static const size_t				MENU_ITEM_FILE_EXPORT_POINTS_ID;
+	static const size_t				MENU_ITEM_FEATURE_EDGES_ID;
+	static const size_t				MENU_ITEM_FRAME_STATS_ID;
 
 public:
 	MainWindow();
@@ -68,6 +76,42 @@ public:
 
 	void FileOpen(const Glib::ustring& filename);
 
+	/** Opens several files at once, into one scene.
+	 *  The files load concurrently, and each one is shown as soon as it's loaded.
+	 *  A single file is opened with FileOpen().
+	 */
+	void OpenFiles(const std::vector<Glib::ustring>& filenames);
+
+	/** Sets the number of threads used to parse STL files.
+	 *  @param num_threads	The number of parser threads, or 0 for one per core
+	 */
+	void SetImportThreads(unsigned num_threads) { m_import_threads = num_threads; }
+
+	/** Sets the cell size used to weld triangle corners into shared vertices.
+	 *  @param tolerance	The weld tolerance, or 0 to only weld coincident corners
+	 */
+	void SetWeldTolerance(double tolerance) { m_weld_tolerance = tolerance; }
+
+	/** Sets the angle (in degrees) above which facets don't share normals */
+	void SetCreaseAngle(double crease_angle) { m_crease_angle = crease_angle; }
+
+	/** Shows only the edges whose facets meet at more than feature_angle degrees,
+	 *  or all the edges if it's 0
+	 */
+	void SetFeatureAngle(double feature_angle);
+
+	/** Sets how meshes are drawn. Only affects meshes loaded afterwards. */
+	void SetRenderer(STLDrawArea::Renderer renderer) { m_stlDrawArea->SetRenderer(renderer); }
+
+	/** Logs how long each frame takes to draw */
+	void SetLogDrawTimes(bool log_draw_times) { m_stlDrawArea->SetLogDrawTimes(log_draw_times); }
+
+	/** Shows or hides the frame statistics over the view */
+	void SetShowFrameStats(bool show_frame_stats);
+
+	/** How long after a drag to wait for more input before drawing at full quality */
+	void SetSettleTime(unsigned settle_ms) { m_stlDrawArea->SetSettleTime(settle_ms); }
+
 protected:
 	// Signal handlers
 	//virtual bool on_key_press_event(GdkEventKey * event);
@@ -76,12 +120,23 @@ protected:
 	void do_file_open_dialog();
 	void on_file_export_vertices();
 	void on_view_show_edges();
+	void on_view_feature_edges();
+	void on_view_feature_angle();
 	void on_view_enable_back_face_culling();
+	void on_view_frame_stats();
 	void on_view_mesh_info();
 	void on_help_opengl_info();
 
 	// Other stuff
 
+	/** Loads an STL file with a MeshLoader, from the mesh cache if it's there,
+	 *  showing progress and the triangles as they come in.
+	 *  @param	filename		The file to import
+	 *  @returns				The geometry, or null if the user canceled
+	 *  @throws std::exception if the file couldn't be read
+	 */
+	std::shared_ptr<MeshGeometry> import_stl(const Glib::ustring& filename);
+
 	/** Sets the current window title.
 	 *  @param current_fn	The current file that is open.
 	 *  					Empty if no file is currently open.
@@ -0,0 +1,66 @@
+/*
+ * MappedFile.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile(const std::string& filename)
+: m_fd(-1)
+, m_data(nullptr)
+, m_size(0)
+{
+	m_fd = ::open(filename.c_str(), O_RDONLY);
+	if (m_fd == -1)
+		throw std::runtime_error(std::string("Error opening file: ") + ::strerror(errno));
+
+	struct stat st;
+	if (::fstat(m_fd, &st) == -1)
+	{
+		const int err = errno;
+		::close(m_fd);
+		throw std::runtime_error(std::string("Error reading file size: ") + ::strerror(err));
+	}
+
+	m_size = (size_t) st.st_size;
+
+	// mmap() doesn't like zero-length mappings
+	if (m_size == 0)
+		return;
+
+	void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+	if (data == MAP_FAILED)
+	{
+		const int err = errno;
+		::close(m_fd);
+		throw std::runtime_error(std::string("Error mapping file: ") + ::strerror(err));
+	}
+
+	m_data = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_data)
+		::munmap(const_cast<char*>(m_data), m_size);
+
+	if (m_fd != -1)
+		::close(m_fd);
+}
+
+void MappedFile::AdviseSequential() const
+{
+	if (m_data)
+		::madvise(const_cast<char*>(m_data), m_size, MADV_SEQUENTIAL);
+}
@@ -0,0 +1,42 @@
+/*
+ * MappedFile.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <cstddef>
+
+/** A read-only memory mapping of an entire file.
+ *  The mapping is released when the object is destroyed.
+ */
+class MappedFile
+{
+private:
+	int				m_fd;
+	const char*		m_data;
+	size_t			m_size;
+
+public:
+	/** Constructor.
+	 *  Maps the given file into memory.
+	 *  @throws std::runtime_error if the file could not be opened or mapped
+	 */
+	explicit MappedFile(const std::string& filename);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char*	Data() const { return m_data; }
+	size_t		Size() const { return m_size; }
+
+	/** Tells the kernel we are going to read the mapping front-to-back */
+	void AdviseSequential() const;
+};
+
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,126 @@
+/*
+ * MeshBVH.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MeshBVH.h"
+#include "MeshGeometry.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	/** Morton code bits per axis */
+	const int MORTON_BITS = 10;
+
+	/** Spreads the low 10 bits of x out to every third bit */
+	inline uint32_t spread_bits(uint32_t x)
+	{
+		x &= 0x3ff;
+		x = (x | (x << 16)) & 0x030000ff;
+		x = (x | (x << 8)) & 0x0300f00f;
+		x = (x | (x << 4)) & 0x030c30c3;
+		x = (x | (x << 2)) & 0x09249249;
+
+		return x;
+	}
+
+	struct morton_facet
+	{
+		uint32_t	code;
+		uint32_t	facet;
+
+		bool operator<(const morton_facet& rhs) const
+		{
+			return code != rhs.code ? code < rhs.code : facet < rhs.facet;
+		}
+	};
+};
+
+//static
+MeshBVH MeshBVH::Build(const std::vector<Box>& leaves)
+{
+	MeshBVH bvh;
+	if (!leaves.empty())
+	{
+		bvh.m_nodes.reserve(2 * leaves.size());
+		bvh.build(leaves, 0, (uint32_t) leaves.size());
+	}
+
+	return bvh;
+}
+
+void MeshBVH::build(const std::vector<Box>& leaves, uint32_t first_leaf, uint32_t num_leaves)
+{
+	const uint32_t index = (uint32_t) m_nodes.size();
+	m_nodes.push_back(node());
+
+	Box box = leaves[first_leaf];
+	for (uint32_t i = first_leaf + 1 ; i < first_leaf + num_leaves ; i++)
+	{
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			box.min[k] = std::min(box.min[k], leaves[i].min[k]);
+			box.max[k] = std::max(box.max[k], leaves[i].max[k]);
+		}
+	}
+
+	if (num_leaves > 1)
+	{
+		const uint32_t num_left = num_leaves / 2;
+		build(leaves, first_leaf, num_left);
+		build(leaves, first_leaf + num_left, num_leaves - num_left);
+	}
+
+	// m_nodes may have moved while the children were added
+	node& n = m_nodes[index];
+	n.box = box;
+	n.first_leaf = first_leaf;
+	n.num_leaves = num_leaves;
+	n.next = (uint32_t) m_nodes.size();
+}
+
+//static
+std::vector<uint32_t> MeshBVH::SpatialOrder(const MeshGeometry& geometry, unsigned num_threads)
+{
+	const size_t num_facets = geometry.NumFacets();
+
+	float scale[3];
+	for (int k = 0 ; k < 3 ; k++)
+	{
+		const float extent = geometry.bbox_max[k] - geometry.bbox_min[k];
+		scale[k] = extent > 0.0f ? ((1 << MORTON_BITS) - 1) / extent : 0.0f;
+	}
+
+	std::vector<morton_facet> keys(num_facets);
+	ParallelFor(0, num_facets, num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (size_t f = begin ; f < end ; f++)
+			{
+				uint32_t cell[3];
+				for (int k = 0 ; k < 3 ; k++)
+				{
+					const float centroid = (geometry.CornerPosition(f, 0)[k] + geometry.CornerPosition(f, 1)[k] +
+											geometry.CornerPosition(f, 2)[k]) / 3.0f;
+					const float q = (centroid - geometry.bbox_min[k]) * scale[k];
+					cell[k] = (uint32_t) std::min(std::max(q, 0.0f), (float) ((1 << MORTON_BITS) - 1));
+				}
+
+				keys[f].code = spread_bits(cell[0]) | (spread_bits(cell[1]) << 1) | (spread_bits(cell[2]) << 2);
+				keys[f].facet = (uint32_t) f;
+			}
+		});
+
+	ParallelSort(keys, std::less<morton_facet>(), num_threads);
+
+	std::vector<uint32_t> order(num_facets);
+	for (size_t i = 0 ; i < num_facets ; i++)
+		order[i] = keys[i].facet;
+
+	return order;
+}
@@ -0,0 +1,106 @@
+/*
+ * MeshBVH.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MESHBVH_H_
+#define MESHBVH_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "Frustum.h"
+
+struct MeshGeometry;
+
+/** A bounding volume hierarchy over the chunks of a mesh, for view-frustum culling.
+ *
+ *  The chunks (the leaves) must already be in a spatially coherent order, which
+ *  SpatialOrder() gives the facets, so every node covers a contiguous run of chunks
+ *  and the tree is just the run split in halves. The nodes are stored depth first,
+ *  each with the index of the node after its subtree, so culling needs no stack.
+ */
+class MeshBVH
+{
+public:
+	struct Box
+	{
+		float	min[3];
+		float	max[3];
+	};
+
+private:
+	struct node
+	{
+		Box			box;
+		uint32_t	first_leaf;
+		uint32_t	num_leaves;
+		uint32_t	next;		///< The node after this one's subtree
+	};
+
+	std::vector<node>	m_nodes;
+
+	void build(const std::vector<Box>& leaves, uint32_t first_leaf, uint32_t num_leaves);
+
+public:
+	/** Builds the hierarchy over the leaves' boxes */
+	static MeshBVH Build(const std::vector<Box>& leaves);
+
+	/** The facets of geometry, sorted along a Morton curve through their centroids.
+	 *  Consecutive facets in this order are close together.
+	 */
+	static std::vector<uint32_t> SpatialOrder(const MeshGeometry& geometry, unsigned num_threads = 0);
+
+	bool	IsEmpty() const		{ return m_nodes.empty(); }
+	size_t	NumNodes() const	{ return m_nodes.size(); }
+
+	/** Calls visible(first_leaf, num_leaves) for each run of leaves that may be inside frustum,
+	 *  in leaf order. Runs next to each other are merged.
+	 */
+	template <typename Func>
+	void Cull(const Frustum& frustum, Func visible) const
+	{
+		uint32_t run_first = 0, run_count = 0;
+
+		for (uint32_t i = 0 ; i < m_nodes.size() ; )
+		{
+			const node& n = m_nodes[i];
+			const Frustum::Containment containment = frustum.Classify(n.box.min, n.box.max);
+
+			if (containment == Frustum::OUTSIDE)
+			{
+				i = n.next;
+				continue;
+			}
+
+			if (containment == Frustum::INTERSECTS && n.num_leaves > 1)
+			{
+				i++;	// into the children
+				continue;
+			}
+
+			if (run_count > 0 && run_first + run_count == n.first_leaf)
+			{
+				run_count += n.num_leaves;
+			}
+			else
+			{
+				if (run_count > 0)
+					visible(run_first, run_count);
+
+				run_first = n.first_leaf;
+				run_count = n.num_leaves;
+			}
+
+			i = n.next;
+		}
+
+		if (run_count > 0)
+			visible(run_first, run_count);
+	}
+};
+
+#endif /* MESHBVH_H_ */
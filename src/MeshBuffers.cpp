@@ -0,0 +1,484 @@
+/*
+ * MeshBuffers.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MeshBuffers.h"
+#include "MeshGeometry.h"
+#include "SplitNormals.h"
+#include "Frustum.h"
+#include "VertexCacheOptimizer.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace
+{
+	const uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+	/** How many facets Build() does between looks at the cancel flag */
+	const size_t CANCEL_CHECK_FACETS = 1 << 16;
+
+	/** The most facets in a chunk, so culling can skip most of a mesh that's mostly off screen.
+	 *  Much smaller and the draw calls start to cost more than the culling saves.
+	 */
+	const size_t CULL_CHUNK_FACETS = 8192;
+
+	inline int16_t quantize_position(float p, float offset, float scale)
+	{
+		return (int16_t) std::lround(std::max(-32767.0f, std::min(32767.0f, (p - offset) / scale)));
+	}
+
+	/** Folds the normal onto the octahedron |x| + |y| + |z| = 1, and that onto the square |x| + |y| <= 1,
+	 *  as in Cigolle et al., "A Survey of Efficient Representations for Independent Unit Vectors"
+	 */
+	inline void encode_normal(const float n[3], int8_t encoded[2])
+	{
+		const float length = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+		if (length == 0.0f)
+		{
+			encoded[0] = encoded[1] = 0;
+			return;
+		}
+
+		float x = n[0] / length;
+		float y = n[1] / length;
+		if (n[2] < 0.0f)
+		{
+			const float folded_x = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			const float folded_y = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = folded_x;
+			y = folded_y;
+		}
+
+		encoded[0] = (int8_t) std::lround(x * 127.0f);
+		encoded[1] = (int8_t) std::lround(y * 127.0f);
+	}
+
+	/** Which of +x, -x, +y, -y, +z, -z the normal is closest to */
+	inline uint8_t normal_bucket(const float n[3])
+	{
+		int axis = 0;
+		for (int k = 1 ; k < 3 ; k++)
+		{
+			if (std::fabs(n[k]) > std::fabs(n[axis]))
+				axis = k;
+		}
+
+		return (uint8_t) (2 * axis + (n[axis] < 0.0f ? 1 : 0));
+	}
+
+	/** Reorders each CULL_CHUNK_FACETS run of order by normal_bucket(), keeping the spatial
+	 *  order within each bucket, so facets facing the same way end up in the same meshlets.
+	 *  Sets buckets to each facet's normal_bucket().
+	 */
+	void group_by_normal(const MeshGeometry& geometry, std::vector<uint32_t>& order, std::vector<uint8_t>& buckets)
+	{
+		buckets.resize(geometry.NumFacets());
+		for (size_t f = 0 ; f < buckets.size() ; f++)
+		{
+			float n[3];
+			geometry.FacetNormal(f, n);
+			buckets[f] = normal_bucket(n);
+		}
+
+		for (size_t first = 0 ; first < order.size() ; first += CULL_CHUNK_FACETS)
+		{
+			const size_t last = std::min(order.size(), first + CULL_CHUNK_FACETS);
+			std::stable_sort(order.begin() + first, order.begin() + last,
+				[&buckets](uint32_t a, uint32_t b) { return buckets[a] < buckets[b]; });
+		}
+	}
+
+	/** Reorders the facets of each bucket of each CULL_CHUNK_FACETS run (as group_by_normal() left
+	 *  them) for the vertex cache, and then for overdraw. The facets stay in their runs and buckets,
+	 *  so the chunks and meshlets come out the same shape.
+	 *  @param	buckets	The normal_bucket() of each facet, in buffer order
+	 *  @param	center	Where the clusters face away from, the middle of the mesh
+	 */
+	void optimize_for_cache(MeshBuffers& buffers, const std::vector<uint8_t>& buckets, const float center[3],
+							const std::atomic<bool>* cancel)
+	{
+		const size_t num_facets = buffers.indices.size() / 3;
+		const size_t num_runs = (num_facets + CULL_CHUNK_FACETS - 1) / CULL_CHUNK_FACETS;
+
+		std::vector<float> positions(3 * buffers.vertices.size());
+		for (size_t v = 0 ; v < buffers.vertices.size() ; v++)
+			buffers.VertexPosition((uint32_t) v, &positions[3 * v]);
+
+		ParallelFor(0, num_runs, 0,
+			[&](size_t begin, size_t end, size_t)
+			{
+				VertexCacheOptimizer optimizer;
+
+				for (size_t run = begin ; run < end ; run++)
+				{
+					if (cancel && cancel->load(std::memory_order_relaxed))
+						return;
+
+					const size_t run_end = std::min(num_facets, (run + 1) * CULL_CHUNK_FACETS);
+					size_t first = run * CULL_CHUNK_FACETS;
+					while (first < run_end)
+					{
+						size_t last = first + 1;
+						while (last < run_end && buckets[last] == buckets[first])
+							last++;
+
+						uint32_t* indices = &buffers.indices[3 * first];
+						optimizer.Optimize(indices, last - first);
+						VertexCacheOptimizer::ClusterForOverdraw(indices, last - first, positions.data(), 3 * sizeof(float), center);
+
+						first = last;
+					}
+				}
+			});
+	}
+
+	/** Renumbers the vertices in the order the facets first use them, so they're fetched in order.
+	 *  Each CULL_CHUNK_FACETS run gets its own copies of the vertices it shares with earlier runs,
+	 *  and a facet gets a new copy of a vertex more than half of max_chunk_vertices back, so the
+	 *  chunks span narrow vertex ranges (the range limit for glDrawRangeElements is only 3000 on
+	 *  some drivers) at the cost of a few more vertices along the run and bucket boundaries.
+	 */
+	void renumber_vertices(MeshBuffers& buffers, size_t max_chunk_vertices)
+	{
+		const size_t window = std::max<size_t>(3, max_chunk_vertices / 2);
+
+		std::vector<uint32_t> new_ids(buffers.vertices.size(), NO_VERTEX);
+		std::vector<MeshBuffers::Vertex> vertices;
+		vertices.reserve(buffers.vertices.size());
+
+		uint32_t run_first_id = 0;
+		for (size_t i = 0 ; i < buffers.indices.size() ; i++)
+		{
+			if (i % (3 * CULL_CHUNK_FACETS) == 0)
+				run_first_id = (uint32_t) vertices.size();
+
+			uint32_t& index = buffers.indices[i];
+			if (new_ids[index] == NO_VERTEX || new_ids[index] < run_first_id || vertices.size() - new_ids[index] > window)
+			{
+				new_ids[index] = (uint32_t) vertices.size();
+				vertices.push_back(buffers.vertices[index]);
+			}
+
+			index = new_ids[index];
+		}
+
+		buffers.vertices.swap(vertices);
+	}
+
+	/** Splits each chunk into meshlets, at most MAX_MESHLET_FACETS and only one normal bucket each */
+	void build_meshlets(MeshBuffers& buffers)
+	{
+		const std::vector<uint32_t>& indices = buffers.indices;
+		MeshBuffers::Meshlets& meshlets = buffers.meshlets;
+
+		std::vector<float> normals;
+		for (MeshBuffers::Chunk& chunk : buffers.chunks)
+		{
+			chunk.first_meshlet = (uint32_t) meshlets.Size();
+
+			const size_t chunk_end = chunk.first_index + chunk.num_indices;
+			size_t first = chunk.first_index;
+			while (first < chunk_end)
+			{
+				// Take facets until the bucket changes or the meshlet is full
+				normals.clear();
+				size_t last = first;
+				while (last < chunk_end && normals.size() < 3 * MeshBuffers::Meshlets::MAX_MESHLET_FACETS)
+				{
+					float p[3][3], n[3];
+					for (int k = 0 ; k < 3 ; k++)
+						buffers.VertexPosition(indices[last + k], p[k]);
+
+					SplitNormals::FacetNormal(p[0], p[1], p[2], n);
+					if (!normals.empty() && normal_bucket(n) != normal_bucket(&normals[0]))
+						break;
+
+					normals.insert(normals.end(), n, n + 3);
+					last += 3;
+				}
+
+				// The cone: the mean normal, and the widest angle from it to a facet normal
+				float axis[3] = { 0.0f, 0.0f, 0.0f };
+				for (size_t i = 0 ; i < normals.size() ; i += 3)
+				{
+					for (int k = 0 ; k < 3 ; k++)
+						axis[k] += normals[i + k];
+				}
+
+				const float axis_len = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+				float min_dot = axis_len > 0.0f ? 1.0f : -1.0f;
+				for (int k = 0 ; k < 3 && axis_len > 0.0f ; k++)
+					axis[k] /= axis_len;
+
+				for (size_t i = 0 ; i < normals.size() ; i += 3)
+				{
+					const float* n = &normals[i];
+					const bool degenerate = n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f;
+					if (!degenerate)
+						min_dot = std::min(min_dot, axis[0] * n[0] + axis[1] * n[1] + axis[2] * n[2]);
+				}
+
+				// The sphere: around the middle of the box
+				float box_min[3], box_max[3];
+				std::fill(box_min, box_min + 3, std::numeric_limits<float>::max());
+				std::fill(box_max, box_max + 3, -std::numeric_limits<float>::max());
+				for (size_t i = first ; i < last ; i++)
+				{
+					float p[3];
+					buffers.VertexPosition(indices[i], p);
+					for (int k = 0 ; k < 3 ; k++)
+					{
+						box_min[k] = std::min(box_min[k], p[k]);
+						box_max[k] = std::max(box_max[k], p[k]);
+					}
+				}
+
+				float center[3];
+				for (int k = 0 ; k < 3 ; k++)
+					center[k] = 0.5f * (box_min[k] + box_max[k]);
+
+				float radius_sq = 0.0f;
+				for (size_t i = first ; i < last ; i++)
+				{
+					float p[3];
+					buffers.VertexPosition(indices[i], p);
+					const float d[3] = { p[0] - center[0], p[1] - center[1], p[2] - center[2] };
+					radius_sq = std::max(radius_sq, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+				}
+
+				meshlets.first_index.push_back((uint32_t) first);
+				meshlets.num_indices.push_back((uint32_t) (last - first));
+				meshlets.axis_x.push_back(axis[0]);
+				meshlets.axis_y.push_back(axis[1]);
+				meshlets.axis_z.push_back(axis[2]);
+				meshlets.cutoff.push_back(min_dot > 0.0f ? std::sqrt(std::max(0.0f, 1.0f - min_dot * min_dot)) : 2.0f);
+				meshlets.center_x.push_back(center[0]);
+				meshlets.center_y.push_back(center[1]);
+				meshlets.center_z.push_back(center[2]);
+				meshlets.radius.push_back(std::sqrt(radius_sq));
+
+				first = last;
+			}
+
+			chunk.num_meshlets = (uint32_t) meshlets.Size() - chunk.first_meshlet;
+		}
+	}
+
+	/** Splits indices into chunks of whole facets within the given limits, and bounds them */
+	void build_chunks(MeshBuffers& buffers, size_t max_chunk_indices, size_t max_chunk_vertices)
+	{
+		max_chunk_indices = std::min(max_chunk_indices, 3 * CULL_CHUNK_FACETS);
+		max_chunk_indices = std::max<size_t>(3, max_chunk_indices - max_chunk_indices % 3);
+		max_chunk_vertices = std::max<size_t>(1, max_chunk_vertices);
+
+		const std::vector<uint32_t>& indices = buffers.indices;
+
+		MeshBuffers::Chunk chunk = { 0, 0, NO_VERTEX, 0, MeshBVH::Box(), 0, 0 };
+		for (size_t i = 0 ; i < indices.size() ; i += 3)
+		{
+			const uint32_t facet_min = std::min({ indices[i], indices[i + 1], indices[i + 2] });
+			const uint32_t facet_max = std::max({ indices[i], indices[i + 1], indices[i + 2] });
+
+			const uint32_t new_min = std::min(chunk.min_vertex, facet_min);
+			const uint32_t new_max = std::max(chunk.max_vertex, facet_max);
+
+			if (chunk.num_indices > 0 &&
+				(chunk.num_indices + 3 > max_chunk_indices || (size_t) (new_max - new_min) + 1 > max_chunk_vertices))
+			{
+				buffers.chunks.push_back(chunk);
+				chunk = { i, 0, facet_min, facet_max, MeshBVH::Box(), 0, 0 };
+			}
+			else
+			{
+				chunk.min_vertex = new_min;
+				chunk.max_vertex = new_max;
+			}
+
+			chunk.num_indices += 3;
+		}
+
+		if (chunk.num_indices > 0)
+			buffers.chunks.push_back(chunk);
+
+		std::vector<MeshBVH::Box> boxes;
+		boxes.reserve(buffers.chunks.size());
+
+		for (MeshBuffers::Chunk& c : buffers.chunks)
+		{
+			MeshBVH::Box& box = c.box;
+			std::fill(box.min, box.min + 3, std::numeric_limits<float>::max());
+			std::fill(box.max, box.max + 3, -std::numeric_limits<float>::max());
+
+			for (size_t i = c.first_index ; i < c.first_index + c.num_indices ; i++)
+			{
+				float p[3];
+				buffers.VertexPosition(indices[i], p);
+				for (int k = 0 ; k < 3 ; k++)
+				{
+					box.min[k] = std::min(box.min[k], p[k]);
+					box.max[k] = std::max(box.max[k], p[k]);
+				}
+			}
+
+			boxes.push_back(box);
+		}
+
+		buffers.bvh = MeshBVH::Build(boxes);
+	}
+
+	void set_quantization(const MeshGeometry& geometry, MeshBuffers& buffers)
+	{
+		for (int k = 0 ; k < 3 && geometry.NumFacets() > 0 ; k++)
+		{
+			const float half_size = 0.5f * (geometry.bbox_max[k] - geometry.bbox_min[k]);
+			buffers.position_offset[k] = 0.5f * (geometry.bbox_min[k] + geometry.bbox_max[k]);
+			buffers.position_scale[k] = half_size > 0.0f ? half_size / 32767.0f : 1.0f;
+		}
+	}
+
+	void build_edges(const MeshGeometry& geometry, MeshBuffers& buffers)
+	{
+		buffers.edge_positions.resize(geometry.positions.size());
+		for (size_t i = 0 ; i < geometry.positions.size() ; i++)
+			buffers.edge_positions[i] = quantize_position(geometry.positions[i], buffers.position_offset[i % 3], buffers.position_scale[i % 3]);
+
+		buffers.edge_indices.reserve(geometry.edges.size() + geometry.lamina_edges.size());
+		buffers.edge_indices.insert(buffers.edge_indices.end(), geometry.edges.begin(), geometry.edges.end());
+		buffers.edge_indices.insert(buffers.edge_indices.end(), geometry.lamina_edges.begin(), geometry.lamina_edges.end());
+		buffers.num_lamina_indices = geometry.lamina_edges.size();
+	}
+};
+
+//static
+MeshBuffers MeshBuffers::Build(const MeshGeometry& geometry, size_t max_chunk_indices, size_t max_chunk_vertices,
+							   const std::atomic<bool>* cancel)
+{
+	MeshBuffers buffers;
+
+	const size_t num_facets = geometry.NumFacets();
+	buffers.indices.resize(3 * num_facets);
+	buffers.vertices.reserve(geometry.NumVertices());
+
+	// The buffer vertices made from each mesh vertex, as linked lists
+	std::vector<uint32_t> first_for_vertex(geometry.NumVertices(), NO_VERTEX);
+	std::vector<uint32_t> next_for_vertex;
+	next_for_vertex.reserve(geometry.NumVertices());
+
+	set_quantization(geometry, buffers);
+
+	std::vector<uint32_t> order = MeshBVH::SpatialOrder(geometry);
+	std::vector<uint8_t> buckets;
+	group_by_normal(geometry, order, buckets);
+
+	for (size_t i = 0 ; i < num_facets ; i++)
+	{
+		if (cancel && i % CANCEL_CHECK_FACETS == 0 && cancel->load(std::memory_order_relaxed))
+			return buffers;
+
+		const size_t f = order[i];
+
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			const uint32_t v = geometry.indices[3 * f + k];
+
+			int8_t normal[2];
+			encode_normal(&geometry.normals[9 * f + 3 * k], normal);
+
+			uint32_t id = first_for_vertex[v];
+			while (id != NO_VERTEX)
+			{
+				const Vertex& candidate = buffers.vertices[id];
+				if (candidate.normal[0] == normal[0] && candidate.normal[1] == normal[1])
+					break;
+
+				id = next_for_vertex[id];
+			}
+
+			if (id == NO_VERTEX)
+			{
+				id = (uint32_t) buffers.vertices.size();
+
+				Vertex vertex;
+				for (int j = 0 ; j < 3 ; j++)
+					vertex.position[j] = quantize_position(geometry.positions[3 * v + j], buffers.position_offset[j], buffers.position_scale[j]);
+				vertex.normal[0] = normal[0];
+				vertex.normal[1] = normal[1];
+
+				buffers.vertices.push_back(vertex);
+				next_for_vertex.push_back(first_for_vertex[v]);
+				first_for_vertex[v] = id;
+			}
+
+			buffers.indices[3 * i + k] = id;
+		}
+	}
+
+	buffers.unoptimized_acmr = VertexCacheOptimizer::ACMR(buffers.indices.data(), num_facets);
+
+	// The buckets in buffer order, as the facets are now
+	std::vector<uint8_t> ordered_buckets(num_facets);
+	for (size_t i = 0 ; i < num_facets ; i++)
+		ordered_buckets[i] = buckets[order[i]];
+	std::vector<uint8_t>().swap(buckets);
+	std::vector<uint32_t>().swap(order);
+
+	if (!buffers.vertices.empty())
+		optimize_for_cache(buffers, ordered_buckets, buffers.position_offset, cancel);
+	if (cancel && cancel->load(std::memory_order_relaxed))
+		return buffers;
+
+	renumber_vertices(buffers, max_chunk_vertices);
+	buffers.acmr = VertexCacheOptimizer::ACMR(buffers.indices.data(), num_facets);
+
+	build_chunks(buffers, max_chunk_indices, max_chunk_vertices);
+	build_meshlets(buffers);
+	build_edges(geometry, buffers);
+
+	return buffers;
+}
+
+//static
+MeshBuffers MeshBuffers::BuildEdges(const MeshGeometry& geometry)
+{
+	MeshBuffers buffers;
+	set_quantization(geometry, buffers);
+	build_edges(geometry, buffers);
+
+	return buffers;
+}
+
+void MeshBuffers::Meshlets::FrontFacing(const Frustum& frustum, std::vector<uint8_t>& front) const
+{
+	const size_t n = Size();
+	front.resize(n);
+
+	// The cone faces away if it's entirely on the far side of the plane
+	// perpendicular to the view, as in meshoptimizer's meshopt_computeClusterBounds()
+	if (frustum.IsOrthographic())
+	{
+		const float* view = frustum.ViewDirection();
+		for (size_t i = 0 ; i < n ; i++)
+		{
+			const float d = view[0] * axis_x[i] + view[1] * axis_y[i] + view[2] * axis_z[i];
+			front[i] = d < cutoff[i];
+		}
+	}
+	else
+	{
+		// Widened by the sphere, as the direction to the eye changes across the meshlet
+		const float* eye = frustum.EyePosition();
+		for (size_t i = 0 ; i < n ; i++)
+		{
+			const float v[3] = { center_x[i] - eye[0], center_y[i] - eye[1], center_z[i] - eye[2] };
+			const float d = v[0] * axis_x[i] + v[1] * axis_y[i] + v[2] * axis_z[i];
+			const float dist = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+			front[i] = d < cutoff[i] * dist + radius[i];
+		}
+	}
+}
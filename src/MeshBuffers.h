@@ -0,0 +1,129 @@
+/*
+ * MeshBuffers.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MESHBUFFERS_H_
+#define MESHBUFFERS_H_
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "MeshBVH.h"
+
+struct MeshGeometry;
+class Frustum;
+
+/** The vertex and index data for drawing a mesh with buffer objects.
+ *
+ *  Each vertex is 8 bytes: the position quantized to 16 bits across the mesh's bounding box,
+ *  and the corner normal octahedral encoded in two bytes. The shader in MeshBufferDisplayObject
+ *  decodes them, and colors the vertex by its normal. Facet corners with the same vertex and
+ *  normal share one buffer vertex.
+ *
+ *  The facets go in a spatially coherent order (MeshBVH::SpatialOrder()), and are
+ *  split into chunks that each stay within the driver's limits for one
+ *  glDrawRangeElements call, and are small enough to cull. The chunks are the
+ *  leaves of a bounding volume hierarchy, so only the ones in view get drawn.
+ *  Within each chunk the facets are grouped by which way they face, and split into
+ *  meshlets with a cone around their normals, so whole meshlets facing away from
+ *  the view can be skipped before they ever reach the GL.
+ *
+ *  Within each group the facets are ordered for the post-transform vertex cache and
+ *  then for overdraw (VertexCacheOptimizer), and the vertices are numbered in the
+ *  order the facets first use them.
+ *
+ *  The edges index the mesh positions directly, quantized the same way as the vertices so
+ *  they lie exactly on the facets they border.
+ *
+ *  Building doesn't touch OpenGL, so it can run on a worker thread.
+ */
+struct MeshBuffers
+{
+	struct Vertex
+	{
+		int16_t	position[3];	///< position_offset + position_scale * position is the mesh position
+		int8_t	normal[2];		///< Octahedral, over 127
+	};
+
+	struct Chunk
+	{
+		size_t		first_index;
+		size_t		num_indices;
+		uint32_t	min_vertex;	///< The lowest vertex index used by the chunk
+		uint32_t	max_vertex;	///< The highest vertex index used by the chunk
+		MeshBVH::Box	box;	///< Bounds the chunk's facets
+		uint32_t	first_meshlet;
+		uint32_t	num_meshlets;
+	};
+
+	/** Runs of up to MAX_MESHLET_FACETS facets within a chunk, each with a bounding sphere and a
+	 *  cone that holds all its facet normals. Stored as one array per field, so FrontFacing()
+	 *  can test all of them in loops the compiler vectorizes.
+	 */
+	struct Meshlets
+	{
+		static const size_t MAX_MESHLET_FACETS = 128;
+
+		std::vector<uint32_t>	first_index;
+		std::vector<uint32_t>	num_indices;
+		std::vector<float>		axis_x, axis_y, axis_z;			///< The cone axis, the mean facet normal
+		std::vector<float>		cutoff;							///< sin of the cone's half angle, 2 if it's too wide to ever face away
+		std::vector<float>		center_x, center_y, center_z;	///< The bounding sphere
+		std::vector<float>		radius;
+
+		size_t Size() const { return first_index.size(); }
+
+		/** Sets front[i] to 0 if every facet of meshlet i faces away from the view, otherwise to 1 */
+		void FrontFacing(const Frustum& frustum, std::vector<uint8_t>& front) const;
+	};
+
+	std::vector<Vertex>		vertices;
+	std::vector<uint32_t>	indices;	///< Three per facet, in draw order
+	std::vector<Chunk>		chunks;
+	Meshlets				meshlets;	///< In index order, so each chunk's are consecutive
+	MeshBVH					bvh;		///< Over the chunks
+
+	std::vector<int16_t>	edge_positions;			///< MeshGeometry::positions, quantized like Vertex::position
+	std::vector<uint32_t>	edge_indices;			///< Vertex pairs into edge_positions: the edges, then the lamina edges
+	size_t					num_lamina_indices = 0;	///< How many of edge_indices are lamina edges (at the end)
+
+	float					position_offset[3] = { 0.0f, 0.0f, 0.0f };	///< The middle of the mesh's bounding box
+	float					position_scale[3] = { 1.0f, 1.0f, 1.0f };	///< Half its size, over 32767
+
+	double					unoptimized_acmr = 0.0;	///< VertexCacheOptimizer::ACMR() in spatial order
+	double					acmr = 0.0;				///< VertexCacheOptimizer::ACMR() as drawn
+
+	/** Where the vertex is drawn: its position, dequantized */
+	void VertexPosition(uint32_t vertex, float p[3]) const
+	{
+		for (int k = 0 ; k < 3 ; k++)
+			p[k] = position_offset[k] + position_scale[k] * vertices[vertex].position[k];
+	}
+
+	size_t SizeBytes() const
+	{
+		return vertices.size() * sizeof(Vertex) + edge_positions.size() * sizeof(int16_t) +
+			   (indices.size() + edge_indices.size()) * sizeof(uint32_t);
+	}
+
+	/** Builds the buffers for the given geometry.
+	 *  @param	geometry			The mesh
+	 *  @param	max_chunk_indices	The most indices in one chunk (GL_MAX_ELEMENTS_INDICES)
+	 *  @param	max_chunk_vertices	The widest vertex range in one chunk (GL_MAX_ELEMENTS_VERTICES).
+	 *  							A single facet wider than this still gets a chunk of its own.
+	 *  @param	cancel				If not null, Build() gives up early once this is set, and
+	 *  							the buffers it returns are incomplete
+	 */
+	static MeshBuffers Build(const MeshGeometry& geometry, size_t max_chunk_indices, size_t max_chunk_vertices,
+							 const std::atomic<bool>* cancel = nullptr);
+
+	/** Only fills in the edges, and the position offset and scale */
+	static MeshBuffers BuildEdges(const MeshGeometry& geometry);
+};
+
+#endif /* MESHBUFFERS_H_ */
@@ -0,0 +1,419 @@
+/*
+ * MeshCache.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MeshCache.h"
+#include "MeshGeometry.h"
+#include "Parallel.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+
+#include <errno.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+namespace
+{
+	const char		CACHE_MAGIC[8] = { 'S', 'T', 'L', 'V', 'C', 'A', 'C', 'H' };
+	const uint32_t	CACHE_VERSION = 5;	// 2: geometry is no longer centered, 3: crease angle, 4: edge angles, 5: content hash covers the whole tail
+	const size_t	CACHE_ALIGNMENT = 16;
+
+	const char		CACHE_EXTENSION[] = ".stlvcache";
+
+	/** The source is hashed, and the cache written, this much at a time */
+	const size_t	BLOCK_SIZE = 4 << 20;
+
+	struct cache_header
+	{
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	name_length;
+		uint64_t	content_hash;
+		uint64_t	source_size;
+		double		weld_tolerance;
+		double		crease_angle;
+		double		import_seconds;
+
+		uint64_t	num_positions;
+		uint64_t	num_indices;
+		uint64_t	num_normals;
+		uint64_t	num_edges;
+		uint64_t	num_lamina_edges;
+		uint64_t	num_edge_cos;
+
+		float		bbox_min[3];
+		float		bbox_max[3];
+
+		// MeshStats
+		uint64_t	num_facets;
+		uint64_t	num_mesh_edges;
+		uint64_t	num_vertices;
+		uint64_t	num_lamina_halfedges;
+		double		volume;
+		double		area;
+		double		extent[3];
+		uint32_t	is_closed;
+		uint32_t	reserved;
+	};
+
+	inline size_t align_up(size_t offset)
+	{
+		return (offset + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1);
+	}
+
+	inline uint64_t rotl64(uint64_t x, int r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+
+	inline uint64_t fmix64(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+
+		return h;
+	}
+
+	uint64_t hash_block(const char* data, size_t size, uint64_t seed)
+	{
+		const uint64_t k1 = 0x87c37b91114253d5ULL;
+		const uint64_t k2 = 0x4cf5ad432745937fULL;
+
+		// Four independent lanes so the multiplies can overlap
+		uint64_t h[4] = { seed, seed ^ k1, seed ^ k2, seed ^ (k1 + k2) };
+
+		size_t i = 0;
+		for ( ; i + 32 <= size ; i += 32)
+		{
+			uint64_t w[4];
+			std::memcpy(w, data + i, sizeof(w));
+
+			for (int l = 0 ; l < 4 ; l++)
+				h[l] = rotl64(h[l] ^ (rotl64(w[l] * k1, 31) * k2), 27) * 5 + 0x52dce729;
+		}
+
+		// The last, partial stripe, zero padded
+		if (i < size)
+		{
+			uint64_t w[4] = { 0, 0, 0, 0 };
+			std::memcpy(w, data + i, size - i);
+
+			for (int l = 0 ; l < 4 ; l++)
+				h[l] = rotl64(h[l] ^ (rotl64(w[l] * k1, 31) * k2), 27) * 5 + 0x52dce729;
+		}
+
+		uint64_t result = size;
+		for (int l = 0 ; l < 4 ; l++)
+			result = fmix64(result ^ h[l]);
+
+		return result;
+	}
+
+	/** @returns	false if it was canceled */
+	template <typename T>
+	bool write_array(std::ofstream& os, size_t& offset, const GeometryArray<T>& array, const std::atomic<bool>* cancel)
+	{
+		const size_t aligned = align_up(offset);
+		const char padding[CACHE_ALIGNMENT] = { 0 };
+		os.write(padding, aligned - offset);
+
+		const char* data = reinterpret_cast<const char*>(array.data());
+		const size_t size = array.size() * sizeof(T);
+		for (size_t written = 0 ; written < size ; written += BLOCK_SIZE)
+		{
+			if (IsCanceled(cancel))
+				return false;
+
+			os.write(data + written, std::min(BLOCK_SIZE, size - written));
+		}
+
+		offset = aligned + size;
+		return true;
+	}
+
+	template <typename T>
+	bool map_array(const std::shared_ptr<const MappedFile>& file, size_t& offset, uint64_t count, GeometryArray<T>& array)
+	{
+		offset = align_up(offset);
+		if (count > (file->Size() - std::min(offset, file->Size())) / sizeof(T))
+			return false;	// truncated
+
+		array = GeometryArray<T>(file, reinterpret_cast<const T*>(file->Data() + offset), count);
+		offset += count * sizeof(T);
+
+		return true;
+	}
+
+	std::string user_cache_dir()
+	{
+		const char* xdg_cache = std::getenv("XDG_CACHE_HOME");
+		const char* home = std::getenv("HOME");
+
+		std::string cache_dir;
+		if (xdg_cache && *xdg_cache)
+			cache_dir = xdg_cache;
+		else if (home)
+			cache_dir = std::string(home) + "/.cache";
+		else
+			return std::string();
+
+		return cache_dir + "/stlview";
+	}
+};
+
+MeshCache::MeshCache(const std::string& source_filename, const MappedFile& source, double weld_tolerance, double crease_angle,
+					 unsigned num_threads, const std::atomic<bool>* cancel)
+: m_source_filename(source_filename)
+, m_content_hash(HashFile(source, num_threads, cancel))
+, m_source_size(source.Size())
+, m_weld_tolerance(weld_tolerance)
+, m_crease_angle(crease_angle)
+{
+
+}
+
+//static
+uint64_t MeshCache::HashFile(const MappedFile& file, unsigned num_threads, const std::atomic<bool>* cancel)
+{
+	const size_t num_blocks = (file.Size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	std::vector<uint64_t> block_hashes(num_blocks);
+
+	ParallelFor(0, num_blocks, num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (size_t b = begin ; b < end ; b++)
+			{
+				if (IsCanceled(cancel))
+					return;
+
+				const size_t offset = b * BLOCK_SIZE;
+				block_hashes[b] = hash_block(file.Data() + offset, std::min(BLOCK_SIZE, file.Size() - offset), b);
+			}
+		});
+
+	uint64_t hash = fmix64(file.Size());
+	for (uint64_t block_hash : block_hashes)
+		hash = fmix64(rotl64(hash, 23) ^ block_hash);
+
+	return hash;
+}
+
+//static
+std::string MeshCache::SidecarPath(const std::string& source_filename)
+{
+	return source_filename + CACHE_EXTENSION;
+}
+
+std::string MeshCache::sidecar_path() const
+{
+	return SidecarPath(m_source_filename);
+}
+
+std::string MeshCache::user_cache_path() const
+{
+	const std::string cache_dir = user_cache_dir();
+	if (cache_dir.empty())
+		return std::string();
+
+	std::ostringstream ss;
+	ss << cache_dir << "/" << std::hex << std::setw(16) << std::setfill('0') << m_content_hash << CACHE_EXTENSION;
+
+	return ss.str();
+}
+
+std::shared_ptr<MeshGeometry> MeshCache::Load(double& import_seconds) const
+{
+	for (const std::string& path : { sidecar_path(), user_cache_path() })
+	{
+		if (path.empty() || ::access(path.c_str(), R_OK) == -1)
+			continue;
+
+		try
+		{
+			std::shared_ptr<MeshGeometry> geometry = load(path, import_seconds);
+			if (geometry)
+				return geometry;
+		}
+		catch (std::exception&)
+		{
+			// unreadable cache, just ignore it
+		}
+	}
+
+	return std::shared_ptr<MeshGeometry>();
+}
+
+std::shared_ptr<MeshGeometry> MeshCache::load(const std::string& cache_filename, double& import_seconds) const
+{
+	auto file = std::make_shared<const MappedFile>(cache_filename);
+	if (file->Size() < sizeof(cache_header))
+		return std::shared_ptr<MeshGeometry>();
+
+	cache_header header;
+	std::memcpy(&header, file->Data(), sizeof(header));
+
+	if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+		header.version != CACHE_VERSION ||
+		header.content_hash != m_content_hash ||
+		header.source_size != m_source_size ||
+		header.weld_tolerance != m_weld_tolerance ||
+		header.crease_angle != m_crease_angle)
+	{
+		return std::shared_ptr<MeshGeometry>();
+	}
+
+	size_t offset = sizeof(header);
+	if (header.name_length > file->Size() - offset)
+		return std::shared_ptr<MeshGeometry>();
+
+	auto geometry = std::make_shared<MeshGeometry>();
+	geometry->stats.name.assign(file->Data() + offset, header.name_length);
+	offset += header.name_length;
+
+	if (!map_array(file, offset, header.num_positions, geometry->positions) ||
+		!map_array(file, offset, header.num_indices, geometry->indices) ||
+		!map_array(file, offset, header.num_normals, geometry->normals) ||
+		!map_array(file, offset, header.num_edges, geometry->edges) ||
+		!map_array(file, offset, header.num_lamina_edges, geometry->lamina_edges) ||
+		!map_array(file, offset, header.num_edge_cos, geometry->edge_cos))
+	{
+		return std::shared_ptr<MeshGeometry>();
+	}
+
+	std::copy(header.bbox_min, header.bbox_min + 3, geometry->bbox_min);
+	std::copy(header.bbox_max, header.bbox_max + 3, geometry->bbox_max);
+	geometry->crease_angle = header.crease_angle;
+
+	MeshStats& stats = geometry->stats;
+	stats.num_facets = header.num_facets;
+	stats.num_edges = header.num_mesh_edges;
+	stats.num_vertices = header.num_vertices;
+	stats.num_lamina_edges = header.num_lamina_halfedges;
+	stats.volume = header.volume;
+	stats.area = header.area;
+	stats.is_closed = header.is_closed != 0;
+	std::copy(header.extent, header.extent + 3, stats.extent);
+
+	import_seconds = header.import_seconds;
+
+	return geometry;
+}
+
+void MeshCache::Save(const MeshGeometry& geometry, double import_seconds, const std::atomic<bool>* cancel) const
+{
+	std::string errors;
+
+	for (const std::string& path : { sidecar_path(), user_cache_path() })
+	{
+		if (path.empty())
+			continue;
+
+		try
+		{
+			save(path, geometry, import_seconds, cancel);
+			return;
+		}
+		catch (std::exception& ex)
+		{
+			errors += ex.what();
+			errors += "\n";
+		}
+	}
+
+	throw std::runtime_error("Couldn't write the mesh cache:\n" + errors);
+}
+
+void MeshCache::save(const std::string& cache_filename, const MeshGeometry& geometry, double import_seconds,
+					 const std::atomic<bool>* cancel) const
+{
+	// Make sure the user cache directory exists
+	if (cache_filename != sidecar_path())
+	{
+		const std::string cache_dir = user_cache_dir();
+		const size_t parent_end = cache_dir.find_last_of('/');
+		if (parent_end != std::string::npos)
+			::mkdir(cache_dir.substr(0, parent_end).c_str(), 0755);
+		::mkdir(cache_dir.c_str(), 0755);
+	}
+
+	std::ostringstream tmp_ss;
+	tmp_ss << cache_filename << ".tmp." << ::getpid();
+	const std::string tmp_filename = tmp_ss.str();
+
+	std::ofstream os(tmp_filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (os.fail())
+		throw std::runtime_error("Error opening " + tmp_filename + ": " + ::strerror(errno));
+
+	const MeshStats& stats = geometry.stats;
+
+	cache_header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.name_length = (uint32_t) stats.name.size();
+	header.content_hash = m_content_hash;
+	header.source_size = m_source_size;
+	header.weld_tolerance = m_weld_tolerance;
+	header.crease_angle = m_crease_angle;
+	header.import_seconds = import_seconds;
+	header.num_positions = geometry.positions.size();
+	header.num_indices = geometry.indices.size();
+	header.num_normals = geometry.normals.size();
+	header.num_edges = geometry.edges.size();
+	header.num_lamina_edges = geometry.lamina_edges.size();
+	header.num_edge_cos = geometry.edge_cos.size();
+	std::copy(geometry.bbox_min, geometry.bbox_min + 3, header.bbox_min);
+	std::copy(geometry.bbox_max, geometry.bbox_max + 3, header.bbox_max);
+	header.num_facets = stats.num_facets;
+	header.num_mesh_edges = stats.num_edges;
+	header.num_vertices = stats.num_vertices;
+	header.num_lamina_halfedges = stats.num_lamina_edges;
+	header.volume = stats.volume;
+	header.area = stats.area;
+	std::copy(stats.extent, stats.extent + 3, header.extent);
+	header.is_closed = stats.is_closed ? 1 : 0;
+
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	os.write(stats.name.data(), stats.name.size());
+
+	size_t offset = sizeof(header) + stats.name.size();
+	if (!write_array(os, offset, geometry.positions, cancel) ||
+		!write_array(os, offset, geometry.indices, cancel) ||
+		!write_array(os, offset, geometry.normals, cancel) ||
+		!write_array(os, offset, geometry.edges, cancel) ||
+		!write_array(os, offset, geometry.lamina_edges, cancel) ||
+		!write_array(os, offset, geometry.edge_cos, cancel))
+	{
+		os.close();
+		::unlink(tmp_filename.c_str());
+		return;
+	}
+
+	os.close();
+	if (os.fail())
+	{
+		::unlink(tmp_filename.c_str());
+		throw std::runtime_error("Error writing " + tmp_filename);
+	}
+
+	if (::rename(tmp_filename.c_str(), cache_filename.c_str()) == -1)
+	{
+		const int err = errno;
+		::unlink(tmp_filename.c_str());
+		throw std::runtime_error("Error renaming " + tmp_filename + ": " + ::strerror(err));
+	}
+}
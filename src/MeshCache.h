@@ -0,0 +1,85 @@
+/*
+ * MeshCache.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MESHCACHE_H_
+#define MESHCACHE_H_
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "MappedFile.h"
+
+struct MeshGeometry;
+
+/** A binary cache of the MeshGeometry built from an STL file.
+ *
+ *  The cache is keyed by a hash of the STL file contents (and the weld tolerance),
+ *  so renaming or touching the file doesn't invalidate it but editing it does.
+ *  It lives next to the STL file as "<file>.stlvcache", or under
+ *  $XDG_CACHE_HOME/stlview if that directory can't be written to.
+ *
+ *  The arrays are stored aligned and in native byte order, so a valid cache is
+ *  used straight out of a memory mapping.
+ */
+class MeshCache
+{
+private:
+	std::string		m_source_filename;
+	uint64_t		m_content_hash;
+	uint64_t		m_source_size;
+	double			m_weld_tolerance;
+	double			m_crease_angle;
+
+	std::string sidecar_path() const;
+	std::string user_cache_path() const;
+
+	std::shared_ptr<MeshGeometry> load(const std::string& cache_filename, double& import_seconds) const;
+	void save(const std::string& cache_filename, const MeshGeometry& geometry, double import_seconds,
+			  const std::atomic<bool>* cancel) const;
+
+public:
+	/** Constructor.
+	 *  Hashes the contents of the source file.
+	 *  @param	source_filename	The STL file name
+	 *  @param	source			The STL file, mapped
+	 *  @param	weld_tolerance	The weld tolerance the geometry is (or will be) built with
+	 *  @param	crease_angle	The crease angle the normals are (or will be) built with
+	 *  @param	num_threads		The number of threads to hash with, 0 for the default
+	 *  @param	cancel			If not null, hashing stops soon after this is set, and the cache is no use
+	 */
+	MeshCache(const std::string& source_filename, const MappedFile& source, double weld_tolerance, double crease_angle,
+			  unsigned num_threads = 0, const std::atomic<bool>* cancel = nullptr);
+
+	uint64_t ContentHash() const { return m_content_hash; }
+
+	/** Loads the cached geometry, if there is a valid cache for the file.
+	 *  @param	import_seconds	Set to how long the import took when the cache was written
+	 *  @returns				The geometry, or null if there is no valid cache
+	 */
+	std::shared_ptr<MeshGeometry> Load(double& import_seconds) const;
+
+	/** Writes the cache for the file.
+	 *  The file is written under a temporary name and renamed into place, so
+	 *  readers never see a partial cache.
+	 *  @param	import_seconds	How long the full import took, for reporting the speedup later
+	 *  @param	cancel			If not null, Save() gives up soon after this is set and writes nothing
+	 *  @throws std::runtime_error if neither cache location can be written
+	 */
+	void Save(const MeshGeometry& geometry, double import_seconds, const std::atomic<bool>* cancel = nullptr) const;
+
+	/** Where the cache for source_filename goes if its directory can be written to */
+	static std::string SidecarPath(const std::string& source_filename);
+
+	/** Hashes a whole file, in blocks, on num_threads threads (0 for the default).
+	 *  If cancel is given, stops soon after it's set and returns a meaningless hash.
+	 */
+	static uint64_t HashFile(const MappedFile& file, unsigned num_threads = 0, const std::atomic<bool>* cancel = nullptr);
+};
+
+#endif /* MESHCACHE_H_ */
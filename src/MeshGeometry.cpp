@@ -0,0 +1,211 @@
+/*
+ * MeshGeometry.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MeshGeometry.h"
+#include "IndexedMesh.h"
+#include "HalfEdgeMesh.h"
+#include "Parallel.h"
+#include "SplitNormals.h"
+
+#include <vectors.h>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace
+{
+	/** An edge with the cosine of the angle its facets meet at */
+	struct ranked_edge
+	{
+		float		cos;
+		uint32_t	a;
+		uint32_t	b;
+
+		bool operator<(const ranked_edge& rhs) const
+		{
+			if (cos != rhs.cos)
+				return cos < rhs.cos;
+
+			return a != rhs.a ? a < rhs.a : b < rhs.b;
+		}
+	};
+
+	/** How many edges dihedral_cosines() gathers at a time */
+	const size_t DOT_BLOCK_SIZE = 256;
+
+	/** cos[i] = facet_normals[facets_a[i]] . facet_normals[facets_b[i]]
+	 *  The normals are gathered a block at a time into separate x, y and z arrays,
+	 *  so the dot products themselves are a straight loop the compiler vectorizes.
+	 */
+	void dihedral_cosines(const std::vector<float>& facet_normals, const std::vector<uint32_t>& facets_a,
+						  const std::vector<uint32_t>& facets_b, std::vector<float>& cos, unsigned num_threads)
+	{
+		cos.resize(facets_a.size());
+
+		ParallelFor(0, facets_a.size(), num_threads,
+			[&](size_t begin, size_t end, size_t)
+			{
+				float ax[DOT_BLOCK_SIZE], ay[DOT_BLOCK_SIZE], az[DOT_BLOCK_SIZE];
+				float bx[DOT_BLOCK_SIZE], by[DOT_BLOCK_SIZE], bz[DOT_BLOCK_SIZE];
+
+				for (size_t block = begin ; block < end ; block += DOT_BLOCK_SIZE)
+				{
+					const size_t n = std::min(DOT_BLOCK_SIZE, end - block);
+
+					for (size_t i = 0 ; i < n ; i++)
+					{
+						const float* na = &facet_normals[3 * facets_a[block + i]];
+						const float* nb = &facet_normals[3 * facets_b[block + i]];
+						ax[i] = na[0]; ay[i] = na[1]; az[i] = na[2];
+						bx[i] = nb[0]; by[i] = nb[1]; bz[i] = nb[2];
+					}
+
+					float* out = &cos[block];
+					for (size_t i = 0 ; i < n ; i++)
+						out[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+				}
+			});
+	}
+
+	/** Lists the edges, sharpest first, and the ones that only have one facet */
+	void compute_edges(const HalfEdgeMesh& mesh, const std::vector<float>& facet_normals, unsigned num_threads,
+					   const std::atomic<bool>* cancel,
+					   std::vector<uint32_t>& edges, std::vector<uint32_t>& lamina_edges, std::vector<float>& edge_cos)
+	{
+		std::vector<ranked_edge> ranked;
+		std::vector<uint32_t> facets_a, facets_b;	// the facets of the manifold edges
+		std::vector<size_t> manifold_edges;			// where they are in ranked
+
+		ranked.reserve(mesh.num_edges);
+		lamina_edges.reserve(2 * mesh.num_lamina_edges);
+
+		for (uint32_t h = 0 ; h < mesh.NumHalfEdges() ; h++)
+		{
+			if (h % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+				return;
+
+			if (!mesh.IsEdgeRepresentative(h))
+				continue;
+
+			const uint32_t a = std::min(mesh.From(h), mesh.To(h));
+			const uint32_t b = std::max(mesh.From(h), mesh.To(h));
+
+			ranked.push_back({ MeshGeometry::FEATURE_EDGE_COS, a, b });
+
+			if (mesh.IsBoundary(h))
+			{
+				lamina_edges.push_back(a);
+				lamina_edges.push_back(b);
+			}
+			else if (mesh.IsManifold(h))
+			{
+				// The edge's other half-edge comes after h around it
+				auto radial = mesh.RadialHalfEdges(h).begin();
+				facets_a.push_back(HalfEdgeMesh::Facet(h));
+				facets_b.push_back(HalfEdgeMesh::Facet(*++radial));
+				manifold_edges.push_back(ranked.size() - 1);
+			}
+		}
+
+		std::vector<float> cos;
+		dihedral_cosines(facet_normals, facets_a, facets_b, cos, num_threads);
+
+		for (size_t i = 0 ; i < manifold_edges.size() ; i++)
+			ranked[manifold_edges[i]].cos = cos[i];
+
+		ParallelSort(ranked, std::less<ranked_edge>(), num_threads, cancel);
+		if (IsCanceled(cancel))
+			return;
+
+		edges.resize(2 * ranked.size());
+		edge_cos.resize(ranked.size());
+		for (size_t i = 0 ; i < ranked.size() ; i++)
+		{
+			edges[2 * i] = ranked[i].a;
+			edges[2 * i + 1] = ranked[i].b;
+			edge_cos[i] = ranked[i].cos;
+		}
+	}
+};
+
+maths::bbox3d MeshGeometry::BBox() const
+{
+	if (positions.empty())
+		return maths::bbox3d();
+
+	return maths::bbox3d(	maths::vector3d(bbox_min[0], bbox_min[1], bbox_min[2]),
+							maths::vector3d(bbox_max[0], bbox_max[1], bbox_max[2]));
+}
+
+void MeshGeometry::FacetNormal(size_t f, float n[3]) const
+{
+	SplitNormals::FacetNormal(CornerPosition(f, 0), CornerPosition(f, 1), CornerPosition(f, 2), n);
+}
+
+size_t MeshGeometry::NumFeatureEdges(double feature_angle) const
+{
+	if (feature_angle <= 0.0 || edge_cos.empty())
+		return NumEdges();
+
+	// Facets meeting at more than the feature angle have normals further apart than it
+	const float feature_cos = (float) std::cos(std::min(feature_angle, 180.0) * M_PI / 180.0);
+
+	return std::lower_bound(edge_cos.begin(), edge_cos.end(), feature_cos) - edge_cos.begin();
+}
+
+//static
+std::shared_ptr<MeshGeometry> MeshGeometry::Build(IndexedMesh&& mesh, const MeshStats& stats, double crease_angle, unsigned num_threads,
+												  const std::atomic<bool>* cancel)
+{
+	HalfEdgeMesh he = HalfEdgeMesh::Build(std::move(mesh), num_threads, cancel);
+	if (IsCanceled(cancel))
+		return std::shared_ptr<MeshGeometry>();
+
+	return Build(std::move(he), stats, crease_angle, num_threads, cancel);
+}
+
+//static
+std::shared_ptr<MeshGeometry> MeshGeometry::Build(HalfEdgeMesh&& mesh, const MeshStats& stats, double crease_angle, unsigned num_threads,
+												  const std::atomic<bool>* cancel)
+{
+	auto geometry = std::make_shared<MeshGeometry>();
+
+	std::vector<float> facet_normals;
+	std::vector<float> normals = SplitNormals(crease_angle, num_threads).Compute(mesh, &facet_normals, cancel);
+	if (IsCanceled(cancel))
+		return std::shared_ptr<MeshGeometry>();
+
+	std::vector<uint32_t> edges, lamina_edges;
+	std::vector<float> edge_cos;
+	compute_edges(mesh, facet_normals, num_threads, cancel, edges, lamina_edges, edge_cos);
+	std::vector<float>().swap(facet_normals);
+	if (IsCanceled(cancel))
+		return std::shared_ptr<MeshGeometry>();
+
+	std::fill(geometry->bbox_min, geometry->bbox_min + 3, std::numeric_limits<float>::max());
+	std::fill(geometry->bbox_max, geometry->bbox_max + 3, -std::numeric_limits<float>::max());
+	for (size_t i = 0 ; i < mesh.positions.size() ; i += 3)
+	{
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			geometry->bbox_min[k] = std::min(geometry->bbox_min[k], mesh.positions[i + k]);
+			geometry->bbox_max[k] = std::max(geometry->bbox_max[k], mesh.positions[i + k]);
+		}
+	}
+
+	geometry->positions = GeometryArray<float>(std::move(mesh.positions));
+	geometry->indices = GeometryArray<uint32_t>(std::move(mesh.indices));
+	geometry->normals = GeometryArray<float>(std::move(normals));
+	geometry->edges = GeometryArray<uint32_t>(std::move(edges));
+	geometry->lamina_edges = GeometryArray<uint32_t>(std::move(lamina_edges));
+	geometry->edge_cos = GeometryArray<float>(std::move(edge_cos));
+	geometry->crease_angle = crease_angle;
+	geometry->stats = stats;
+
+	return geometry;
+}
@@ -0,0 +1,133 @@
+/*
+ * MeshGeometry.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MESHGEOMETRY_H_
+#define MESHGEOMETRY_H_
+
+#include <geom.h>
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+#include "MappedFile.h"
+#include "MeshStats.h"
+
+struct IndexedMesh;
+struct HalfEdgeMesh;
+
+/** A read-only array that either owns its elements or points into a mapped file.
+ *  Lets geometry loaded from a cache file be used without copying it.
+ */
+template <typename T>
+class GeometryArray
+{
+private:
+	std::vector<T>						m_storage;
+	std::shared_ptr<const MappedFile>	m_mapping;
+	const T*							m_data;
+	size_t								m_size;
+
+public:
+	GeometryArray() : m_data(nullptr), m_size(0) { }
+
+	explicit GeometryArray(std::vector<T>&& storage)
+	: m_storage(std::move(storage))
+	, m_data(m_storage.data())
+	, m_size(m_storage.size())
+	{
+
+	}
+
+	/** Refers to size elements at data, which must point into mapping */
+	GeometryArray(const std::shared_ptr<const MappedFile>& mapping, const T* data, size_t size)
+	: m_mapping(mapping)
+	, m_data(data)
+	, m_size(size)
+	{
+
+	}
+
+	// Moving a vector keeps its buffer, so m_data stays valid
+	GeometryArray(GeometryArray&&) = default;
+	GeometryArray& operator=(GeometryArray&&) = default;
+
+	GeometryArray(const GeometryArray&) = delete;
+	GeometryArray& operator=(const GeometryArray&) = delete;
+
+	const T*	data() const { return m_data; }
+	size_t		size() const { return m_size; }
+	bool		empty() const { return m_size == 0; }
+
+	const T&	operator[](size_t i) const { return m_data[i]; }
+	const T*	begin() const { return m_data; }
+	const T*	end() const { return m_data + m_size; }
+};
+
+/** Everything needed to display a mesh and describe it, as flat arrays.
+ *  Built once when a file is loaded (or read back from the mesh cache)
+ *  and shared, read-only, by the display objects.
+ */
+struct MeshGeometry
+{
+	GeometryArray<float>	positions;		///< x, y, z per vertex
+	GeometryArray<uint32_t>	indices;		///< Three vertex indices per facet
+	GeometryArray<float>	normals;		///< x, y, z per facet corner (nine per facet), split at creases
+	GeometryArray<uint32_t>	edges;			///< Vertex index pairs, one per mesh edge, sharpest first (see edge_cos)
+	GeometryArray<uint32_t>	lamina_edges;	///< Vertex index pairs, one per edge with only one facet
+	GeometryArray<float>	edge_cos;		///< Per edge, the cosine of the angle between its facets, ascending.
+											///< FEATURE_EDGE_COS for edges without exactly two facets.
+
+	float					bbox_min[3] = { 0.0f, 0.0f, 0.0f };
+	float					bbox_max[3] = { 0.0f, 0.0f, 0.0f };
+
+	double					crease_angle = 0.0;	///< The angle the normals were split at, in degrees
+
+	MeshStats				stats;
+
+	/** The edge_cos of boundary and non-manifold edges, which are always feature edges */
+	static constexpr float	FEATURE_EDGE_COS = -2.0f;
+
+	size_t NumVertices() const		{ return positions.size() / 3; }
+	size_t NumFacets() const		{ return indices.size() / 3; }
+	size_t NumEdges() const			{ return edges.size() / 2; }
+	size_t NumLaminaEdges() const	{ return lamina_edges.size() / 2; }
+
+	maths::bbox3d BBox() const;
+
+	/** Position of corner k (0, 1 or 2) of facet f */
+	const float* CornerPosition(size_t f, int k) const { return &positions[3 * indices[3 * f + k]]; }
+
+	/** The unit normal of facet f, from its vertices */
+	void FacetNormal(size_t f, float n[3]) const;
+
+	/** The number of feature edges for the given angle: boundary and non-manifold edges, and
+	 *  edges whose facets meet at more than feature_angle degrees. Those are the first edges
+	 *  in edges, so this is cheap enough to call whenever the angle changes.
+	 *  @param feature_angle	In degrees; 0 or less for all the edges
+	 */
+	size_t NumFeatureEdges(double feature_angle) const;
+
+	/** Builds the normals, edge lists and bounding box for a mesh, the edges from its half-edges.
+	 *  @param	mesh			The mesh. Its positions and indices are moved into the geometry.
+	 *  @param	stats			The mesh statistics to keep with the geometry
+	 *  @param	crease_angle	Facets meeting at more than this angle (in degrees) don't share normals
+	 *  @param	num_threads		The number of threads to use, 0 for the default
+	 *  @param	cancel			If not null, Build() gives up soon after this is set and returns null
+	 */
+	static std::shared_ptr<MeshGeometry> Build(HalfEdgeMesh&& mesh, const MeshStats& stats, double crease_angle, unsigned num_threads = 0,
+											   const std::atomic<bool>* cancel = nullptr);
+
+	/** As above, for a welded mesh that has no half-edges yet */
+	static std::shared_ptr<MeshGeometry> Build(IndexedMesh&& mesh, const MeshStats& stats, double crease_angle, unsigned num_threads = 0,
+											   const std::atomic<bool>* cancel = nullptr);
+};
+
+#endif /* MESHGEOMETRY_H_ */
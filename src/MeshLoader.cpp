@@ -0,0 +1,332 @@
+/*
+ * MeshLoader.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MeshLoader.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "MeshGeometry.h"
+#include "IndexedMesh.h"
+#include "HalfEdgeMesh.h"
+#include "VertexWelder.h"
+#include "BinarySTLReader.h"
+#include "ASCIISTLReader.h"
+#include "StreamDecompressor.h"
+#include "StreamingSTLReader.h"
+
+#include "stl_importer.h"
+#include "triangle_mesh.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+#include <cstring>
+
+#include <errno.h>
+
+namespace
+{
+	/** Output iterator that keeps the triangles' corners for welding.
+	 *  Takes STLTriangles from our readers, and triangle3ds from stl_importer,
+	 *  which go into a triangle_mesh (made on the first one) to be read back out.
+	 *
+	 *  With a preview, the corners are also copied there a TriangleBatch at a time.
+	 *  Holds pointers rather than references, so it can be assigned like any iterator.
+	 */
+	class corner_inserter : public std::iterator<std::output_iterator_tag, void, void, void, void>
+	{
+	private:
+		std::vector<float>*			m_corners;
+		std::unique_ptr<triangle_mesh>*	m_importer_mesh;
+		const std::atomic<bool>*	m_cancel;
+		std::atomic<size_t>*		m_num_facets;
+		std::vector<float>*			m_preview;
+		std::mutex*					m_preview_mutex;
+
+		void added()
+		{
+			if (m_cancel->load(std::memory_order_relaxed))
+				throw MeshLoader::cancel_exception();
+
+			m_num_facets->fetch_add(1, std::memory_order_relaxed);
+		}
+
+	public:
+		corner_inserter(std::vector<float>& corners, std::unique_ptr<triangle_mesh>& importer_mesh, const std::atomic<bool>& cancel,
+						std::atomic<size_t>& num_facets, std::vector<float>* preview, std::mutex& preview_mutex)
+		: m_corners(&corners)
+		, m_importer_mesh(&importer_mesh)
+		, m_cancel(&cancel)
+		, m_num_facets(&num_facets)
+		, m_preview(preview)
+		, m_preview_mutex(&preview_mutex)
+		{
+
+		}
+
+		/* std::iterator boilerplate */
+		corner_inserter& operator*() { return *this; }
+		corner_inserter& operator++() { return *this; }
+		corner_inserter& operator++(int) { return *this; }
+
+		corner_inserter& operator=(const STLTriangle& t)
+		{
+			m_corners->insert(m_corners->end(), t.v, t.v + 9);
+
+			const size_t batch_size = 9 * TriangleBatch::CAPACITY;
+			if (m_preview && m_corners->size() % batch_size == 0)
+			{
+				std::lock_guard<std::mutex> lock(*m_preview_mutex);
+				m_preview->insert(m_preview->end(), m_corners->end() - batch_size, m_corners->end());
+			}
+
+			added();
+			return *this;
+		}
+
+		corner_inserter& operator=(const maths::triangle3d& t)
+		{
+			if (!*m_importer_mesh)
+				m_importer_mesh->reset(new triangle_mesh);
+
+			(*m_importer_mesh)->add_triangle(t);
+
+			added();
+			return *this;
+		}
+	};
+};
+
+MeshLoader::MeshLoader(const std::string& filename, unsigned num_threads, double weld_tolerance, double crease_angle)
+: m_filename(filename)
+, m_num_threads(num_threads)
+, m_weld_tolerance(weld_tolerance)
+, m_crease_angle(crease_angle)
+, m_state(STATE_PENDING)
+, m_cancel(false)
+, m_facets_read(0)
+, m_facets_expected(0)
+, m_decompressor(nullptr)
+, m_keep_preview(false)
+, m_write_cache(true)
+, m_seconds(0.0)
+, m_from_cache(false)
+, m_cached_import_seconds(0.0)
+{
+
+}
+
+double MeshLoader::Progress() const
+{
+	const State state = GetState();
+	if (state == STATE_PENDING)
+		return 0.0;
+
+	if (state != STATE_LOADING)
+		return 1.0;
+
+	const StreamDecompressor* decompressor = m_decompressor.load(std::memory_order_acquire);
+	if (decompressor)
+		return (double) decompressor->CompressedBytesConsumed() / (double) decompressor->CompressedSize();
+
+	const size_t expected = m_facets_expected.load(std::memory_order_relaxed);
+	if (expected == 0)
+		return 0.0;
+
+	// The ASCII facet count is only an estimate
+	return std::min(1.0, (double) FacetsRead() / (double) expected);
+}
+
+std::string MeshLoader::import_file(const std::shared_ptr<MappedFile>& mapped_file, std::vector<float>& corners, std::unique_ptr<triangle_mesh>& importer_mesh)
+{
+	corner_inserter out(corners, importer_mesh, m_cancel, m_facets_read, m_keep_preview ? &m_preview : nullptr, m_preview_mutex);
+
+	const StreamDecompressor::Format compression = StreamDecompressor::DetectFormat(*mapped_file);
+	if (compression != StreamDecompressor::FORMAT_NONE)
+	{
+		StreamDecompressor decompressor(mapped_file, compression);
+		StreamingSTLReader reader(decompressor);
+
+		m_decompressor.store(&decompressor, std::memory_order_release);
+		decompressor.Start();
+
+		try
+		{
+			reader.Import(out);
+		}
+		catch (...)
+		{
+			m_decompressor.store(nullptr);
+			throw;
+		}
+
+		m_decompressor.store(nullptr);
+
+		return reader.Name();
+	}
+
+	if (BinarySTLReader::IsBinarySTL(*mapped_file))
+	{
+		mapped_file->AdviseSequential();
+
+		BinarySTLReader reader(mapped_file);
+		m_facets_expected.store(reader.NumFacets());
+
+		corners.reserve(9 * reader.NumFacets());
+
+		reader.ImportParallel(out, m_num_threads);
+
+		return reader.Name();
+	}
+
+	if (ASCIISTLReader::IsASCIISTL(*mapped_file))
+	{
+		mapped_file->AdviseSequential();
+
+		ASCIISTLReader reader(mapped_file);
+		m_facets_expected.store(reader.EstimatedNumFacets());
+
+		reader.ImportParallel(out, m_num_threads);
+
+		return reader.Name();
+	}
+
+	auto in_stream = std::make_shared<std::ifstream>();
+	in_stream->open(m_filename.c_str(), std::fstream::binary);
+
+	if (in_stream->fail())
+		throw std::runtime_error(std::string("Error opening file: ") + ::strerror(errno));
+
+	stl_util::stl_importer importer(in_stream);
+	m_facets_expected.store(importer.num_facets_expected());
+
+	importer.import(out);
+
+	return importer.name();
+}
+
+void MeshLoader::load(bool build_geometry)
+{
+	auto const start = std::chrono::steady_clock::now();
+
+	m_state.store(STATE_LOADING, std::memory_order_release);
+
+	State final_state = STATE_DONE;
+	try
+	{
+		check_cancel();
+
+		auto mapped_file = std::make_shared<MappedFile>(m_filename);
+
+		std::unique_ptr<MeshCache> cache;
+		if (mapped_file->Size() > 0)
+		{
+			cache.reset(new MeshCache(m_filename, *mapped_file, m_weld_tolerance, m_crease_angle, m_num_threads, &m_cancel));
+			check_cancel();
+
+			m_geometry = cache->Load(m_cached_import_seconds);
+			m_from_cache = !!m_geometry;
+		}
+
+		if (m_geometry)
+		{
+			m_stats = m_geometry->stats;
+
+			if (!build_geometry)
+				m_geometry.reset();
+		}
+		else
+		{
+			std::vector<float> corners;
+			std::unique_ptr<triangle_mesh> importer_mesh;
+
+			const std::string name = import_file(mapped_file, corners, importer_mesh);
+			check_cancel();
+
+			if (m_keep_preview)
+			{
+				// The last partial batch
+				const size_t num_left = corners.size() % (9 * TriangleBatch::CAPACITY);
+
+				std::lock_guard<std::mutex> lock(m_preview_mutex);
+				m_preview.insert(m_preview.end(), corners.end() - num_left, corners.end());
+			}
+
+			// stl_importer doesn't hand us the corners, read them back out of its mesh
+			IndexedMesh indexed_mesh = importer_mesh ?
+				IndexedMesh::FromTriangleMesh(*importer_mesh) : VertexWelder(m_weld_tolerance, m_num_threads).Weld(corners, &m_cancel);
+			std::vector<float>().swap(corners);
+			importer_mesh.reset();
+			check_cancel();
+
+			HalfEdgeMesh mesh = HalfEdgeMesh::Build(std::move(indexed_mesh), m_num_threads, &m_cancel);
+			check_cancel();
+
+			m_stats = MeshStats::FromHalfEdgeMesh(mesh, name);
+
+			if (build_geometry)
+			{
+				check_cancel();
+
+				m_geometry = MeshGeometry::Build(std::move(mesh), m_stats, m_crease_angle, m_num_threads, &m_cancel);
+				check_cancel();
+
+				if (cache && m_write_cache)
+				{
+					std::chrono::duration<double> const import_time = std::chrono::steady_clock::now() - start;
+
+					try
+					{
+						cache->Save(*m_geometry, import_time.count(), &m_cancel);
+					}
+					catch (std::exception& ex)
+					{
+						std::clog << ex.what() << std::endl;
+					}
+
+					check_cancel();
+				}
+			}
+		}
+	}
+	catch (cancel_exception&)
+	{
+		m_geometry.reset();
+		final_state = STATE_CANCELED;
+	}
+	catch (std::exception& ex)
+	{
+		m_geometry.reset();
+		m_error = ex.what();
+		final_state = STATE_FAILED;
+	}
+
+	std::chrono::duration<double> const time = std::chrono::steady_clock::now() - start;
+	m_seconds = time.count();
+
+	m_state.store(final_state, std::memory_order_release);
+}
+
+void MeshLoader::TakePreview(std::vector<float>& corners)
+{
+	corners.clear();
+
+	std::lock_guard<std::mutex> lock(m_preview_mutex);
+	corners.swap(m_preview);
+}
+
+void MeshLoader::Load()
+{
+	load(true);
+}
+
+void MeshLoader::LoadStats()
+{
+	load(false);
+}
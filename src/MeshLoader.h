@@ -0,0 +1,150 @@
+/*
+ * MeshLoader.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MESHLOADER_H_
+#define MESHLOADER_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <exception>
+
+#include "MeshStats.h"
+
+class MappedFile;
+class StreamDecompressor;
+class triangle_mesh;
+struct MeshGeometry;
+
+/** Loads one STL file into a MeshGeometry (or just its MeshStats) on the calling thread,
+ *  without any GUI. Progress() and Cancel() can be called from any other thread,
+ *  so a bunch of these can run on a WorkerPool while the GUI watches them.
+ */
+class MeshLoader
+{
+public:
+	enum State
+	{
+		STATE_PENDING,
+		STATE_LOADING,
+		STATE_DONE,
+		STATE_FAILED,
+		STATE_CANCELED
+	};
+
+	/** Thrown out of the import when the loader is canceled */
+	class cancel_exception : public std::exception
+	{
+	public:
+		virtual const char* what() const noexcept { return "canceled"; }
+	};
+
+private:
+	std::string							m_filename;
+	unsigned							m_num_threads;
+	double								m_weld_tolerance;
+	double								m_crease_angle;
+
+	std::atomic<int>					m_state;
+	std::atomic<bool>					m_cancel;
+	std::atomic<size_t>					m_facets_read;
+	std::atomic<size_t>					m_facets_expected;	///< 0 if we don't know
+	std::atomic<const StreamDecompressor*>	m_decompressor;	///< Set while reading a compressed file
+
+	bool								m_keep_preview;
+	bool								m_write_cache;
+	std::mutex							m_preview_mutex;
+	std::vector<float>					m_preview;			///< Corners read since the last TakePreview()
+
+	std::shared_ptr<MeshGeometry>		m_geometry;
+	MeshStats							m_stats;
+	std::string							m_error;
+	double								m_seconds;
+	bool								m_from_cache;
+	double								m_cached_import_seconds;	///< How long the import took when the cache was written
+
+	/** Reads the triangle corners in the file into corners, or for files only stl_importer
+	 *  reads, the triangles into a new importer_mesh (left null otherwise).
+	 *  @returns	The mesh name from the file
+	 */
+	std::string import_file(const std::shared_ptr<MappedFile>& mapped_file, std::vector<float>& corners, std::unique_ptr<triangle_mesh>& importer_mesh);
+
+	/** Throws cancel_exception once Cancel() has been called */
+	void check_cancel() const
+	{
+		if (m_cancel.load())
+			throw cancel_exception();
+	}
+
+	void load(bool build_geometry);
+
+public:
+	/** Constructor.
+	 *  @param	filename		The STL file
+	 *  @param	num_threads		The number of threads to parse and build with, 0 for the default
+	 *  @param	weld_tolerance	Weld tolerance for the vertices (and the mesh cache key)
+	 *  @param	crease_angle	Crease angle for the normals, in degrees (and the mesh cache key)
+	 */
+	MeshLoader(const std::string& filename, unsigned num_threads, double weld_tolerance, double crease_angle);
+
+	MeshLoader(const MeshLoader&) = delete;
+	MeshLoader& operator=(const MeshLoader&) = delete;
+
+	/** Loads the geometry, from the mesh cache if there is one, and writes the
+	 *  cache if there wasn't (unless DisableCacheWrite()). Never throws; check GetState() afterwards.
+	 */
+	void Load();
+
+	/** Like Load(), but only works out the MeshStats */
+	void LoadStats();
+
+	/** Makes Load() keep the triangle corners it reads for TakePreview(). Call before Load(). */
+	void EnablePreview() { m_keep_preview = true; }
+
+	/** Makes Load() read the mesh cache if there is one, but never write it. Call before Load(). */
+	void DisableCacheWrite() { m_write_cache = false; }
+
+	/** Moves the triangle corners read since the last call into corners, for showing
+	 *  the mesh while it loads. Files only stl_importer reads have no preview. Any thread.
+	 */
+	void TakePreview(std::vector<float>& corners);
+
+	/** Makes a running (or pending) Load() stop as soon as it can. Any thread. */
+	void Cancel() { m_cancel.store(true); }
+
+	/** Any thread */
+	State GetState() const { return (State) m_state.load(std::memory_order_acquire); }
+
+	/** How far along Load() is, from 0 to 1. Any thread. */
+	double Progress() const;
+
+	/** The number of facets read so far. Any thread. */
+	size_t FacetsRead() const { return m_facets_read.load(std::memory_order_relaxed); }
+
+	const std::string& Filename() const { return m_filename; }
+
+	/** @{ Only valid once GetState() is STATE_DONE */
+	const std::shared_ptr<MeshGeometry>& Geometry() const { return m_geometry; }
+	const MeshStats& Stats() const { return m_stats; }
+	bool FromCache() const { return m_from_cache; }
+	/** @} */
+
+	/** How long the full import took when the mesh cache was written, once Load() has
+	 *  loaded from it. Set against Seconds() for how much the cache saved.
+	 */
+	double CachedImportSeconds() const { return m_cached_import_seconds; }
+
+	/** Why loading failed, once GetState() is STATE_FAILED */
+	const std::string& Error() const { return m_error; }
+
+	/** How long loading took, once it's finished */
+	double Seconds() const { return m_seconds; }
+};
+
+#endif /* MESHLOADER_H_ */
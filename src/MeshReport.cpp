@@ -0,0 +1,246 @@
+/*
+ * MeshReport.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MeshReport.h"
+#include "MeshLoader.h"
+#include "WorkerPool.h"
+#include "Parallel.h"
+
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace
+{
+	bool is_stl_filename(const std::string& filename)
+	{
+		std::string lower(filename);
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+
+		for (const char* extension : { ".stl", ".stl.gz", ".stl.zst" })
+		{
+			const size_t ext_len = std::strlen(extension);
+			if (lower.size() > ext_len && lower.compare(lower.size() - ext_len, ext_len, extension) == 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	std::string json_string(const std::string& s)
+	{
+		std::ostringstream ss;
+		ss << '"';
+
+		for (unsigned char c : s)
+		{
+			switch (c)
+			{
+			case '"':	ss << "\\\""; break;
+			case '\\':	ss << "\\\\"; break;
+			case '\n':	ss << "\\n"; break;
+			case '\r':	ss << "\\r"; break;
+			case '\t':	ss << "\\t"; break;
+			default:
+				if (c < 0x20)
+					ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec;
+				else
+					ss << c;
+			}
+		}
+
+		ss << '"';
+		return ss.str();
+	}
+
+	std::string csv_string(const std::string& s)
+	{
+		if (s.find_first_of(",\"\n\r") == std::string::npos)
+			return s;
+
+		std::string quoted("\"");
+		for (char c : s)
+		{
+			if (c == '"')
+				quoted += '"';
+			quoted += c;
+		}
+
+		return quoted + "\"";
+	}
+};
+
+//static
+MeshReport MeshReport::Generate(const std::string& filename, unsigned num_threads, double weld_tolerance, double crease_angle)
+{
+	MeshLoader loader(filename, num_threads, weld_tolerance, crease_angle);
+	loader.LoadStats();
+
+	MeshReport report;
+	report.filename = filename;
+	report.seconds = loader.Seconds();
+
+	if (loader.GetState() == MeshLoader::STATE_DONE)
+	{
+		report.stats = loader.Stats();
+		report.from_cache = loader.FromCache();
+	}
+	else
+		report.error = loader.Error();
+
+	return report;
+}
+
+//static
+std::vector<MeshReport> MeshReport::GenerateAll(const std::vector<std::string>& filenames, unsigned num_threads,
+												double weld_tolerance, double crease_angle)
+{
+	std::vector<MeshReport> reports(filenames.size());
+
+	WorkerPool pool(std::max<unsigned>(1, std::min<size_t>(ResolveThreadCount(num_threads), filenames.size())));
+
+	// With fewer files than threads, give each file a share of the rest
+	const unsigned parse_threads = std::max<unsigned>(1, ResolveThreadCount(num_threads) / pool.NumThreads());
+
+	for (size_t i = 0 ; i < filenames.size() ; i++)
+	{
+		pool.Submit(
+			[&reports, &filenames, i, parse_threads, weld_tolerance, crease_angle]()
+			{
+				reports[i] = Generate(filenames[i], parse_threads, weld_tolerance, crease_angle);
+			});
+	}
+
+	pool.Wait();
+
+	return reports;
+}
+
+//static
+void MeshReport::FindSTLFiles(const std::string& path, std::vector<std::string>& filenames)
+{
+	struct stat st;
+	if (::stat(path.c_str(), &st) == -1)
+		throw std::runtime_error(path + ": " + ::strerror(errno));
+
+	if (!S_ISDIR(st.st_mode))
+	{
+		filenames.push_back(path);
+		return;
+	}
+
+	DIR* dir = ::opendir(path.c_str());
+	if (!dir)
+		throw std::runtime_error(path + ": " + ::strerror(errno));
+
+	std::vector<std::string> entries;
+	while (struct dirent* entry = ::readdir(dir))
+	{
+		if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0)
+			entries.emplace_back(entry->d_name);
+	}
+
+	::closedir(dir);
+
+	// readdir() order is arbitrary, keep the reports stable from night to night
+	std::sort(entries.begin(), entries.end());
+
+	const std::string dir_prefix = (!path.empty() && path.back() == '/') ? path : path + "/";
+	for (const std::string& entry : entries)
+	{
+		const std::string entry_path = dir_prefix + entry;
+
+		if (::stat(entry_path.c_str(), &st) == -1)
+			continue;
+
+		if (S_ISDIR(st.st_mode))
+			FindSTLFiles(entry_path, filenames);
+		else if (is_stl_filename(entry))
+			filenames.push_back(entry_path);
+	}
+}
+
+//static
+void MeshReport::WriteJSON(std::ostream& os, const std::vector<MeshReport>& reports)
+{
+	os << std::setprecision(10);
+	os << "[" << std::endl;
+
+	for (size_t i = 0 ; i < reports.size() ; i++)
+	{
+		const MeshReport& r = reports[i];
+		const MeshStats& s = r.stats;
+
+		os << "  {\"file\": " << json_string(r.filename);
+
+		if (r.Ok())
+		{
+			os	<< ", \"name\": " << json_string(s.name)
+				<< ", \"facets\": " << s.num_facets
+				<< ", \"edges\": " << s.num_edges
+				<< ", \"vertices\": " << s.num_vertices
+				<< ", \"euler_characteristic\": " << s.EulerCharacteristic()
+				<< ", \"lamina_edges\": " << s.num_lamina_edges
+				<< ", \"volume\": " << s.volume
+				<< ", \"area\": " << s.area
+				<< ", \"closed\": " << (s.is_closed ? "true" : "false")
+				<< ", \"bbox\": [" << s.extent[0] << ", " << s.extent[1] << ", " << s.extent[2] << "]"
+				<< ", \"cached\": " << (r.from_cache ? "true" : "false");
+		}
+		else
+		{
+			os << ", \"error\": " << json_string(r.error);
+		}
+
+		os << ", \"seconds\": " << r.seconds << "}" << (i + 1 < reports.size() ? "," : "") << std::endl;
+	}
+
+	os << "]" << std::endl;
+}
+
+//static
+void MeshReport::WriteCSV(std::ostream& os, const std::vector<MeshReport>& reports)
+{
+	os << std::setprecision(10);
+	os	<< "file,name,facets,edges,vertices,euler_characteristic,lamina_edges,volume,area,closed,"
+		<< "bbox_x,bbox_y,bbox_z,cached,seconds,error" << std::endl;
+
+	for (const MeshReport& r : reports)
+	{
+		const MeshStats& s = r.stats;
+
+		os << csv_string(r.filename) << ",";
+
+		if (r.Ok())
+		{
+			os	<< csv_string(s.name) << ","
+				<< s.num_facets << ","
+				<< s.num_edges << ","
+				<< s.num_vertices << ","
+				<< s.EulerCharacteristic() << ","
+				<< s.num_lamina_edges << ","
+				<< s.volume << ","
+				<< s.area << ","
+				<< (s.is_closed ? "true" : "false") << ","
+				<< s.extent[0] << "," << s.extent[1] << "," << s.extent[2] << ","
+				<< (r.from_cache ? "true" : "false") << ",";
+		}
+		else
+		{
+			os << ",,,,,,,,,,,,,";
+		}
+
+		os << r.seconds << "," << csv_string(r.error) << std::endl;
+	}
+}
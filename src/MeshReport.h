@@ -0,0 +1,55 @@
+/*
+ * MeshReport.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MESHREPORT_H_
+#define MESHREPORT_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "MeshStats.h"
+
+/** The Mesh Info numbers for one file, without any GUI.
+ *  Used by "stlview --report" to check lots of files at once.
+ */
+struct MeshReport
+{
+	std::string	filename;
+	MeshStats	stats;
+	double		seconds = 0.0;		///< How long the file took
+	bool		from_cache = false;	///< True if the stats came out of the mesh cache
+	std::string	error;				///< Why the file couldn't be read, empty if it could
+
+	bool Ok() const { return error.empty(); }
+
+	/** Reads an STL file (binary, ASCII or compressed) and works out its stats.
+	 *  Uses the mesh cache if the file has one. Never throws, errors go in MeshReport::error.
+	 *  @param	filename		The STL file
+	 *  @param	num_threads		The number of threads to parse the file with, 0 for the default
+	 *  @param	weld_tolerance	The weld tolerance the mesh cache was written with
+	 *  @param	crease_angle	The crease angle the mesh cache was written with
+	 */
+	static MeshReport Generate(const std::string& filename, unsigned num_threads, double weld_tolerance, double crease_angle);
+
+	/** Generates reports for a list of files on a pool of num_threads threads (0 for the default).
+	 *  The reports are in the same order as the files.
+	 */
+	static std::vector<MeshReport> GenerateAll(const std::vector<std::string>& filenames, unsigned num_threads,
+											   double weld_tolerance, double crease_angle);
+
+	/** Adds path to filenames if it is a file, or every STL file under it if it is a directory.
+	 *  STL files are the ones ending in .stl, .stl.gz or .stl.zst, in any case.
+	 *  @throws std::runtime_error if path doesn't exist
+	 */
+	static void FindSTLFiles(const std::string& path, std::vector<std::string>& filenames);
+
+	static void WriteJSON(std::ostream& os, const std::vector<MeshReport>& reports);
+	static void WriteCSV(std::ostream& os, const std::vector<MeshReport>& reports);
+};
+
+#endif /* MESHREPORT_H_ */
@@ -0,0 +1,671 @@
+/*
+ * MeshSimplifier.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MeshSimplifier.h"
+#include "MeshGeometry.h"
+#include "IndexedMesh.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace
+{
+	/** The error a collapse may have in a pass is THRESHOLD_BASE * (pass + 3) ^ THRESHOLD_GROWTH,
+	 *  in squared units of the mesh's largest dimension. So the cheap collapses go first,
+	 *  without keeping every edge in a priority queue.
+	 */
+	const double THRESHOLD_BASE = 1.0e-9;
+	const double THRESHOLD_GROWTH = 7.0;
+
+	/** Passes before a level gives up on reaching its facet count */
+	const int MAX_PASSES = 100;
+
+	/** Deleted facets are dropped, and the vertex facet lists rebuilt, every so many passes */
+	const int COMPACT_PASSES = 5;
+
+	/** A collapse may not turn a facet further than this from its normal (about 78 degrees) */
+	const double MIN_NORMAL_COS = 0.2;
+
+	/** Nor may it leave a facet with two edges this close to parallel */
+	const double MAX_EDGE_COS = 0.999;
+
+	/** Below this (relative to the quadric's scale), the optimal position is ill-defined */
+	const double MIN_RELATIVE_DETERMINANT = 1.0e-9;
+
+	inline double det3(double a, double b, double c, double d, double e, double f, double g, double h, double i)
+	{
+		return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+	}
+
+	inline double dot(const double* a, const double* b)
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	inline void cross(const double* a, const double* b, double* c)
+	{
+		c[0] = a[1] * b[2] - a[2] * b[1];
+		c[1] = a[2] * b[0] - a[0] * b[2];
+		c[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	inline bool normalize(double* v)
+	{
+		const double len = std::sqrt(dot(v, v));
+		if (len <= 0.0)
+			return false;
+
+		v[0] /= len;
+		v[1] /= len;
+		v[2] /= len;
+
+		return true;
+	}
+
+	/** The sum of squared distances to a set of planes, as a symmetric 4x4 matrix
+	 *  (the upper triangle, row by row), and how many planes there are
+	 */
+	struct quadric
+	{
+		double m[10];
+		double num_planes;
+
+		static quadric zero()
+		{
+			quadric q;
+			std::fill(q.m, q.m + 10, 0.0);
+			q.num_planes = 0.0;
+
+			return q;
+		}
+
+		/** The squared distance to the plane n . p + d = 0, for a unit n */
+		static quadric plane(const double* n, double d)
+		{
+			return {{	n[0] * n[0], n[0] * n[1], n[0] * n[2], n[0] * d,
+									 n[1] * n[1], n[1] * n[2], n[1] * d,
+												  n[2] * n[2], n[2] * d,
+																   d * d }, 1.0 };
+		}
+
+		quadric& operator+=(const quadric& rhs)
+		{
+			for (int i = 0 ; i < 10 ; i++)
+				m[i] += rhs.m[i];
+
+			num_planes += rhs.num_planes;
+
+			return *this;
+		}
+
+		quadric operator+(const quadric& rhs) const
+		{
+			quadric q = *this;
+
+			return q += rhs;
+		}
+
+		double error(const double* p) const
+		{
+			const double x = p[0], y = p[1], z = p[2];
+
+			return	m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x +
+					m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y +
+					m[7] * z * z + 2.0 * m[8] * z +
+					m[9];
+		}
+
+		/** The point with the least error, unless it's ill-defined (flat or straight regions) */
+		bool minimum(double* p) const
+		{
+			const double det = det3(m[0], m[1], m[2], m[1], m[4], m[5], m[2], m[5], m[7]);
+			const double scale = m[0] + m[4] + m[7];
+			if (std::fabs(det) <= MIN_RELATIVE_DETERMINANT * scale * scale * scale)
+				return false;
+
+			p[0] = det3(-m[3], m[1], m[2], -m[6], m[4], m[5], -m[8], m[5], m[7]) / det;
+			p[1] = det3(m[0], -m[3], m[2], m[1], -m[6], m[5], m[2], -m[8], m[7]) / det;
+			p[2] = det3(m[0], m[1], -m[3], m[1], m[4], -m[6], m[2], m[5], -m[8]) / det;
+
+			return true;
+		}
+	};
+
+	const uint32_t NO_FEATURES = std::numeric_limits<uint32_t>::max();
+
+	struct vertex
+	{
+		double		p[3];		///< Scaled to the unit cube
+		quadric		q;
+		uint32_t	first_ref;	///< The vertex's facets are refs[first_ref, first_ref + num_refs)
+		uint32_t	num_refs;
+		uint32_t	features;	///< Its list of feature edge neighbors, or NO_FEATURES
+
+		/** On a boundary, crease or non-manifold edge */
+		bool constrained() const { return features != NO_FEATURES; }
+	};
+
+	struct facet
+	{
+		uint32_t	v[3];
+		double		n[3];
+		double		err[4];		///< The cost of collapsing each edge (v[k], v[k + 1]), and the least of them
+		bool		deleted;
+		bool		dirty;		///< Changed in this pass
+	};
+
+	/** A facet around a vertex, and which of its corners the vertex is */
+	struct facet_ref
+	{
+		uint32_t	facet;
+		uint32_t	corner;
+	};
+
+	/** The working mesh, simplified a level at a time */
+	class collapser
+	{
+	private:
+		std::vector<vertex>		m_vertices;
+		std::vector<facet>		m_facets;
+		std::vector<facet_ref>	m_refs;
+		std::vector<std::vector<uint32_t>>	m_features;	///< The other ends of the feature edges at each constrained vertex
+		size_t					m_num_facets;	///< Not deleted
+		double					m_max_error;	///< The largest mean squared plane distance of a collapse so far
+		double					m_scale;
+		double					m_origin[3];
+
+		// Scratch space for collapse()
+		std::vector<bool>		m_deleted0;
+		std::vector<bool>		m_deleted1;
+
+		void compute_normal(facet& f) const
+		{
+			const double* p0 = m_vertices[f.v[0]].p;
+			const double* p1 = m_vertices[f.v[1]].p;
+			const double* p2 = m_vertices[f.v[2]].p;
+
+			const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+			cross(e1, e2, f.n);
+			if (!normalize(f.n))
+				f.n[0] = f.n[1] = f.n[2] = 0.0;
+		}
+
+		/** The cost of collapsing i0 and i1, and where the vertex should go */
+		double collapse_error(uint32_t i0, uint32_t i1, double* p) const
+		{
+			const vertex& v0 = m_vertices[i0];
+			const vertex& v1 = m_vertices[i1];
+			const quadric q = v0.q + v1.q;
+
+			if (!v0.constrained() && !v1.constrained() && q.minimum(p))
+			{
+				// Don't trust a minimum far outside the edge
+				const double mid[3] = { 0.5 * (v0.p[0] + v1.p[0]), 0.5 * (v0.p[1] + v1.p[1]), 0.5 * (v0.p[2] + v1.p[2]) };
+				const double d[3] = { p[0] - mid[0], p[1] - mid[1], p[2] - mid[2] };
+				const double e[3] = { v1.p[0] - v0.p[0], v1.p[1] - v0.p[1], v1.p[2] - v0.p[2] };
+				if (dot(d, d) <= 4.0 * dot(e, e))
+					return q.error(p);
+			}
+
+			// Otherwise one of the ends, or the middle
+			const double mid[3] = { 0.5 * (v0.p[0] + v1.p[0]), 0.5 * (v0.p[1] + v1.p[1]), 0.5 * (v0.p[2] + v1.p[2]) };
+			const double* candidates[3] = { v0.p, v1.p, mid };
+
+			double best = std::numeric_limits<double>::max();
+			for (const double* c : candidates)
+			{
+				const double err = q.error(c);
+				if (err < best)
+				{
+					best = err;
+					std::copy(c, c + 3, p);
+				}
+			}
+
+			return best;
+		}
+
+		void compute_errors(facet& f) const
+		{
+			double p[3];
+			for (int k = 0 ; k < 3 ; k++)
+				f.err[k] = collapse_error(f.v[k], f.v[(k + 1) % 3], p);
+
+			f.err[3] = std::min({ f.err[0], f.err[1], f.err[2] });
+		}
+
+		/** Whether moving i0 to p (merging it with i1) would flip or squash one of i0's facets.
+		 *  Marks the facets shared with i1 in deleted, since they go away.
+		 */
+		bool flips(uint32_t i0, uint32_t i1, const double* p, std::vector<bool>& deleted) const
+		{
+			const vertex& v0 = m_vertices[i0];
+			deleted.assign(v0.num_refs, false);
+
+			for (uint32_t k = 0 ; k < v0.num_refs ; k++)
+			{
+				const facet_ref& ref = m_refs[v0.first_ref + k];
+				const facet& f = m_facets[ref.facet];
+				if (f.deleted)
+					continue;
+
+				const uint32_t id1 = f.v[(ref.corner + 1) % 3];
+				const uint32_t id2 = f.v[(ref.corner + 2) % 3];
+				if (id1 == i1 || id2 == i1)
+				{
+					deleted[k] = true;
+					continue;
+				}
+
+				double d1[3] = { m_vertices[id1].p[0] - p[0], m_vertices[id1].p[1] - p[1], m_vertices[id1].p[2] - p[2] };
+				double d2[3] = { m_vertices[id2].p[0] - p[0], m_vertices[id2].p[1] - p[1], m_vertices[id2].p[2] - p[2] };
+				if (!normalize(d1) || !normalize(d2) || std::fabs(dot(d1, d2)) > MAX_EDGE_COS)
+					return true;
+
+				double n[3];
+				cross(d1, d2, n);
+				if (!normalize(n) || dot(n, f.n) < MIN_NORMAL_COS)
+					return true;
+			}
+
+			return false;
+		}
+
+		/** Points the facets of v (except deleted ones) at i0 and adds them to the end of m_refs */
+		void update_facets(uint32_t i0, const vertex& v, const std::vector<bool>& deleted)
+		{
+			for (uint32_t k = 0 ; k < v.num_refs ; k++)
+			{
+				const facet_ref ref = m_refs[v.first_ref + k];
+				facet& f = m_facets[ref.facet];
+				if (f.deleted)
+					continue;
+
+				if (deleted[k])
+				{
+					f.deleted = true;
+					m_num_facets--;
+					continue;
+				}
+
+				f.v[ref.corner] = i0;
+				f.dirty = true;
+				compute_normal(f);
+				compute_errors(f);
+
+				m_refs.push_back(ref);
+			}
+		}
+
+		/** Merges i1 into i0, if that doesn't damage the mesh */
+		bool collapse(uint32_t i0, uint32_t i1)
+		{
+			vertex& v0 = m_vertices[i0];
+			const vertex& v1 = m_vertices[i1];
+
+			// Constrained vertices stay on their lines, so they only collapse along them
+			if (v0.constrained() != v1.constrained())
+				return false;
+
+			if (v0.constrained())
+			{
+				const std::vector<uint32_t>& features0 = m_features[v0.features];
+				if (std::find(features0.begin(), features0.end(), i1) == features0.end())
+					return false;
+			}
+
+			double p[3];
+			const double err = collapse_error(i0, i1, p);
+
+			if (flips(i0, i1, p, m_deleted0) || flips(i1, i0, p, m_deleted1))
+				return false;
+
+			const double num_planes = v0.q.num_planes + v1.q.num_planes;
+			if (num_planes > 0.0)
+				m_max_error = std::max(m_max_error, err / num_planes);
+
+			std::copy(p, p + 3, v0.p);
+			v0.q += v1.q;
+
+			const uint32_t first_ref = (uint32_t) m_refs.size();
+			update_facets(i0, v0, m_deleted0);
+			update_facets(i0, v1, m_deleted1);
+			const uint32_t num_refs = (uint32_t) m_refs.size() - first_ref;
+
+			// Reuse v0's old space in m_refs if the new list fits
+			if (num_refs <= v0.num_refs)
+			{
+				std::copy(m_refs.begin() + first_ref, m_refs.end(), m_refs.begin() + v0.first_ref);
+				m_refs.resize(first_ref);
+			}
+			else
+			{
+				v0.first_ref = first_ref;
+			}
+
+			v0.num_refs = num_refs;
+
+			if (v0.constrained())
+				merge_features(i0, i1);
+
+			return true;
+		}
+
+		/** Moves i1's feature edges over to i0, once i1 has been merged into it */
+		void merge_features(uint32_t i0, uint32_t i1)
+		{
+			std::vector<uint32_t>& features0 = m_features[m_vertices[i0].features];
+			std::vector<uint32_t>& features1 = m_features[m_vertices[i1].features];
+
+			features0.erase(std::remove(features0.begin(), features0.end(), i1), features0.end());
+
+			for (uint32_t n : features1)
+			{
+				if (n == i0 || n == i1)
+					continue;
+
+				// n's edge to i1 becomes its edge to i0, unless it has one already
+				std::vector<uint32_t>& features_n = m_features[m_vertices[n].features];
+				features_n.erase(std::remove(features_n.begin(), features_n.end(), i1), features_n.end());
+
+				if (std::find(features0.begin(), features0.end(), n) == features0.end())
+				{
+					features0.push_back(n);
+					features_n.push_back(i0);
+				}
+			}
+
+			std::vector<uint32_t>().swap(features1);
+		}
+
+		/** Drops the deleted facets and rebuilds the facet lists of the vertices */
+		void compact()
+		{
+			m_facets.erase(std::remove_if(m_facets.begin(), m_facets.end(), [](const facet& f) { return f.deleted; }),
+						   m_facets.end());
+
+			for (vertex& v : m_vertices)
+				v.num_refs = 0;
+
+			for (const facet& f : m_facets)
+			{
+				for (int k = 0 ; k < 3 ; k++)
+					m_vertices[f.v[k]].num_refs++;
+			}
+
+			uint32_t first_ref = 0;
+			for (vertex& v : m_vertices)
+			{
+				v.first_ref = first_ref;
+				first_ref += v.num_refs;
+				v.num_refs = 0;
+			}
+
+			m_refs.resize(first_ref);
+			for (size_t i = 0 ; i < m_facets.size() ; i++)
+			{
+				for (uint32_t k = 0 ; k < 3 ; k++)
+				{
+					vertex& v = m_vertices[m_facets[i].v[k]];
+					m_refs[v.first_ref + v.num_refs++] = { (uint32_t) i, k };
+				}
+			}
+		}
+
+		/** The facet with the edge (a, b), for the boundary planes */
+		const facet* find_facet(uint32_t a, uint32_t b) const
+		{
+			const vertex& v = m_vertices[a];
+			for (uint32_t k = 0 ; k < v.num_refs ; k++)
+			{
+				const facet_ref& ref = m_refs[v.first_ref + k];
+				const facet& f = m_facets[ref.facet];
+				if (f.v[(ref.corner + 1) % 3] == b || f.v[(ref.corner + 2) % 3] == b)
+					return &f;
+			}
+
+			return nullptr;
+		}
+
+	public:
+		collapser(const MeshGeometry& geometry, unsigned num_threads)
+		: m_num_facets(0)
+		, m_max_error(0.0)
+		{
+			const double extent = std::max({	geometry.bbox_max[0] - geometry.bbox_min[0],
+												geometry.bbox_max[1] - geometry.bbox_min[1],
+												geometry.bbox_max[2] - geometry.bbox_min[2] });
+			m_scale = extent > 0.0 ? extent : 1.0;
+			std::copy(geometry.bbox_min, geometry.bbox_min + 3, m_origin);
+
+			m_vertices.resize(geometry.NumVertices());
+			for (size_t i = 0 ; i < m_vertices.size() ; i++)
+			{
+				vertex& v = m_vertices[i];
+				for (int k = 0 ; k < 3 ; k++)
+					v.p[k] = (geometry.positions[3 * i + k] - m_origin[k]) / m_scale;
+
+				v.q = quadric::zero();
+				v.features = NO_FEATURES;
+			}
+
+			// Facets that are already degenerate would only get in the way
+			m_facets.reserve(geometry.NumFacets());
+			for (size_t i = 0 ; i < geometry.NumFacets() ; i++)
+			{
+				facet f;
+				std::copy(&geometry.indices[3 * i], &geometry.indices[3 * i] + 3, f.v);
+				if (f.v[0] == f.v[1] || f.v[1] == f.v[2] || f.v[2] == f.v[0])
+					continue;
+
+				f.deleted = false;
+				f.dirty = false;
+				m_facets.push_back(f);
+			}
+
+			m_num_facets = m_facets.size();
+			compact();
+
+			ParallelFor(0, m_facets.size(), num_threads,
+				[this](size_t begin, size_t end, size_t)
+				{
+					for (size_t i = begin ; i < end ; i++)
+						compute_normal(m_facets[i]);
+				});
+
+			// The planes of the facets around each vertex
+			ParallelFor(0, m_vertices.size(), num_threads,
+				[this](size_t begin, size_t end, size_t)
+				{
+					for (size_t i = begin ; i < end ; i++)
+					{
+						vertex& v = m_vertices[i];
+						for (uint32_t k = 0 ; k < v.num_refs ; k++)
+						{
+							const facet& f = m_facets[m_refs[v.first_ref + k].facet];
+							v.q += quadric::plane(f.n, -dot(f.n, m_vertices[f.v[0]].p));
+						}
+					}
+				});
+
+			// The geometry's feature edges at its crease angle are the boundaries, creases and non-manifold edges
+			const size_t num_feature_edges = geometry.NumFeatureEdges(geometry.crease_angle);
+			for (size_t i = 0 ; i < num_feature_edges ; i++)
+			{
+				const uint32_t ends[2] = { geometry.edges[2 * i], geometry.edges[2 * i + 1] };
+				if (ends[0] == ends[1])
+					continue;
+
+				for (int k = 0 ; k < 2 ; k++)
+				{
+					vertex& v = m_vertices[ends[k]];
+					if (!v.constrained())
+					{
+						v.features = (uint32_t) m_features.size();
+						m_features.emplace_back();
+					}
+
+					m_features[v.features].push_back(ends[1 - k]);
+				}
+			}
+
+			for (size_t i = 0 ; i < geometry.lamina_edges.size() ; i += 2)
+			{
+				const uint32_t a = geometry.lamina_edges[i];
+				const uint32_t b = geometry.lamina_edges[i + 1];
+				const facet* f = find_facet(a, b);
+				if (!f)
+					continue;
+
+				const double* pa = m_vertices[a].p;
+				const double* pb = m_vertices[b].p;
+				const double e[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+
+				double n[3];
+				cross(e, f->n, n);
+				if (!normalize(n))
+					continue;
+
+				const quadric q = quadric::plane(n, -dot(n, pa));
+				m_vertices[a].q += q;
+				m_vertices[b].q += q;
+			}
+
+			ParallelFor(0, m_facets.size(), num_threads,
+				[this](size_t begin, size_t end, size_t)
+				{
+					for (size_t i = begin ; i < end ; i++)
+						compute_errors(m_facets[i]);
+				});
+		}
+
+		size_t num_facets() const { return m_num_facets; }
+
+		/** The error of the mesh so far, in model units: the largest RMS distance
+		 *  of a merged vertex from the original planes around it
+		 */
+		double error() const { return std::sqrt(std::max(0.0, m_max_error)) * m_scale; }
+
+		/** Collapses edges until at most target_facets are left, or the passes run out.
+		 *  @returns	false if it was cancelled
+		 */
+		bool collapse_to(size_t target_facets, const std::atomic<bool>* cancel)
+		{
+			for (int pass = 0 ; pass < MAX_PASSES && m_num_facets > target_facets ; pass++)
+			{
+				if (cancel && cancel->load(std::memory_order_relaxed))
+					return false;
+
+				if (pass % COMPACT_PASSES == 0)
+					compact();
+
+				for (facet& f : m_facets)
+					f.dirty = false;
+
+				const double threshold = THRESHOLD_BASE * std::pow(pass + 3.0, THRESHOLD_GROWTH);
+
+				for (size_t i = 0 ; i < m_facets.size() && m_num_facets > target_facets ; i++)
+				{
+					const facet& f = m_facets[i];
+					if (f.deleted || f.dirty || f.err[3] > threshold)
+						continue;
+
+					for (int k = 0 ; k < 3 ; k++)
+					{
+						if (f.err[k] <= threshold && collapse(f.v[k], f.v[(k + 1) % 3]))
+							break;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		/** The mesh as it is now, with only the vertices that are still used */
+		IndexedMesh mesh() const
+		{
+			const uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+			std::vector<uint32_t> remap(m_vertices.size(), NO_VERTEX);
+
+			IndexedMesh mesh;
+			mesh.indices.reserve(3 * m_num_facets);
+
+			for (const facet& f : m_facets)
+			{
+				if (f.deleted)
+					continue;
+
+				for (int k = 0 ; k < 3 ; k++)
+				{
+					uint32_t& id = remap[f.v[k]];
+					if (id == NO_VERTEX)
+					{
+						id = (uint32_t) mesh.NumVertices();
+						for (int j = 0 ; j < 3 ; j++)
+							mesh.positions.push_back((float) (m_vertices[f.v[k]].p[j] * m_scale + m_origin[j]));
+					}
+
+					mesh.indices.push_back(id);
+				}
+			}
+
+			return mesh;
+		}
+	};
+};
+
+//static
+const double MeshSimplifier::DEFAULT_REDUCTION = 4.0;
+
+//static
+const size_t MeshSimplifier::DEFAULT_MIN_FACETS = 20000;
+
+size_t MeshSimplifier::BuildLevels(const MeshGeometry& geometry, const std::function<void (Level&&)>& on_level,
+								   const std::atomic<bool>* cancel) const
+{
+	collapser c(geometry, m_num_threads);
+
+	size_t num_levels = 0;
+	for (;;)
+	{
+		const size_t num_facets = c.num_facets();
+		const size_t target_facets = (size_t) (num_facets / std::max(1.0, m_reduction));
+		if (target_facets < m_min_facets || target_facets >= num_facets)
+			break;
+
+		if (!c.collapse_to(target_facets, cancel))
+			break;
+
+		// A level that's barely smaller isn't worth drawing
+		if (c.num_facets() <= num_facets - (num_facets - target_facets) / 2)
+		{
+			MeshStats stats;
+			stats.name = geometry.stats.name;
+			stats.num_facets = c.num_facets();
+
+			Level level;
+			level.geometry = MeshGeometry::Build(c.mesh(), stats, geometry.crease_angle, m_num_threads);
+			level.error = c.error();
+			level.geometry->stats.num_vertices = level.geometry->NumVertices();
+			level.geometry->stats.num_edges = level.geometry->NumEdges();
+
+			on_level(std::move(level));
+			num_levels++;
+		}
+
+		// Stuck, so the next level would be too
+		if (c.num_facets() > target_facets)
+			break;
+	}
+
+	return num_levels;
+}
@@ -0,0 +1,78 @@
+/*
+ * MeshSimplifier.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MESHSIMPLIFIER_H_
+#define MESHSIMPLIFIER_H_
+
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+
+struct MeshGeometry;
+
+/** Builds a chain of levels of detail for a mesh by quadric edge collapse
+ *  (Garland and Heckbert), cheapest collapses first.
+ *
+ *  Each vertex carries the quadric of the original facet planes around it, so
+ *  the error of every level is measured against the original surface, not the
+ *  level before. Boundary edges add planes perpendicular to their facet, so
+ *  boundaries can't shrink for free. Vertices on boundaries, creases (edges
+ *  sharper than the mesh's crease angle) and non-manifold edges only collapse
+ *  into each other along one of those edges, and then only to one end or the
+ *  middle of it, so those lines stay where they are.
+ *
+ *  Collapses that would flip a facet or make it degenerate are skipped.
+ */
+class MeshSimplifier
+{
+public:
+	/** One level of detail */
+	struct Level
+	{
+		std::shared_ptr<MeshGeometry>	geometry;
+		double							error;	///< How far the level may be from the original surface, in model units
+	};
+
+	/** Each level has about this many times fewer facets than the one before */
+	static const double	DEFAULT_REDUCTION;
+
+	/** No level gets fewer facets than this */
+	static const size_t	DEFAULT_MIN_FACETS;
+
+private:
+	double		m_reduction;
+	size_t		m_min_facets;
+	unsigned	m_num_threads;
+
+public:
+	/** Constructor.
+	 *  @param	reduction	How many times fewer facets each level has than the one before
+	 *  @param	min_facets	The fewest facets a level may have
+	 *  @param	num_threads	The number of threads to build each level's geometry with, 0 for the default
+	 */
+	MeshSimplifier(double reduction = DEFAULT_REDUCTION, size_t min_facets = DEFAULT_MIN_FACETS, unsigned num_threads = 0)
+	: m_reduction(reduction)
+	, m_min_facets(min_facets)
+	, m_num_threads(num_threads)
+	{
+
+	}
+
+	/** Builds successively coarser levels of geometry, until the next one would have
+	 *  fewer than min_facets or the mesh can't be simplified any further.
+	 *  The levels' normals are split at geometry.crease_angle.
+	 *  @param	geometry	The full detail mesh
+	 *  @param	on_level	Called with each level as soon as it's built, finest first
+	 *  @param	cancel		If not null, stops early once this is set
+	 *  @returns			The number of levels built
+	 */
+	size_t BuildLevels(const MeshGeometry& geometry, const std::function<void (Level&&)>& on_level,
+					   const std::atomic<bool>* cancel = nullptr) const;
+};
+
+#endif /* MESHSIMPLIFIER_H_ */
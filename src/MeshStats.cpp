@@ -0,0 +1,61 @@
+/*
+ * MeshStats.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "MeshStats.h"
+#include "HalfEdgeMesh.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+//static
+MeshStats MeshStats::FromHalfEdgeMesh(const HalfEdgeMesh& mesh, const std::string& name)
+{
+	MeshStats stats;
+	stats.name = name;
+	stats.num_facets = mesh.NumFacets();
+	stats.num_edges = mesh.num_edges;
+	stats.num_vertices = mesh.NumVertices();
+	stats.num_lamina_edges = mesh.num_lamina_edges;
+	stats.is_closed = mesh.IsClosed();
+
+	// The volume by the divergence theorem: each facet's tetrahedron with the origin
+	for (size_t f = 0 ; f < mesh.NumFacets() ; f++)
+	{
+		const float* p0 = &mesh.positions[3 * mesh.indices[3 * f]];
+		const float* p1 = &mesh.positions[3 * mesh.indices[3 * f + 1]];
+		const float* p2 = &mesh.positions[3 * mesh.indices[3 * f + 2]];
+
+		const double e1[3] = { (double) p1[0] - p0[0], (double) p1[1] - p0[1], (double) p1[2] - p0[2] };
+		const double e2[3] = { (double) p2[0] - p0[0], (double) p2[1] - p0[1], (double) p2[2] - p0[2] };
+		const double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+		stats.area += 0.5 * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		stats.volume += (p0[0] * n[0] + p0[1] * n[1] + p0[2] * n[2]) / 6.0;
+	}
+
+	if (mesh.NumVertices() > 0)
+	{
+		double min[3], max[3];
+		std::fill(min, min + 3, std::numeric_limits<double>::max());
+		std::fill(max, max + 3, -std::numeric_limits<double>::max());
+
+		for (size_t i = 0 ; i < mesh.positions.size() ; i += 3)
+		{
+			for (int k = 0 ; k < 3 ; k++)
+			{
+				min[k] = std::min(min[k], (double) mesh.positions[i + k]);
+				max[k] = std::max(max[k], (double) mesh.positions[i + k]);
+			}
+		}
+
+		for (int k = 0 ; k < 3 ; k++)
+			stats.extent[k] = max[k] - min[k];
+	}
+
+	return stats;
+}
@@ -0,0 +1,40 @@
+/*
+ * MeshStats.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef MESHSTATS_H_
+#define MESHSTATS_H_
+
+#include <string>
+#include <cstdint>
+
+struct HalfEdgeMesh;
+
+/** The numbers shown in the Mesh Info dialog */
+struct MeshStats
+{
+	std::string	name;
+	uint64_t	num_facets = 0;
+	uint64_t	num_edges = 0;
+	uint64_t	num_vertices = 0;
+	uint64_t	num_lamina_edges = 0;
+	double		volume = 0.0;
+	double		area = 0.0;
+	bool		is_closed = false;
+	double		extent[3] = { 0.0, 0.0, 0.0 };	///< Bounding box dimensions in x, y, z
+
+	int64_t EulerCharacteristic() const
+	{
+		return (int64_t) num_vertices - (int64_t) num_edges + (int64_t) num_facets;
+	}
+
+	/** Counts the mesh's elements, and measures it.
+	 *  The volume is signed: negative if the facets face inwards.
+	 */
+	static MeshStats FromHalfEdgeMesh(const HalfEdgeMesh& mesh, const std::string& name);
+};
+
+#endif /* MESHSTATS_H_ */
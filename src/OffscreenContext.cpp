@@ -0,0 +1,138 @@
+/*
+ * OffscreenContext.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "OffscreenContext.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#ifdef STLVIEW_HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace
+{
+#ifdef STLVIEW_HAVE_EGL
+	/** A display without any window system if Mesa has one, otherwise the default */
+	EGLDisplay get_display()
+	{
+		const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+		if (client_extensions && std::strstr(client_extensions, "EGL_MESA_platform_surfaceless"))
+		{
+			auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+			if (get_platform_display)
+			{
+				EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+				if (display != EGL_NO_DISPLAY)
+					return display;
+			}
+		}
+
+		return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+#endif
+};
+
+#ifdef STLVIEW_HAVE_EGL
+struct OffscreenContext::egl_state
+{
+	EGLDisplay	display = EGL_NO_DISPLAY;
+	EGLSurface	surface = EGL_NO_SURFACE;
+	EGLContext	context = EGL_NO_CONTEXT;
+};
+#else
+struct OffscreenContext::egl_state
+{
+};
+#endif
+
+OffscreenContext::OffscreenContext(unsigned width, unsigned height)
+: m_width(std::max(1u, width))
+, m_height(std::max(1u, height))
+, m_egl(new egl_state)
+{
+#ifdef STLVIEW_HAVE_EGL
+	egl_state& egl = *m_egl;
+
+	egl.display = get_display();
+	if (egl.display == EGL_NO_DISPLAY || !eglInitialize(egl.display, nullptr, nullptr))
+		throw std::runtime_error("Couldn't initialize EGL");
+
+	// The display objects use the fixed function pipeline, so no ES
+	if (!eglBindAPI(EGL_OPENGL_API))
+		throw std::runtime_error("EGL doesn't have desktop OpenGL");
+
+	// Multisampled if we can get it, as thumbnails are small
+	for (EGLint samples : { 4, 0 })
+	{
+		const EGLint config_attribs[] =
+		{
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8,
+			EGL_GREEN_SIZE, 8,
+			EGL_BLUE_SIZE, 8,
+			EGL_DEPTH_SIZE, 24,
+			EGL_SAMPLE_BUFFERS, samples > 0 ? 1 : 0,
+			EGL_SAMPLES, samples,
+			EGL_NONE
+		};
+
+		EGLConfig config;
+		EGLint num_configs = 0;
+		if (!eglChooseConfig(egl.display, config_attribs, &config, 1, &num_configs) || num_configs < 1)
+			continue;
+
+		const EGLint surface_attribs[] = { EGL_WIDTH, (EGLint) m_width, EGL_HEIGHT, (EGLint) m_height, EGL_NONE };
+		egl.surface = eglCreatePbufferSurface(egl.display, config, surface_attribs);
+		if (egl.surface == EGL_NO_SURFACE)
+			continue;
+
+		egl.context = eglCreateContext(egl.display, config, EGL_NO_CONTEXT, nullptr);
+		if (egl.context != EGL_NO_CONTEXT)
+			break;
+
+		eglDestroySurface(egl.display, egl.surface);
+		egl.surface = EGL_NO_SURFACE;
+	}
+
+	if (egl.context == EGL_NO_CONTEXT)
+		throw std::runtime_error("Couldn't create an offscreen OpenGL context");
+
+	if (!eglMakeCurrent(egl.display, egl.surface, egl.surface, egl.context))
+	{
+		eglDestroyContext(egl.display, egl.context);
+		eglDestroySurface(egl.display, egl.surface);
+		throw std::runtime_error("Couldn't make the offscreen OpenGL context current");
+	}
+#else
+	throw std::runtime_error("stlview was built without EGL, so it can't render offscreen");
+#endif
+}
+
+OffscreenContext::~OffscreenContext()
+{
+#ifdef STLVIEW_HAVE_EGL
+	// The display is shared with the other contexts, so it's left initialized
+	eglMakeCurrent(m_egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(m_egl->display, m_egl->context);
+	eglDestroySurface(m_egl->display, m_egl->surface);
+	eglReleaseThread();
+#endif
+}
+
+//static
+bool OffscreenContext::IsSupported()
+{
+#ifdef STLVIEW_HAVE_EGL
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,48 @@
+/*
+ * OffscreenContext.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef OFFSCREENCONTEXT_H_
+#define OFFSCREENCONTEXT_H_
+
+#include <memory>
+
+/** An OpenGL context with a pbuffer to draw into, without a window or a display.
+ *
+ *  Uses EGL, on Mesa's surfaceless platform if it's there (llvmpipe renders on the
+ *  CPU), otherwise on EGL's default display. The context is desktop OpenGL, as the
+ *  display objects use the fixed function pipeline.
+ *
+ *  Needs EGL at build time (STLVIEW_HAVE_EGL).
+ */
+class OffscreenContext
+{
+private:
+	struct egl_state;
+
+	unsigned					m_width;
+	unsigned					m_height;
+	std::unique_ptr<egl_state>	m_egl;
+
+public:
+	/** Creates the context and makes it current on the calling thread, which is the
+	 *  only thread it may be used on.
+	 *  @throws std::runtime_error if there's no way to get an offscreen context
+	 */
+	OffscreenContext(unsigned width, unsigned height);
+	~OffscreenContext();
+
+	OffscreenContext(const OffscreenContext&) = delete;
+	OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+	/** Whether stlview was built with EGL */
+	static bool IsSupported();
+
+	unsigned Width() const { return m_width; }
+	unsigned Height() const { return m_height; }
+};
+
+#endif /* OFFSCREENCONTEXT_H_ */
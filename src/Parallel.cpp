@@ -0,0 +1,15 @@
+/*
+ * Parallel.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "Parallel.h"
+
+unsigned DefaultThreadCount()
+{
+	const unsigned hw_threads = std::thread::hardware_concurrency();
+
+	return hw_threads > 0 ? hw_threads : 1;
+}
@@ -0,0 +1,315 @@
+/*
+ * Parallel.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+/** The number of worker threads to use when none was asked for */
+unsigned DefaultThreadCount();
+
+/** Resolves a requested thread count, where 0 means "use the default" */
+inline unsigned ResolveThreadCount(unsigned num_threads)
+{
+	return num_threads == 0 ? DefaultThreadCount() : num_threads;
+}
+
+/** How many elements the long loops that take a cancel flag do between looks at it */
+const size_t CANCEL_CHECK_INTERVAL = 1 << 16;
+
+/** True if there's a cancel flag and it's set */
+inline bool IsCanceled(const std::atomic<bool>* cancel)
+{
+	return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+/** Splits [begin, end) into num_threads contiguous ranges and runs
+ *  func(range_begin, range_end, range_index) for each one on its own thread.
+ *  Blocks until all ranges are done. The first exception thrown by any
+ *  range is rethrown on the calling thread.
+ */
+template <typename Func>
+void ParallelFor(size_t begin, size_t end, unsigned num_threads, Func func)
+{
+	const size_t count = end > begin ? end - begin : 0;
+	const size_t num_ranges = std::max<size_t>(1, std::min<size_t>(ResolveThreadCount(num_threads), count));
+
+	if (num_ranges == 1)
+	{
+		func(begin, end, 0);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	std::vector<std::exception_ptr> errors(num_ranges);
+
+	for (size_t i = 0 ; i < num_ranges ; i++)
+	{
+		const size_t range_begin = begin + (count * i) / num_ranges;
+		const size_t range_end = begin + (count * (i + 1)) / num_ranges;
+
+		threads.emplace_back(
+			[&func, &errors, range_begin, range_end, i]()
+			{
+				try
+				{
+					func(range_begin, range_end, i);
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				}
+			});
+	}
+
+	for (std::thread& t : threads)
+		t.join();
+
+	for (const std::exception_ptr& error : errors)
+		if (error)
+			std::rethrow_exception(error);
+}
+
+/** Produces blocks [0, num_blocks) on worker threads and consumes them, in order,
+ *  on the calling thread.
+ *
+ *  produce(block_index, result) fills in a Result for the given block. Result objects
+ *  are recycled between blocks, so produce() is responsible for clearing it first.
+ *  consume(block_index, result) is called with each finished block in block order.
+ *  At most 2 * num_threads blocks are in flight at any time.
+ *
+ *  If either callback throws, the workers are stopped and the exception is rethrown
+ *  on the calling thread.
+ */
+template <typename Result, typename Produce, typename Consume>
+void ParallelOrderedBlocks(size_t num_blocks, unsigned num_threads, Produce produce, Consume consume)
+{
+	num_threads = ResolveThreadCount(num_threads);
+
+	if (num_threads <= 1)
+	{
+		Result result;
+		for (size_t b = 0 ; b < num_blocks ; b++)
+		{
+			produce(b, result);
+			consume(b, result);
+		}
+
+		return;
+	}
+
+	struct slot
+	{
+		Result	result;
+		bool	ready = false;
+	};
+
+	const size_t window = 2 * (size_t) num_threads;
+	std::vector<slot> slots(window);
+
+	std::mutex				mutex;
+	std::condition_variable	cv;
+	size_t					next_block = 0;	// next block to hand to a worker
+	size_t					consumed = 0;	// blocks the consumer is done with
+	bool					abort = false;
+	std::exception_ptr		error;
+
+	auto worker = [&]()
+	{
+		for (;;)
+		{
+			size_t block = 0;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cv.wait(lock, [&]() { return abort || next_block >= num_blocks || next_block < consumed + window; });
+
+				if (abort || next_block >= num_blocks)
+					return;
+
+				block = next_block++;
+			}
+
+			// Nobody else touches this slot until we mark it ready
+			slot& s = slots[block % window];
+			try
+			{
+				produce(block, s.result);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!error)
+					error = std::current_exception();
+				abort = true;
+				cv.notify_all();
+
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				s.ready = true;
+			}
+			cv.notify_all();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned i = 0 ; i < num_threads ; i++)
+		threads.emplace_back(worker);
+
+	auto stop_workers = [&]()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			abort = true;
+		}
+		cv.notify_all();
+
+		for (std::thread& t : threads)
+			t.join();
+	};
+
+	try
+	{
+		for (size_t b = 0 ; b < num_blocks ; b++)
+		{
+			slot& s = slots[b % window];
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cv.wait(lock, [&]() { return s.ready || abort; });
+
+				if (error)
+					std::rethrow_exception(error);
+			}
+
+			consume(b, s.result);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				s.ready = false;
+				consumed = b + 1;
+			}
+			cv.notify_all();
+		}
+	}
+	catch (...)
+	{
+		stop_workers();
+		throw;
+	}
+
+	stop_workers();
+}
+
+/** Sorts v with cmp on num_threads threads (0 for the default).
+ *  The vector is cut into one run per thread, the runs are sorted concurrently
+ *  and then merged pairwise, a level at a time. Needs a scratch copy of v.
+ *  Not stable.
+ *
+ *  If cancel is given, the sort stops soon after it's set and leaves v in no
+ *  particular order.
+ */
+template <typename T, typename Compare>
+void ParallelSort(std::vector<T>& v, Compare cmp, unsigned num_threads, const std::atomic<bool>* cancel = nullptr)
+{
+	auto sort = [&v, num_threads](auto compare)
+	{
+		const size_t min_run_size = 1 << 14;
+
+		const size_t n = v.size();
+		size_t num_runs = std::max<size_t>(1, std::min<size_t>(ResolveThreadCount(num_threads), n / min_run_size));
+
+		if (num_runs == 1)
+		{
+			std::sort(v.begin(), v.end(), compare);
+			return;
+		}
+
+		std::vector<size_t> bounds(num_runs + 1);
+		for (size_t i = 0 ; i <= num_runs ; i++)
+			bounds[i] = (n * i) / num_runs;
+
+		ParallelFor(0, num_runs, (unsigned) num_runs,
+			[&](size_t begin, size_t end, size_t)
+			{
+				for (size_t r = begin ; r < end ; r++)
+					std::sort(v.begin() + bounds[r], v.begin() + bounds[r + 1], compare);
+			});
+
+		std::vector<T> scratch(n);
+		std::vector<T>* src = &v;
+		std::vector<T>* dst = &scratch;
+
+		while (num_runs > 1)
+		{
+			const size_t num_merged = (num_runs + 1) / 2;
+
+			ParallelFor(0, num_merged, (unsigned) num_merged,
+				[&](size_t begin, size_t end, size_t)
+				{
+					for (size_t m = begin ; m < end ; m++)
+					{
+						const size_t first = bounds[2 * m];
+						const size_t middle = bounds[std::min(2 * m + 1, num_runs)];
+						const size_t last = bounds[std::min(2 * m + 2, num_runs)];
+
+						std::merge(	src->begin() + first, src->begin() + middle,
+									src->begin() + middle, src->begin() + last,
+									dst->begin() + first, compare);
+					}
+				});
+
+			std::vector<size_t> merged_bounds(num_merged + 1);
+			for (size_t m = 0 ; m <= num_merged ; m++)
+				merged_bounds[m] = bounds[std::min(2 * m, num_runs)];
+
+			bounds.swap(merged_bounds);
+			num_runs = num_merged;
+			std::swap(src, dst);
+		}
+
+		if (src != &v)
+			v.swap(*src);
+	};
+
+	if (!cancel)
+	{
+		sort(cmp);
+		return;
+	}
+
+	// Unwind out of the sorts and merges from the comparison that sees the flag
+	struct sort_canceled { };
+
+	try
+	{
+		sort(
+			[&cmp, cancel](const T& a, const T& b)
+			{
+				if (cancel->load(std::memory_order_relaxed))
+					throw sort_canceled();
+
+				return cmp(a, b);
+			});
+	}
+	catch (sort_canceled&)
+	{
+
+	}
+}
+
+#endif /* PARALLEL_H_ */
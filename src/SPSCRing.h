@@ -0,0 +1,96 @@
+/*
+ * SPSCRing.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef SPSCRING_H_
+#define SPSCRING_H_
+
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/** A bounded, lock-free, single-producer / single-consumer ring buffer.
+ *  Exactly one thread may call TryPush() and exactly one (other) thread
+ *  may call TryPop().
+ */
+template <typename T>
+class SPSCRing
+{
+private:
+	std::vector<T>		m_slots;
+	const size_t		m_mask;
+
+	// Keep the producer and consumer indices on separate cache lines
+	alignas(64) std::atomic<size_t>	m_head;	///< Next slot to pop, written by the consumer
+	alignas(64) std::atomic<size_t>	m_tail;	///< Next slot to push, written by the producer
+
+	static size_t round_up_pow2(size_t n)
+	{
+		size_t p = 1;
+		while (p < n)
+			p <<= 1;
+
+		return p;
+	}
+
+public:
+	/** Constructor.
+	 *  @param capacity	The minimum number of elements the ring can hold.
+	 *  				Rounded up to a power of two.
+	 */
+	explicit SPSCRing(size_t capacity)
+	: m_slots(round_up_pow2(capacity))
+	, m_mask(m_slots.size() - 1)
+	, m_head(0)
+	, m_tail(0)
+	{
+
+	}
+
+	SPSCRing(const SPSCRing&) = delete;
+	SPSCRing& operator=(const SPSCRing&) = delete;
+
+	size_t Capacity() const { return m_slots.size(); }
+
+	/** Moves value into the ring. Producer thread only.
+	 *  @returns false if the ring is full (value is left alone)
+	 */
+	bool TryPush(T& value)
+	{
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == m_slots.size())
+			return false;
+
+		m_slots[tail & m_mask] = std::move(value);
+		m_tail.store(tail + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/** Moves the oldest element out of the ring into value. Consumer thread only.
+	 *  @returns false if the ring is empty
+	 */
+	bool TryPop(T& value)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+
+		value = std::move(m_slots[head & m_mask]);
+		m_head.store(head + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/** True if there was nothing in the ring at the time of the call */
+	bool Empty() const
+	{
+		return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+	}
+};
+
+#endif /* SPSCRING_H_ */
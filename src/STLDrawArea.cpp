@@ -7,10 +7,20 @@
 
 #include "STLDrawArea.h"
 #include "DisplayObject.h"
-#include "triangle_mesh.h"
+#include "MeshGeometry.h"
+#include "MeshBuffers.h"
+#include "MeshSimplifier.h"
+#include "WorkerPool.h"
+#include "FrameStats.h"
+#include "ViewSetup.h"
 
 #include <boost/math/constants/constants.hpp>
 
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+
 #include <assert.h>
 
 using Glib::RefPtr;
@@ -23,12 +33,65 @@ using maths::vector3d;
 using std::shared_ptr;
 using std::make_shared;
 
+namespace
+{
+	/** How long each main loop iteration may spend uploading, so the GUI keeps up */
+	const double UPLOAD_BUDGET_MS = 8.0;
+
+	/** Uploads go in slices of this many bytes, checking the budget in between */
+	const size_t UPLOAD_SLICE_BYTES = 1 << 20;
+
+	const unsigned UPLOAD_INTERVAL_MS = 10;
+
+	const GLint DEFAULT_MAX_ELEMENTS = 1 << 16;
+
+	/** Parts with fewer facets are always drawn at full detail */
+	const size_t LOD_MIN_FACETS = 500000;
+
+	/** How far (in pixels) a level of detail may be off for it to be drawn */
+	const double LOD_MAX_PIXEL_ERROR = 1.0;
+
+	/** How long a frame may take while the view is dragged */
+	const double DRAG_FRAME_BUDGET_MS = 30.0;
+
+	/** The range the proxy size is adjusted in, in facets */
+	const size_t MIN_PROXY_FACETS = 10000;
+	const size_t MAX_PROXY_FACETS = 2000000;
+
+	const unsigned DEFAULT_SETTLE_MS = 200;
+
+	/** The shortest time between frames. GTK can't tell us the display's refresh rate,
+	 *  so this assumes 60 Hz; drawing faster would only make the input lag.
+	 */
+	const unsigned FRAME_INTERVAL_MS = 16;
+
+	/** Scheduled frames run after input and resizing are handled, like GTK's own redraws */
+	const int REDRAW_PRIORITY = Glib::PRIORITY_HIGH_IDLE + 20;
+
+	/** The frame statistics' font, and its line spacing if Pango can't say */
+	const char* const OVERLAY_FONT = "Monospace 9";
+	const int DEFAULT_OVERLAY_LINE_HEIGHT = 14;
+};
 
 
 STLDrawArea::STLDrawArea()
 : m_is_dragging(false)
 , m_zoom_factor(1.0f)
+, m_interacting(false)
+, m_settle_ms(DEFAULT_SETTLE_MS)
+, m_proxy_facets(MAX_PROXY_FACETS / 4)
 , m_enable_back_face_cull(true)
+, m_renderer(RENDERER_BUFFERS)
+, m_buffers_supported(false)
+, m_log_draw_times(false)
+, m_show_frame_stats(false)
+, m_font_base(0)
+, m_font_line_height(DEFAULT_OVERLAY_LINE_HEIGHT)
+, m_max_elements_indices(DEFAULT_MAX_ELEMENTS)
+, m_max_elements_vertices(DEFAULT_MAX_ELEMENTS)
+, m_feature_angle(0.0)
+, m_show_edges(true)
+, m_pixels_per_unit(0.0)
 {
 	// Initialize a double-buffered RGB visual
 	const Gdk::GL::ConfigMode mode = Gdk::GL::MODE_RGB | Gdk::GL::MODE_DEPTH | Gdk::GL::MODE_DOUBLE;
@@ -41,25 +104,454 @@ STLDrawArea::STLDrawArea()
 		throw std::runtime_error("Could not enable GL capability for Drawable widget!");
 
 	// Set up events for mouse-down, mouse-up, mouse movement, and mouse scroll
-	add_events(Gdk::BUTTON_PRESS_MASK | Gdk::BUTTON_RELEASE_MASK | Gdk::POINTER_MOTION_MASK | Gdk::SCROLL_MASK);
+	// Motion hints send one motion event until we next ask where the pointer is,
+	// so motion doesn't queue up behind slow frames
+	add_events(Gdk::BUTTON_PRESS_MASK | Gdk::BUTTON_RELEASE_MASK | Gdk::POINTER_MOTION_MASK | Gdk::POINTER_MOTION_HINT_MASK |
+			   Gdk::SCROLL_MASK);
+}
+
+STLDrawArea::~STLDrawArea()
+{
+	cancel_pending_parts();
+	m_settle_connection.disconnect();
+	m_redraw_connection.disconnect();
 }
 
-void STLDrawArea::InitMeshDO(const shared_ptr<triangle_mesh>& mesh, bool include_edges)
+void STLDrawArea::InitMeshDO(const shared_ptr<const MeshGeometry>& geometry, bool include_edges)
 {
+	InitSceneDO();
+	AddScenePart(geometry, include_edges);
+}
+
+void STLDrawArea::InitSceneDO()
+{
+	cancel_pending_parts();
+
 	m_zoom_factor = 1.0f;
 
+	m_preview_do.reset();
+	m_saved_do.reset();
+
 	glShadeModel(GL_SMOOTH);
 
+	m_scene_do = make_shared<SceneDisplayObject>();
+	m_mesh_do = m_scene_do;
+}
+
+void STLDrawArea::AddScenePart(const shared_ptr<const MeshGeometry>& geometry, bool include_edges)
+{
+	if (!m_scene_do)
+		InitSceneDO();
+
+	RefPtr<Drawable> gl_drawable = get_gl_drawable();
+	gl_drawable->gl_begin(get_gl_context());
+
+	m_show_edges = include_edges;
+
+	// Only the new part gets built
+	auto part_do = m_renderer == RENDERER_BUFFERS && m_buffers_supported ?
+		create_buffered_part_do(geometry, include_edges) : create_part_do(geometry, include_edges, m_feature_angle);
+
+	m_scene_do->AddChild(part_do);
+
+	gl_drawable->gl_end();
+
+	m_zoom_factor = 1.0f;
+	CenterView();
+}
+
+void STLDrawArea::ShowEdges(bool show_edges)
+{
+	m_show_edges = show_edges;
+
+	if (!m_scene_do)
+		return;
+
+	for (const auto& edges_do : get_edges_dos())
+		edges_do->Suppressed() = !show_edges;
+
+	Redraw();
+}
+
+void STLDrawArea::SetFeatureAngle(double feature_angle)
+{
+	m_feature_angle = feature_angle;
+
+	if (!m_scene_do)
+		return;
+
+	RefPtr<Drawable> gl_drawable = get_gl_drawable();
+	gl_drawable->gl_begin(get_gl_context());
+
+	for (const auto& edges_do : get_edges_dos())
+		edges_do->SetFeatureAngle(feature_angle);
+
+	gl_drawable->gl_end();
+
+	Redraw();
+}
+
+//static
+shared_ptr<DisplayObject> STLDrawArea::create_part_do(const shared_ptr<const MeshGeometry>& geometry, bool include_edges,
+													  double feature_angle)
+{
 	// TODO - selectable color
 	//const GLfloat green[] = {0.0, 0.8, 0.2, 1.0};	// TODO - adjustable alpha
 
-	m_mesh_do = make_shared<MeshDisplayObject>(mesh);
+	auto part_do = make_shared<MeshDisplayObject>(geometry);
 
-	auto edges_do = make_shared<MeshEdgesDisplayObject>(mesh);
+	auto edges_do = make_shared<MeshEdgesDisplayObject>(geometry);
 	edges_do->Suppressed() = !include_edges;
+	edges_do->EdgesDisplayObject::SetFeatureAngle(feature_angle);	// not built yet
 
-	m_mesh_do->AddChild(edges_do);
-	m_mesh_do->BuildDisplayLists();
+	part_do->AddChild(edges_do);
+	part_do->BuildDisplayLists();
+
+	return part_do;
+}
+
+STLDrawArea::pending_part STLDrawArea::make_pending_part(const shared_ptr<const MeshGeometry>& geometry, bool include_edges) const
+{
+	pending_part part;
+	part.faces_do = make_shared<MeshBufferDisplayObject>(geometry, m_buffer_program);
+	part.edges_do = make_shared<MeshEdgesBufferDisplayObject>(geometry);
+	part.edges_do->Suppressed() = !include_edges;
+	part.edges_do->SetFeatureAngle(m_feature_angle);
+	part.faces_do->AddChild(part.edges_do);
+
+	part.build = make_shared<pending_part::build_state>();
+	part.build->geometry = geometry;
+	part.build->done = false;
+	part.build->cancel = false;
+	part.staged = false;
+	part.num_slices = 0;
+	part.longest_slice_ms = 0.0;
+	part.lod_level = 0;
+	part.lod_error = 0.0;
+
+	return part;
+}
+
+shared_ptr<DisplayObject> STLDrawArea::create_buffered_part_do(const shared_ptr<const MeshGeometry>& geometry, bool include_edges)
+{
+	pending_part part = make_pending_part(geometry, include_edges);
+
+	// Large parts get simplified once they're showing
+	if (geometry->NumFacets() >= LOD_MIN_FACETS)
+		part.lod_do = make_shared<LODDisplayObject>(part.faces_do);
+
+	if (!m_build_pool)
+		m_build_pool.reset(new WorkerPool);
+
+	// The worker only gets the build, so it never holds the last reference to a display object
+	const size_t max_indices = (size_t) m_max_elements_indices;
+	const size_t max_vertices = (size_t) m_max_elements_vertices;
+	shared_ptr<pending_part::build_state> build = part.build;
+	m_build_pool->Submit(
+		[build, max_indices, max_vertices]()
+		{
+			auto const build_start = std::chrono::steady_clock::now();
+
+			try
+			{
+				build->buffers = make_shared<MeshBuffers>(MeshBuffers::Build(*build->geometry, max_indices, max_vertices, &build->cancel));
+
+				std::chrono::duration<double, std::milli> const build_time = std::chrono::steady_clock::now() - build_start;
+				if (!build->cancel.load())
+				{
+					std::clog	<< "Built buffers for " << build->geometry->NumFacets() << " facets: "
+								<< build->buffers->vertices.size() << " vertices, " << build->buffers->chunks.size() << " draw calls, "
+								<< std::fixed << std::setprecision(1) << build->buffers->SizeBytes() / (1024.0 * 1024.0)
+								<< " MB in " << build_time.count() << " ms, ACMR " << std::setprecision(2)
+								<< build->buffers->acmr << " (was " << build->buffers->unoptimized_acmr << ")" << std::endl;
+				}
+			}
+			catch (std::exception& ex)
+			{
+				// No buffers, on_upload_timeout() takes the part back out of the scene
+				std::clog << "Couldn't build buffers for " << build->geometry->NumFacets() << " facets: " << ex.what() << std::endl;
+				build->buffers.reset();
+			}
+
+			build->done.store(true, std::memory_order_release);
+		});
+
+	m_pending_parts.push_back(part);
+
+	if (!m_upload_connection.connected())
+		m_upload_connection = Glib::signal_timeout().connect(sigc::mem_fun(*this, &STLDrawArea::on_upload_timeout), UPLOAD_INTERVAL_MS);
+
+	if (part.lod_do)
+		return part.lod_do;
+
+	return part.faces_do;
+}
+
+void STLDrawArea::start_lod_build(const shared_ptr<LODDisplayObject>& lod_do, const shared_ptr<const MeshGeometry>& geometry)
+{
+	pending_lod lod;
+	lod.lod_do = lod_do;
+	lod.num_levels = 0;
+	lod.build = make_shared<pending_lod::build_state>();
+	lod.build->geometry = geometry;
+	lod.build->done = false;
+	lod.build->cancel = false;
+
+	// Like the part's buffers, the worker only gets the build
+	const size_t max_indices = (size_t) m_max_elements_indices;
+	const size_t max_vertices = (size_t) m_max_elements_vertices;
+	shared_ptr<pending_lod::build_state> build = lod.build;
+	m_build_pool->Submit(
+		[build, max_indices, max_vertices]()
+		{
+			auto const build_start = std::chrono::steady_clock::now();
+
+			try
+			{
+				MeshSimplifier().BuildLevels(*build->geometry,
+					[&](MeshSimplifier::Level&& level)
+					{
+						auto buffers = make_shared<MeshBuffers>(MeshBuffers::Build(*level.geometry, max_indices, max_vertices, &build->cancel));
+						if (build->cancel.load())
+							return;
+
+						std::chrono::duration<double> const build_time = std::chrono::steady_clock::now() - build_start;
+						std::clog	<< "Built a level of detail with " << level.geometry->NumFacets() << " of "
+									<< build->geometry->NumFacets() << " facets, error " << level.error << ", after "
+									<< std::fixed << std::setprecision(1) << build_time.count() << " s" << std::endl;
+
+						std::lock_guard<std::mutex> lock(build->mutex);
+						build->ready.push_back({ level.geometry, buffers, level.error });
+					},
+					&build->cancel);
+			}
+			catch (std::exception& ex)
+			{
+				// The full detail part is still there
+				std::clog << "Couldn't build levels of detail: " << ex.what() << std::endl;
+			}
+
+			build->done.store(true, std::memory_order_release);
+		});
+
+	m_pending_lods.push_back(lod);
+
+	if (!m_upload_connection.connected())
+		m_upload_connection = Glib::signal_timeout().connect(sigc::mem_fun(*this, &STLDrawArea::on_upload_timeout), UPLOAD_INTERVAL_MS);
+}
+
+void STLDrawArea::collect_lod_levels()
+{
+	for (auto lod_it = m_pending_lods.begin() ; lod_it != m_pending_lods.end() ; )
+	{
+		pending_lod& lod = *lod_it;
+
+		// Look at done first, so no level built before it was set gets left behind
+		const bool done = lod.build->done.load(std::memory_order_acquire);
+
+		std::vector<pending_lod::ready_level> ready;
+		{
+			std::lock_guard<std::mutex> lock(lod.build->mutex);
+			ready.swap(lod.build->ready);
+		}
+
+		for (pending_lod::ready_level& level : ready)
+		{
+			pending_part part = make_pending_part(level.geometry, m_show_edges);
+			part.build->buffers = level.buffers;
+			part.build->done = true;
+			part.lod_do = lod.lod_do;
+			part.lod_level = ++lod.num_levels;
+			part.lod_error = level.error;
+
+			m_pending_parts.push_back(part);
+		}
+
+		if (done)
+			lod_it = m_pending_lods.erase(lod_it);
+		else
+			++lod_it;
+	}
+}
+
+void STLDrawArea::cancel_pending_parts()
+{
+	for (pending_part& part : m_pending_parts)
+		part.build->cancel.store(true);
+
+	for (pending_lod& lod : m_pending_lods)
+		lod.build->cancel.store(true);
+
+	if (m_build_pool)
+		m_build_pool->CancelPending();
+
+	m_pending_parts.clear();
+	m_pending_lods.clear();
+	m_upload_connection.disconnect();
+}
+
+std::vector<shared_ptr<EdgesDisplayObject>> STLDrawArea::get_edges_dos() const
+{
+	std::vector<shared_ptr<EdgesDisplayObject>> edges_dos;
+	if (!m_scene_do)
+		return edges_dos;
+
+	for (const auto& part_do : m_scene_do->GetChildren())
+	{
+		std::vector<shared_ptr<DisplayObject>> levels(1, part_do);
+
+		auto lod_do = std::dynamic_pointer_cast<LODDisplayObject>(part_do);
+		if (lod_do)
+		{
+			levels.clear();
+			for (size_t i = 0 ; i < lod_do->NumLevels() ; i++)
+				levels.push_back(lod_do->GetLevel(i));
+		}
+
+		for (const auto& level_do : levels)
+		{
+			for (const auto& child_do : level_do->GetChildren())
+			{
+				auto edges_do = std::dynamic_pointer_cast<EdgesDisplayObject>(child_do);
+				if (edges_do)
+					edges_dos.push_back(edges_do);
+			}
+		}
+	}
+
+	// Levels of detail still uploading aren't in their LODDisplayObject yet
+	for (const pending_part& part : m_pending_parts)
+		if (part.lod_level > 0)
+			edges_dos.push_back(part.edges_do);
+
+	return edges_dos;
+}
+
+bool STLDrawArea::on_upload_timeout()
+{
+	auto const start = std::chrono::steady_clock::now();
+	auto elapsed_ms = [&start]()
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	// The levels' display objects get made here too, so the context goes first
+	RefPtr<Drawable> gl_drawable = get_gl_drawable();
+	gl_drawable->gl_begin(get_gl_context());
+
+	collect_lod_levels();
+
+	if (m_pending_parts.empty())
+	{
+		gl_drawable->gl_end();
+		return !m_pending_lods.empty();
+	}
+
+	bool any_finished = false;
+	for (auto part_it = m_pending_parts.begin() ; part_it != m_pending_parts.end() && elapsed_ms() < UPLOAD_BUDGET_MS ; )
+	{
+		pending_part& part = *part_it;
+		if (!part.build->done.load(std::memory_order_acquire))
+		{
+			++part_it;
+			continue;
+		}
+
+		if (!part.build->buffers)
+		{
+			m_scene_do->RemoveChild(part.lod_do ? shared_ptr<DisplayObject>(part.lod_do) : shared_ptr<DisplayObject>(part.faces_do));
+
+			part_it = m_pending_parts.erase(part_it);
+			any_finished = true;
+			continue;
+		}
+
+		const double slice_start_ms = elapsed_ms();
+
+		if (!part.staged)
+		{
+			part.faces_do->Stage(part.build->buffers);
+			part.edges_do->Stage(part.build->buffers);
+			part.staged = true;
+		}
+
+		bool uploaded = false;
+		while (!uploaded && elapsed_ms() < UPLOAD_BUDGET_MS)
+			uploaded = part.faces_do->Upload(UPLOAD_SLICE_BYTES) && part.edges_do->Upload(UPLOAD_SLICE_BYTES);
+
+		part.num_slices++;
+		part.longest_slice_ms = std::max(part.longest_slice_ms, elapsed_ms() - slice_start_ms);
+
+		if (!uploaded)
+			break;
+
+		std::clog	<< "Uploaded " << part.build->geometry->NumFacets() << " facets over " << part.num_slices
+					<< " main loop iterations, the longest took " << std::fixed << std::setprecision(1)
+					<< part.longest_slice_ms << " ms" << std::endl;
+
+		if (part.lod_do && part.lod_level == 0)
+			start_lod_build(part.lod_do, part.build->geometry);
+		else if (part.lod_do)
+			part.lod_do->AddLevel(part.faces_do, part.lod_error);
+
+		part_it = m_pending_parts.erase(part_it);
+		any_finished = true;
+	}
+
+	gl_drawable->gl_end();
+
+	if (any_finished)
+		Redraw();
+
+	return !m_pending_parts.empty() || !m_pending_lods.empty();
+}
+
+void STLDrawArea::BeginPreview()
+{
+	if (m_preview_do)
+		return;
+
+	RefPtr<Drawable> gl_drawable = get_gl_drawable();
+	gl_drawable->gl_begin(get_gl_context());
+
+	m_saved_do = m_mesh_do;
+	m_scene_do.reset();
+	m_preview_do = make_shared<PreviewDisplayObject>();
+	m_mesh_do = m_preview_do;
+
+	gl_drawable->gl_end();
+}
+
+void STLDrawArea::AppendPreview(const std::vector<float>& corners)
+{
+	if (!m_preview_do || corners.empty())
+		return;
+
+	RefPtr<Drawable> gl_drawable = get_gl_drawable();
+	gl_drawable->gl_begin(get_gl_context());
+
+	m_preview_do->AppendTriangles(corners);
+
+	gl_drawable->gl_end();
+
+	m_zoom_factor = 1.0f;
+	CenterView();
+}
+
+void STLDrawArea::EndPreview()
+{
+	if (!m_preview_do)
+		return;
+
+	m_mesh_do = m_saved_do;
+	m_scene_do = std::dynamic_pointer_cast<SceneDisplayObject>(m_saved_do);
+	m_saved_do.reset();
+	m_preview_do.reset();
+
+	if (m_mesh_do)
+		CenterView();
+	else
+		Redraw();
 }
 
 vector3f STLDrawArea::get_trackball_point(int x, int y) const
@@ -96,6 +588,29 @@ void STLDrawArea::init_gl()
 	glLoadIdentity();
 	glGetFloatv(GL_MODELVIEW_MATRIX, m_obj_rot_matrix);
 
+	m_buffers_supported = MeshBufferDisplayObject::IsSupported();
+	m_buffer_program.reset();
+	if (m_buffers_supported)
+	{
+		try
+		{
+			m_buffer_program = make_shared<MeshBufferProgram>();
+		}
+		catch (std::exception& ex)
+		{
+			std::clog << ex.what() << std::endl;
+			m_buffers_supported = false;
+		}
+	}
+	glGetIntegerv(GL_MAX_ELEMENTS_INDICES, &m_max_elements_indices);
+	glGetIntegerv(GL_MAX_ELEMENTS_VERTICES, &m_max_elements_vertices);
+	if (m_max_elements_indices <= 0)
+		m_max_elements_indices = DEFAULT_MAX_ELEMENTS;
+	if (m_max_elements_vertices <= 0)
+		m_max_elements_vertices = DEFAULT_MAX_ELEMENTS;
+	if (m_renderer == RENDERER_BUFFERS && !m_buffers_supported)
+		std::clog << "OpenGL 2.0 buffer objects and shaders aren't available, using display lists" << std::endl;
+
 	assert(glGetError() == GL_NO_ERROR);
 
 	gl_drawable->gl_end();
@@ -108,19 +623,7 @@ void STLDrawArea::setup_lighting()
 	RefPtr<Drawable> gl_drawable = get_gl_drawable();
 	gl_drawable->gl_begin(get_gl_context());
 
-	GLfloat mat_ambient_diff[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-	glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, mat_ambient_diff);
-	glColorMaterial(GL_FRONT, GL_AMBIENT_AND_DIFFUSE);
-	glEnable(GL_COLOR_MATERIAL);
-
-	GLfloat light_position_1[] = { 5.0f, 5.0f, 10.0f, 1.0f };
-	GLfloat light_position_2[] = { 0.0f, 10.0f, 0.0f, 1.0f };
-	glLightfv(GL_LIGHT0, GL_POSITION, light_position_1);
-	glLightfv(GL_LIGHT1, GL_POSITION, light_position_2);
-
-	glEnable(GL_LIGHTING);
-	glEnable(GL_LIGHT0);
-	glEnable(GL_DEPTH_TEST);
+	ViewSetup::SetupLighting();
 
 	assert(glGetError() == GL_NO_ERROR);
 
@@ -132,49 +635,80 @@ void STLDrawArea::resize(GLuint width, GLuint height)
 	RefPtr<Drawable> gl_drawable = get_gl_drawable();
 	gl_drawable->gl_begin(get_gl_context());
 
-	const GLfloat aspect = (GLfloat) width / (GLfloat) height;
-	glViewport(0, 0, width, height);
+	// Also for picking levels of detail
+	m_pixels_per_unit = ViewSetup::LoadProjection(get_mesh_bbox(), m_camera.GetViewDistance(), m_zoom_factor, width, height);
 
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
+	assert(glGetError() == GL_NO_ERROR);
 
-	const maths::bbox3d mesh_bbox = get_mesh_bbox();
+	gl_drawable->gl_end();
+}
 
-	const double c_x = mesh_bbox.is_empty() ? 0.0 : mesh_bbox.center().x();
-	const double c_y = mesh_bbox.is_empty() ? 0.0 : mesh_bbox.center().y();
-	const double diam = mesh_bbox.is_empty() ? 1.0 : mesh_bbox.max_extent();
-	double left = c_x - diam;
-	double right = c_x + diam;
-	double bottom = c_y - diam;
-	double top = c_y + diam;
+void STLDrawArea::Redraw()
+{
+	if (m_redraw_connection.connected())
+		return;
 
-	const double z_near = -2.0 * (m_camera.GetViewDistance() + diam);
-	const double z_far = 2.0 * (m_camera.GetViewDistance() + diam);
+	// Wait out the rest of the frame interval since the last frame
+	const double since_last_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_last_frame).count();
+	const unsigned delay_ms = since_last_ms >= FRAME_INTERVAL_MS ? 0 : (unsigned) std::ceil(FRAME_INTERVAL_MS - since_last_ms);
 
-	if (aspect < 1.0)
-	{
-		bottom /= aspect;
-		top /= aspect;
-	}
-	else
-	{
-		left *= aspect;
-		right *= aspect;
-	}
+	m_redraw_connection = Glib::signal_timeout().connect(sigc::mem_fun(*this, &STLDrawArea::on_redraw_timeout),
+														 delay_ms, REDRAW_PRIORITY);
+}
 
-	//const float view_dist = m_camera.GetViewDistance() == 0.0 ? 1.0 : m_camera.GetViewDistance();
-	glOrtho(m_zoom_factor * left, m_zoom_factor * right, m_zoom_factor * bottom, m_zoom_factor * top, z_near, z_far);
+bool STLDrawArea::on_redraw_timeout()
+{
+	// The connection is done with once this returns
+	m_redraw_connection = sigc::connection();
 
-	assert(glGetError() == GL_NO_ERROR);
+	if (is_realized())
+		draw_frame();
 
-	gl_drawable->gl_end();
+	return false;
 }
 
-void STLDrawArea::Redraw()
+void STLDrawArea::ShowFrameStats(bool show_frame_stats)
+{
+	m_show_frame_stats = show_frame_stats;
+
+	Redraw();
+}
+
+void STLDrawArea::init_overlay_font()
+{
+	m_font_base = glGenLists(128);
+	if (m_font_base == 0)
+		return;
+
+	RefPtr<Pango::Font> font = Gdk::GL::Font::use_pango_font(Pango::FontDescription(OVERLAY_FONT), 0, 128, m_font_base);
+	if (!font)
+	{
+		std::clog << "Couldn't load the font " << OVERLAY_FONT << " for the frame statistics" << std::endl;
+		return;
+	}
+
+	const Pango::FontMetrics metrics = font->get_metrics();
+	m_font_line_height = std::max(DEFAULT_OVERLAY_LINE_HEIGHT, (metrics.get_ascent() + metrics.get_descent()) / PANGO_SCALE + 2);
+}
+
+void STLDrawArea::draw_frame()
 {
+	m_last_frame = std::chrono::steady_clock::now();
+
 	RefPtr<Drawable> gl_drawable = get_gl_drawable();
 	gl_drawable->gl_begin(get_gl_context());
 
+	// Only timed when someone's looking, though it costs next to nothing
+	const bool timed = m_show_frame_stats || m_log_draw_times;
+	if (timed)
+	{
+		if (!m_frame_stats)
+			m_frame_stats.reset(new FrameStats);
+
+		m_frame_stats->BeginFrame();
+		DisplayObject::TakeSubmitted();
+	}
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glClearColor(1.0, 1.0, 1.0, 1.0);
 
@@ -191,31 +725,109 @@ void STLDrawArea::Redraw()
 	glPushMatrix();
 	glMultMatrixf(m_obj_rot_matrix);
 
+	if (m_scene_do)
+	{
+		for (const auto& part_do : m_scene_do->GetChildren())
+		{
+			auto lod_do = std::dynamic_pointer_cast<LODDisplayObject>(part_do);
+			if (lod_do)
+				lod_do->SelectLevel(m_pixels_per_unit, LOD_MAX_PIXEL_ERROR);
+		}
+	}
+
+	auto const draw_start = std::chrono::steady_clock::now();
+	if (timed)
+		m_frame_stats->BeginPhase(FrameStats::PHASE_DRAW);
+
 	// TODO - move obj rot matrix to DisplayObject::Draw
-	if (m_mesh_do)
+	if (m_mesh_do && m_interacting)
+		m_mesh_do->DrawProxy(m_proxy_facets);
+	else if (m_mesh_do)
 		m_mesh_do->Draw();
 
+	// Drag frames always wait for the GL, so the proxy size follows what the frames
+	// really cost, and frames don't queue up behind the mouse
+	if ((m_log_draw_times || m_interacting) && m_mesh_do)
+	{
+		glFinish();
+
+		std::chrono::duration<double, std::milli> const draw_time = std::chrono::steady_clock::now() - draw_start;
+		if (m_interacting)
+			adapt_proxy_size(draw_time.count());
+	}
+
 	glPopMatrix();
 
 	if (m_enable_back_face_cull)
 		glDisable(GL_CULL_FACE);
 
+	const DisplayObject::Submitted submitted = DisplayObject::TakeSubmitted();
+
+	// The overlay shows the frame before this one, the last that's complete
+	if (timed)
+		m_frame_stats->BeginPhase(FrameStats::PHASE_OVERLAY);
+
+	if (m_show_frame_stats)
+	{
+		if (m_font_base == 0)
+			init_overlay_font();
+
+		if (m_font_base != 0)
+			m_frame_stats->DrawOverlay(get_width(), get_height(), m_font_base, m_font_line_height);
+	}
+
 	assert(glGetError() == GL_NO_ERROR);
 
+	if (timed)
+		m_frame_stats->BeginPhase(FrameStats::PHASE_SWAP);
+
 	gl_drawable->swap_buffers();
+
+	if (timed)
+	{
+		// Logging waits for the GPU time anyway, as it already waits for the GL to finish
+		m_frame_stats->EndFrame(submitted.triangles, submitted.lines, submitted.points, m_log_draw_times);
+		if (m_log_draw_times && m_mesh_do)
+			m_frame_stats->LogLastFrame(std::clog, m_interacting ? "proxy" : "scene");
+	}
+
 	gl_drawable->gl_end();
 }
 
+void STLDrawArea::begin_interaction()
+{
+	m_settle_connection.disconnect();
+	m_interacting = true;
+}
+
+bool STLDrawArea::on_settle_timeout()
+{
+	m_interacting = false;
+	Redraw();
+
+	return false;
+}
+
+void STLDrawArea::adapt_proxy_size(double frame_ms)
+{
+	if (frame_ms > DRAG_FRAME_BUDGET_MS)
+	{
+		// Shrink straight to what should fit, with a little to spare
+		const double scale = 0.8 * DRAG_FRAME_BUDGET_MS / frame_ms;
+		m_proxy_facets = std::max(MIN_PROXY_FACETS, (size_t) (scale * m_proxy_facets));
+	}
+	else if (frame_ms < 0.5 * DRAG_FRAME_BUDGET_MS)
+	{
+		// Grow slowly, so it doesn't overshoot
+		m_proxy_facets = std::min(MAX_PROXY_FACETS, m_proxy_facets + m_proxy_facets / 4);
+	}
+}
+
 void STLDrawArea::CenterView()
 {
 	assert(!get_mesh_bbox().is_empty());
 
-	const vector3d mesh_c = get_mesh_bbox().center();
-	const double diam = std::max(get_mesh_bbox().extent_x(), get_mesh_bbox().extent_y());
-
-	vector3f origin(0.0f, 0.0f, 2 * diam);
-	vector3f view_dir((float) mesh_c.x(), (float) mesh_c.y(), (float) mesh_c.z());
-	m_camera.LookAt(origin, view_dir, vector3f(0.0f, 1.0f, 0.0f));
+	ViewSetup::FitCamera(m_camera, get_mesh_bbox());
 
 	resize(get_width(), get_height());
 
@@ -264,7 +876,9 @@ bool STLDrawArea::on_configure_event(GdkEventConfigure* event)
 
 bool STLDrawArea::on_expose_event(GdkEventExpose* event)
 {
-	Redraw();
+	// GDK has already merged the exposes, and the window needs its contents now
+	m_redraw_connection.disconnect();
+	draw_frame();
 
 	return true;
 }
@@ -285,6 +899,9 @@ bool STLDrawArea::on_button_press_event(GdkEventButton* event)
 		default:
 			m_is_dragging = false;
 		}
+
+		if (m_is_dragging)
+			begin_interaction();
 	}
 
 	return true;
@@ -293,8 +910,13 @@ bool STLDrawArea::on_button_press_event(GdkEventButton* event)
 bool STLDrawArea::on_button_release_event(GdkEventButton* event)
 {
 	if (event->type == GDK_BUTTON_RELEASE && (event->button == 1 || event->button == 3))
+	{
 		m_is_dragging = false;
 
+		m_settle_connection.disconnect();
+		m_settle_connection = Glib::signal_timeout().connect(sigc::mem_fun(*this, &STLDrawArea::on_settle_timeout), m_settle_ms);
+	}
+
 	return true;
 }
 
@@ -303,13 +925,20 @@ bool STLDrawArea::on_motion_notify_event(GdkEventMotion* event)
 	if (!m_is_dragging)
 		return true;
 
-	if (event->state & Gdk::BUTTON3_MASK)
+	// Only the latest position matters, and asking for it asks for the next hint
+	int x = (int) event->x;
+	int y = (int) event->y;
+	Gdk::ModifierType state = (Gdk::ModifierType) event->state;
+	if (event->is_hint)
+		get_window()->get_pointer(x, y, state);
+
+	if (state & Gdk::BUTTON3_MASK)
 	{
-		const vector2f cur_drag_point = get_drag_point((int) event->x, (int) event->y);
+		const vector2f cur_drag_point = get_drag_point(x, y);
 		const vector2f dxy = (cur_drag_point - m_last_drag_pt);
 		const float zoom_sensitivity = 5.0f;
 
-		if (event->state & Gdk::CONTROL_MASK)
+		if (state & Gdk::CONTROL_MASK)
 			camera_zoom(dxy.y() * zoom_sensitivity);
 		else
 			camera_pan(dxy * m_camera.GetViewDistance());
@@ -319,7 +948,7 @@ bool STLDrawArea::on_motion_notify_event(GdkEventMotion* event)
 		return true;
 	}
 
-	const vector3f cur_track_pt = get_trackball_point((int) event->x, (int) event->y);
+	const vector3f cur_track_pt = get_trackball_point(x, y);
 	const vector3f dv = cur_track_pt - m_last_track_pt;
 
 	vector3f rot_axis = m_last_track_pt % cur_track_pt;
@@ -9,6 +9,10 @@
 #define STLDRAWAREA_H_
 
 #include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
 
 #include <gtkglmm.h>
 #include <gdkmm.h>
@@ -20,12 +24,29 @@
 
 #include "GLCamera.h"
 
-class triangle_mesh;
+struct MeshGeometry;
 class mesh_facet;
+struct MeshBuffers;
 class DisplayObject;
+class PreviewDisplayObject;
+class SceneDisplayObject;
+class MeshBufferDisplayObject;
+class MeshBufferProgram;
+class MeshEdgesBufferDisplayObject;
+class EdgesDisplayObject;
+class LODDisplayObject;
+class WorkerPool;
+class FrameStats;
 
 class STLDrawArea : public Gtk::GL::DrawingArea
 {
+public:
+	enum Renderer
+	{
+		RENDERER_BUFFERS,		///< Vertex and index buffer objects, if the GL has them
+		RENDERER_DISPLAY_LISTS	///< Immediate mode compiled into display lists
+	};
+
 private:
 	// Rotation state
 	bool			m_is_dragging;
@@ -35,26 +56,174 @@ private:
 	GLfloat			m_zoom_factor;
 	GLCamera		m_camera;
 
+	// Drawing a proxy while the view is dragged
+	bool				m_interacting;		// From a button press until the input settles after the release
+	unsigned			m_settle_ms;
+	size_t				m_proxy_facets;		// Adjusted to keep drag frames within the budget
+	sigc::connection	m_settle_connection;
+
+	// Redraw() only schedules a frame, so input between frames is coalesced into one
+	sigc::connection						m_redraw_connection;
+	std::chrono::steady_clock::time_point	m_last_frame;
+
 	bool			m_enable_back_face_cull;
 
+	Renderer		m_renderer;
+	bool			m_buffers_supported;	// Set once the GL context exists
+	std::shared_ptr<const MeshBufferProgram>	m_buffer_program;	// Shared by every MeshBufferDisplayObject
+	bool			m_log_draw_times;
+	bool			m_show_frame_stats;
+	std::unique_ptr<FrameStats>	m_frame_stats;	// Made by the first frame that's timed
+	GLuint			m_font_base;		// Display lists for the overlay's font, 0 until it's needed
+	int				m_font_line_height;
+	GLint			m_max_elements_indices;		// Set once the GL context exists
+	GLint			m_max_elements_vertices;
+	double			m_feature_angle;	// 0 to show all the edges
+	bool			m_show_edges;
+	double			m_pixels_per_unit;	// Model units to screen pixels, set by resize()
+
 	std::shared_ptr<DisplayObject>	m_mesh_do;
+	std::shared_ptr<SceneDisplayObject>	m_scene_do;	// m_mesh_do, unless we're previewing
+
+	// Progressive display while a mesh is loading
+	std::shared_ptr<PreviewDisplayObject>	m_preview_do;
+	std::shared_ptr<DisplayObject>			m_saved_do;	// m_mesh_do from before BeginPreview()
+
+	/** A part whose buffers are being built on a worker, then uploaded a slice at a time */
+	struct pending_part
+	{
+		/** Shared with the worker, which never touches the display objects */
+		struct build_state
+		{
+			std::shared_ptr<const MeshGeometry>	geometry;
+			std::shared_ptr<MeshBuffers>		buffers;
+			std::atomic<bool>					done;
+			std::atomic<bool>					cancel;
+		};
+
+		std::shared_ptr<build_state>					build;
+		std::shared_ptr<MeshBufferDisplayObject>		faces_do;
+		std::shared_ptr<MeshEdgesBufferDisplayObject>	edges_do;
+		bool											staged;
+		size_t											num_slices;
+		double											longest_slice_ms;
+
+		std::shared_ptr<LODDisplayObject>				lod_do;		// The part's levels of detail, if it has them
+		size_t											lod_level;	// Which one this is, 0 for full detail
+		double											lod_error;
+	};
+
+	/** The levels of detail of a part, being simplified on a worker */
+	struct pending_lod
+	{
+		/** A level whose buffers are built, ready to upload */
+		struct ready_level
+		{
+			std::shared_ptr<const MeshGeometry>	geometry;
+			std::shared_ptr<MeshBuffers>		buffers;
+			double								error;
+		};
+
+		/** Shared with the worker */
+		struct build_state
+		{
+			std::shared_ptr<const MeshGeometry>	geometry;
+			std::mutex							mutex;
+			std::vector<ready_level>			ready;	// Guarded by mutex
+			std::atomic<bool>					done;
+			std::atomic<bool>					cancel;
+		};
+
+		std::shared_ptr<build_state>		build;
+		std::shared_ptr<LODDisplayObject>	lod_do;
+		size_t								num_levels;
+	};
+
+	std::unique_ptr<WorkerPool>	m_build_pool;
+	std::vector<pending_part>	m_pending_parts;
+	std::vector<pending_lod>	m_pending_lods;
+	sigc::connection			m_upload_connection;
 
 public:
 	STLDrawArea();
-	virtual ~STLDrawArea() { }
+	virtual ~STLDrawArea();
 
 	// Creates a GL display list for the given mesh
-	void InitMeshDO(const std::shared_ptr<triangle_mesh>& mesh, bool include_edges);
+	void InitMeshDO(const std::shared_ptr<const MeshGeometry>& geometry, bool include_edges);
 	std::shared_ptr<DisplayObject> GetDisplayObject() { return m_mesh_do; }
 
+	/** Replaces whatever is shown with an empty scene, for AddScenePart() to fill in.
+	 *  Ends any preview.
+	 */
+	void InitSceneDO();
+
+	/** Adds one part to the scene, fits the view to the whole scene and redraws.
+	 *  Parts keep their file coordinates relative to each other.
+	 *  With buffer objects, the part's buffers are built on a worker thread and uploaded
+	 *  in slices from the main loop, so the part shows up a little later. Large parts
+	 *  then get coarser levels of detail, built the same way, and each Redraw() draws
+	 *  the coarsest level that's within a pixel of the full detail surface.
+	 */
+	void AddScenePart(const std::shared_ptr<const MeshGeometry>& geometry, bool include_edges);
+
+	/** Shows or hides the edges of every part */
+	void ShowEdges(bool show_edges);
+
+	/** Only shows the edges whose facets meet at more than feature_angle degrees
+	 *  (and boundary and non-manifold edges), or all of them if it's 0. Redraws.
+	 */
+	void SetFeatureAngle(double feature_angle);
+
 	bool HasMeshDO() const { return !!m_mesh_do; }
 
-	void Redraw();		///< Redraws the view
+	/** Starts showing a mesh that is still loading.
+	 *  The current display object is put aside until EndPreview() or InitMeshDO().
+	 */
+	void BeginPreview();
+
+	/** Adds triangles to the loading mesh, fits the view to everything so far and redraws.
+	 *  @param corners	Nine floats (three x, y, z corners) per triangle
+	 */
+	void AppendPreview(const std::vector<float>& corners);
+
+	/** Stops showing the loading mesh and goes back to what was shown before BeginPreview().
+	 *  InitMeshDO() ends the preview on its own.
+	 */
+	void EndPreview();
+
+	/** Schedules a redraw of the view. However many times it's called, the view is drawn
+	 *  once, after the pending events are handled and at most once per frame interval.
+	 */
+	void Redraw();
 	void CenterView();	///< Centers the view and redraws
 
 	/// Enables / disables back-face culling on next Redraw()
 	bool& BackFaceCullEnabled() { return m_enable_back_face_cull; }
 
+	/** Sets how meshes loaded from now on are drawn.
+	 *  RENDERER_BUFFERS falls back to display lists if the GL doesn't have buffer objects.
+	 */
+	void SetRenderer(Renderer renderer) { m_renderer = renderer; }
+
+	/** Logs how long each phase of each frame takes, its GPU time and what it drew
+	 *  (see FrameStats). This waits for the GL to finish every frame, so it slows drawing down.
+	 */
+	void SetLogDrawTimes(bool log_draw_times) { m_log_draw_times = log_draw_times; }
+
+	/** Shows or hides an overlay with the CPU time of each phase of the last frame, its GPU
+	 *  time (if the GL has timer queries), what it drew, the frame rate and a histogram of
+	 *  recent frame times. Unlike SetLogDrawTimes(), this doesn't slow drawing down. Redraws.
+	 */
+	void ShowFrameStats(bool show_frame_stats);
+	bool FrameStatsShown() const { return m_show_frame_stats; }
+
+	/** While the view is dragged, a cheap proxy is drawn instead of the scene (see
+	 *  DisplayObject::DrawProxy()), sized so each frame takes a bounded time. Once there
+	 *  has been no input for settle_ms after the button is released, the scene is drawn
+	 *  at full quality again.
+	 */
+	void SetSettleTime(unsigned settle_ms) { m_settle_ms = settle_ms; }
+
 protected:
 
 	// Helper function for getting the trackball point given the X, Y screen coordinates
@@ -66,8 +235,55 @@ protected:
 	void setup_lighting();
 	void resize(GLuint width, GLuint height);	// Called from on_expose_event()
 
+	/** Draws the view now and swaps buffers */
+	void draw_frame();
+
+	/** Makes the bitmap font for the frame statistics. Needs the GL context. */
+	void init_overlay_font();
+
+	/** Draws the scheduled frame, from the main loop */
+	bool on_redraw_timeout();
+
 	maths::bbox3d get_mesh_bbox() const;
 
+	/** A mesh display object with its edges as a child, using display lists.
+	 *  Builds the display lists.
+	 */
+	static std::shared_ptr<DisplayObject> create_part_do(const std::shared_ptr<const MeshGeometry>& geometry, bool include_edges,
+														 double feature_angle);
+
+	/** A mesh display object with its edges as a child, using buffer objects.
+	 *  Starts building the buffers in the background.
+	 */
+	std::shared_ptr<DisplayObject> create_buffered_part_do(const std::shared_ptr<const MeshGeometry>& geometry, bool include_edges);
+
+	/** The display objects for geometry whose buffers are (or will be) built, to upload later */
+	pending_part make_pending_part(const std::shared_ptr<const MeshGeometry>& geometry, bool include_edges) const;
+
+	/** Starts simplifying a part whose full detail buffers are uploaded */
+	void start_lod_build(const std::shared_ptr<LODDisplayObject>& lod_do, const std::shared_ptr<const MeshGeometry>& geometry);
+
+	/** Queues the levels of detail that have been built since the last call for uploading */
+	void collect_lod_levels();
+
+	/** Stops building and uploading the pending parts */
+	void cancel_pending_parts();
+
+	/** The edges of every part (and every level of detail, including those still uploading) */
+	std::vector<std::shared_ptr<EdgesDisplayObject>> get_edges_dos() const;
+
+	/** Uploads pending parts for a few milliseconds, from the main loop */
+	bool on_upload_timeout();
+
+	/** Starts drawing proxies, until the input settles */
+	void begin_interaction();
+
+	/** Goes back to drawing at full quality once the input has settled */
+	bool on_settle_timeout();
+
+	/** Makes the next proxies bigger or smaller to fit the frame budget */
+	void adapt_proxy_size(double frame_ms);
+
 	void camera_rotate(const maths::vector3f& axis, const float rot_angle_deg);
 	//void object_rotate(const maths::vector3f& axis, const float rot_angle_deg);
 	void camera_pan(const maths::vector2f& dxy);	// drag origin with mouse
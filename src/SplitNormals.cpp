@@ -0,0 +1,235 @@
+/*
+ * SplitNormals.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "SplitNormals.h"
+#include "HalfEdgeMesh.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	inline void normalize(float n[3])
+	{
+		const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (len > 0.0f)
+		{
+			n[0] /= len;
+			n[1] /= len;
+			n[2] /= len;
+		}
+	}
+
+	inline float dot(const float* a, const float* b)
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	/** Union-find over corners that several threads can join at once. A root is only
+	 *  ever linked under a lower one, so every corner's parent is at or below it, and
+	 *  each cluster's root ends up being its lowest corner. As the parents only ever
+	 *  go down, a stale one still leads to the right root, so relaxed order is enough.
+	 */
+	typedef std::vector<std::atomic<uint32_t>> parent_array;
+
+	/** Root of i, halving the path on the way */
+	inline uint32_t find_root(parent_array& parents, uint32_t i)
+	{
+		uint32_t parent = parents[i].load(std::memory_order_relaxed);
+		while (parent != i)
+		{
+			const uint32_t grandparent = parents[parent].load(std::memory_order_relaxed);
+			if (grandparent != parent)
+				parents[i].store(grandparent, std::memory_order_relaxed);
+
+			i = grandparent;
+			parent = parents[i].load(std::memory_order_relaxed);
+		}
+
+		return i;
+	}
+
+	inline void join(parent_array& parents, uint32_t a, uint32_t b)
+	{
+		for (;;)
+		{
+			a = find_root(parents, a);
+			b = find_root(parents, b);
+			if (a == b)
+				return;
+
+			if (a < b)
+				std::swap(a, b);
+
+			// Fails if another thread linked a first, then try again from the new roots
+			uint32_t expected = a;
+			if (parents[a].compare_exchange_weak(expected, b, std::memory_order_relaxed))
+				return;
+		}
+	}
+};
+
+//static
+const double SplitNormals::DEFAULT_CREASE_ANGLE = 38.25;	// acos(pi / 4) in degrees, the old cosine cutoff
+
+//static
+void SplitNormals::FacetNormal(const float* p0, const float* p1, const float* p2, float n[3])
+{
+	const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+	const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+	n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+	normalize(n);
+}
+
+std::vector<float> SplitNormals::Compute(const HalfEdgeMesh& mesh, std::vector<float>* facet_normals_out,
+										 const std::atomic<bool>* cancel) const
+{
+	const std::vector<float>& positions = mesh.positions;
+	const std::vector<uint32_t>& indices = mesh.indices;
+	const size_t num_facets = mesh.NumFacets();
+	const size_t num_corners = indices.size();
+
+	const float crease_cos = (float) std::cos(std::min(180.0, std::max(0.0, m_crease_angle)) * M_PI / 180.0);
+
+	std::vector<float> facet_normals(3 * num_facets);
+	ParallelFor(0, num_facets, m_num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (size_t f = begin ; f < end ; f++)
+			{
+				if (f % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+					return;
+
+				FacetNormal(&positions[3 * indices[3 * f + 0]],
+							&positions[3 * indices[3 * f + 1]],
+							&positions[3 * indices[3 * f + 2]], &facet_normals[3 * f]);
+			}
+		});
+
+	// Corner c is where half-edge c starts. Two facets on an edge that meet within the
+	// crease angle join their corners at each end of it into one cluster.
+	parent_array parents(num_corners);
+	ParallelFor(0, num_corners, m_num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (size_t c = begin ; c < end ; c++)
+				parents[c].store((uint32_t) c, std::memory_order_relaxed);
+		});
+
+	ParallelFor(0, num_corners, m_num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (uint32_t h = (uint32_t) begin ; h < end ; h++)
+			{
+				if (h % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+					return;
+
+				for (uint32_t g : mesh.RadialHalfEdges(h))
+				{
+					if (g <= h || dot(&facet_normals[3 * (h / 3)], &facet_normals[3 * (g / 3)]) < crease_cos)
+						continue;	// each pair once
+
+					// The facets may wind the same way or opposite ways
+					if (indices[h] == indices[g])
+					{
+						join(parents, h, g);
+						join(parents, HalfEdgeMesh::Next(h), HalfEdgeMesh::Next(g));
+					}
+					else
+					{
+						join(parents, h, HalfEdgeMesh::Next(g));
+						join(parents, HalfEdgeMesh::Next(h), g);
+					}
+				}
+			}
+		});
+
+	if (IsCanceled(cancel))
+		return std::vector<float>();
+
+	// Sum each cluster's facet normals at its root, in corner order. A range sums the corners
+	// whose root is in it, and leaves the ones whose root is in an earlier range for after,
+	// so every sum adds up in the same order whatever the number of threads.
+	std::vector<float> normals(3 * num_corners, 0.0f);
+	std::vector<std::vector<uint32_t>> later_corners(ResolveThreadCount(m_num_threads));
+
+	ParallelFor(0, num_corners, m_num_threads,
+		[&](size_t begin, size_t end, size_t range)
+		{
+			for (uint32_t c = (uint32_t) begin ; c < end ; c++)
+			{
+				if (c % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+					return;
+
+				const uint32_t root = find_root(parents, c);
+				parents[c].store(root, std::memory_order_relaxed);
+
+				if (root < begin)
+				{
+					later_corners[range].push_back(c);
+					continue;
+				}
+
+				const float* fn = &facet_normals[3 * (c / 3)];
+				float* sum = &normals[3 * root];
+
+				sum[0] += fn[0];
+				sum[1] += fn[1];
+				sum[2] += fn[2];
+			}
+		});
+
+	if (IsCanceled(cancel))
+		return std::vector<float>();
+
+	// A vertex's facets are mostly close together, so few corners cross ranges
+	for (const std::vector<uint32_t>& corners : later_corners)
+	{
+		for (uint32_t c : corners)
+		{
+			const float* fn = &facet_normals[3 * (c / 3)];
+			float* sum = &normals[3 * parents[c].load(std::memory_order_relaxed)];
+
+			sum[0] += fn[0];
+			sum[1] += fn[1];
+			sum[2] += fn[2];
+		}
+	}
+
+	ParallelFor(0, num_corners, m_num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (size_t c = begin ; c < end ; c++)
+				if (parents[c].load(std::memory_order_relaxed) == c)
+					normalize(&normals[3 * c]);
+		});
+
+	// Every corner points straight at its root now
+	ParallelFor(0, num_corners, m_num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (size_t c = begin ; c < end ; c++)
+			{
+				const uint32_t root = parents[c].load(std::memory_order_relaxed);
+				if (root != c)
+					std::copy(&normals[3 * root], &normals[3 * root] + 3, &normals[3 * c]);
+			}
+		});
+
+	if (IsCanceled(cancel))
+		return std::vector<float>();
+
+	if (facet_normals_out)
+		facet_normals_out->swap(facet_normals);
+
+	return normals;
+}
@@ -0,0 +1,65 @@
+/*
+ * SplitNormals.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef SPLITNORMALS_H_
+#define SPLITNORMALS_H_
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+struct HalfEdgeMesh;
+
+/** Computes crease-aware per-corner normals for a mesh.
+ *
+ *  The facets around each vertex are split into clusters along the edges where
+ *  they meet at more than the crease angle, and the normal at a facet corner is
+ *  the average of the normals in its facet's cluster. So smooth regions are shaded
+ *  smoothly, and the shading splits along creases.
+ *
+ *  The clusters come from one union-find pass over the half-edges, so the work is
+ *  close to linear in the number of facets however many meet at a vertex. Threads
+ *  join clusters at once with compare-and-swap, and the normals come out the same
+ *  for any number of threads.
+ */
+class SplitNormals
+{
+private:
+	double		m_crease_angle;
+	unsigned	m_num_threads;
+
+public:
+	/** The crease angle used when none is given, in degrees.
+	 *  (The cutoff the display lists have always used.)
+	 */
+	static const double DEFAULT_CREASE_ANGLE;
+
+	/** Constructor.
+	 *  @param	crease_angle	Facets meeting at more than this angle (in degrees) don't share normals
+	 *  @param	num_threads		The number of threads to use, 0 for the default
+	 */
+	SplitNormals(double crease_angle = DEFAULT_CREASE_ANGLE, unsigned num_threads = 0)
+	: m_crease_angle(crease_angle)
+	, m_num_threads(num_threads)
+	{
+
+	}
+
+	/** Computes the corner normals.
+	 *  @param	mesh			The mesh, with its half-edges
+	 *  @param	facet_normals	If not null, set to the unit facet normals (x, y, z per facet)
+	 *  @param	cancel			If not null, Compute() gives up soon after this is set and returns nothing
+	 *  @returns				x, y, z per facet corner (nine per facet), ready to upload
+	 */
+	std::vector<float> Compute(const HalfEdgeMesh& mesh, std::vector<float>* facet_normals = nullptr,
+							   const std::atomic<bool>* cancel = nullptr) const;
+
+	/** The unit normal of the facet p0, p1, p2 (zero if it's degenerate) */
+	static void FacetNormal(const float* p0, const float* p1, const float* p2, float n[3]);
+};
+
+#endif /* SPLITNORMALS_H_ */
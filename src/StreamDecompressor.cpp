@@ -0,0 +1,329 @@
+/*
+ * StreamDecompressor.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "StreamDecompressor.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+
+#include <zlib.h>
+
+#ifdef STLVIEW_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+	const unsigned char	GZIP_MAGIC[2] = { 0x1f, 0x8b };
+	const unsigned char	ZSTD_MAGIC[4] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+	// How much compressed input we hand the decompressor at a time,
+	// so CompressedBytesConsumed() moves smoothly
+	const size_t		INPUT_SLICE = 256 << 10;
+
+	bool has_magic(const MappedFile& file, const unsigned char* magic, size_t magic_len)
+	{
+		return file.Size() >= magic_len && std::memcmp(file.Data(), magic, magic_len) == 0;
+	}
+
+	inline void wait()
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+};
+
+StreamDecompressor::StreamDecompressor(const std::shared_ptr<const MappedFile>& file, Format format)
+: m_file(file)
+, m_format(format)
+, m_free_chunks(NUM_CHUNKS)
+, m_full_chunks(NUM_CHUNKS)
+, m_cancel(false)
+, m_done(false)
+, m_compressed_consumed(0)
+{
+	if (!IsSupported(m_format))
+		throw std::runtime_error(m_format == FORMAT_ZSTD ?
+			"This build of STLView can't read zstd compressed files" : "Not a compressed file");
+
+	for (size_t i = 0 ; i < NUM_CHUNKS ; i++)
+	{
+		m_chunks.emplace_back(new std::vector<char>);
+		m_chunks.back()->reserve(CHUNK_SIZE);
+
+		std::vector<char>* chunk = m_chunks.back().get();
+		m_free_chunks.TryPush(chunk);
+	}
+}
+
+StreamDecompressor::~StreamDecompressor()
+{
+	Cancel();
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+//static
+StreamDecompressor::Format StreamDecompressor::DetectFormat(const MappedFile& file)
+{
+	if (has_magic(file, GZIP_MAGIC, sizeof(GZIP_MAGIC)))
+		return FORMAT_GZIP;
+
+	if (has_magic(file, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)))
+		return FORMAT_ZSTD;
+
+	return FORMAT_NONE;
+}
+
+//static
+bool StreamDecompressor::IsSupported(Format format)
+{
+	switch (format)
+	{
+	case FORMAT_GZIP:
+		return true;
+#ifdef STLVIEW_HAVE_ZSTD
+	case FORMAT_ZSTD:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+void StreamDecompressor::Start()
+{
+	if (m_thread.joinable())
+		return;
+
+	m_file->AdviseSequential();
+	m_thread = std::thread(&StreamDecompressor::run, this);
+}
+
+void StreamDecompressor::Cancel()
+{
+	m_cancel.store(true);
+}
+
+size_t StreamDecompressor::UncompressedSizeHint() const
+{
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(m_file->Data());
+	const size_t size = m_file->Size();
+
+	if (m_format == FORMAT_GZIP && size >= 18)
+	{
+		// ISIZE, the last four bytes of the (last) member, little-endian
+		const unsigned char* isize = data + size - 4;
+		return (size_t) isize[0] | ((size_t) isize[1] << 8) | ((size_t) isize[2] << 16) | ((size_t) isize[3] << 24);
+	}
+
+#ifdef STLVIEW_HAVE_ZSTD
+	if (m_format == FORMAT_ZSTD)
+	{
+		const unsigned long long content_size = ZSTD_getFrameContentSize(data, size);
+		if (content_size != ZSTD_CONTENTSIZE_UNKNOWN && content_size != ZSTD_CONTENTSIZE_ERROR)
+			return (size_t) content_size;
+	}
+#endif
+
+	return 0;
+}
+
+void StreamDecompressor::run()
+{
+	try
+	{
+		if (m_format == FORMAT_GZIP)
+			inflate_gzip();
+		else
+			decompress_zstd();
+	}
+	catch (...)
+	{
+		m_error = std::current_exception();
+	}
+
+	m_done.store(true, std::memory_order_release);
+}
+
+std::vector<char>* StreamDecompressor::next_free_chunk()
+{
+	std::vector<char>* chunk = nullptr;
+	while (!m_free_chunks.TryPop(chunk))
+	{
+		if (m_cancel.load(std::memory_order_relaxed))
+			return nullptr;
+
+		wait();
+	}
+
+	chunk->resize(CHUNK_SIZE);
+
+	return chunk;
+}
+
+bool StreamDecompressor::push_chunk(std::vector<char>* chunk)
+{
+	while (!m_full_chunks.TryPush(chunk))
+	{
+		if (m_cancel.load(std::memory_order_relaxed))
+			return false;
+
+		wait();
+	}
+
+	return true;
+}
+
+void StreamDecompressor::inflate_gzip()
+{
+	z_stream strm;
+	std::memset(&strm, 0, sizeof(strm));
+
+	// 15 + 32: any window size, and detect the gzip header
+	if (::inflateInit2(&strm, 15 + 32) != Z_OK)
+		throw std::runtime_error("Error initializing zlib");
+
+	std::unique_ptr<z_stream, int (*)(z_stream*)> strm_guard(&strm, ::inflateEnd);
+
+	const Bytef* input = reinterpret_cast<const Bytef*>(m_file->Data());
+	const size_t input_size = m_file->Size();
+	size_t input_pos = 0;
+
+	bool stream_end = false;
+	while (!stream_end)
+	{
+		std::vector<char>* chunk = next_free_chunk();
+		if (!chunk)
+			return;	// canceled
+
+		strm.next_out = reinterpret_cast<Bytef*>(chunk->data());
+		strm.avail_out = (uInt) CHUNK_SIZE;
+
+		while (strm.avail_out > 0 && !stream_end)
+		{
+			if (strm.avail_in == 0)
+			{
+				if (input_pos == input_size)
+					throw std::runtime_error("Compressed file is truncated");
+
+				const size_t slice = std::min(INPUT_SLICE, input_size - input_pos);
+				strm.next_in = const_cast<Bytef*>(input + input_pos);
+				strm.avail_in = (uInt) slice;
+				input_pos += slice;
+			}
+
+			const int ret = ::inflate(&strm, Z_NO_FLUSH);
+
+			const size_t consumed = input_pos - strm.avail_in;
+			m_compressed_consumed.store(consumed, std::memory_order_relaxed);
+
+			if (ret == Z_STREAM_END)
+			{
+				// Concatenated gzip members are still one file
+				if (consumed == input_size)
+					stream_end = true;
+				else if (::inflateReset(&strm) != Z_OK)
+					throw std::runtime_error("Error resetting zlib stream");
+			}
+			else if (ret != Z_OK && ret != Z_BUF_ERROR)
+			{
+				throw std::runtime_error(std::string("Error decompressing file: ") + (strm.msg ? strm.msg : "corrupt data"));
+			}
+		}
+
+		chunk->resize(CHUNK_SIZE - strm.avail_out);
+		if (!push_chunk(chunk))
+			return;
+	}
+}
+
+void StreamDecompressor::decompress_zstd()
+{
+#ifdef STLVIEW_HAVE_ZSTD
+	std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream*)> dstream(ZSTD_createDStream(), ZSTD_freeDStream);
+	if (!dstream)
+		throw std::runtime_error("Error initializing zstd");
+
+	ZSTD_initDStream(dstream.get());
+
+	const size_t input_size = m_file->Size();
+
+	ZSTD_inBuffer in = { m_file->Data(), 0, 0 };
+	size_t last_ret = 0;
+
+	// The decoder can hold on to output after it has seen all of the input,
+	// so keep going until a call leaves room in the output buffer
+	bool more_output = true;
+	while (more_output)
+	{
+		std::vector<char>* chunk = next_free_chunk();
+		if (!chunk)
+			return;	// canceled
+
+		ZSTD_outBuffer out = { chunk->data(), CHUNK_SIZE, 0 };
+
+		while (out.pos < out.size)
+		{
+			if (in.pos == in.size && in.size < input_size)
+				in.size = std::min(in.size + INPUT_SLICE, input_size);
+
+			last_ret = ZSTD_decompressStream(dstream.get(), &out, &in);
+			if (ZSTD_isError(last_ret))
+				throw std::runtime_error(std::string("Error decompressing file: ") + ZSTD_getErrorName(last_ret));
+
+			m_compressed_consumed.store(in.pos, std::memory_order_relaxed);
+
+			if (in.pos == input_size && out.pos < out.size)
+			{
+				more_output = false;
+				break;
+			}
+		}
+
+		chunk->resize(out.pos);
+		if (!push_chunk(chunk))
+			return;
+	}
+
+	if (last_ret != 0)
+		throw std::runtime_error("Compressed file is truncated");
+#else
+	throw std::runtime_error("This build of STLView can't read zstd compressed files");
+#endif
+}
+
+bool StreamDecompressor::Read(std::vector<char>& buffer)
+{
+	std::vector<char>* chunk = nullptr;
+
+	while (!m_full_chunks.TryPop(chunk))
+	{
+		if (m_cancel.load(std::memory_order_relaxed))
+			return false;
+
+		// The decompressor pushes its last chunk before setting m_done
+		if (m_done.load(std::memory_order_acquire) && m_full_chunks.Empty())
+		{
+			if (m_error)
+				std::rethrow_exception(m_error);
+
+			return false;
+		}
+
+		wait();
+	}
+
+	buffer.swap(*chunk);
+	chunk->clear();
+	m_free_chunks.TryPush(chunk);	// never full, there are only NUM_CHUNKS chunks
+
+	return true;
+}
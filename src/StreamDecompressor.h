@@ -0,0 +1,113 @@
+/*
+ * StreamDecompressor.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef STREAMDECOMPRESSOR_H_
+#define STREAMDECOMPRESSOR_H_
+
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <cstddef>
+
+#include "MappedFile.h"
+#include "SPSCRing.h"
+
+/** Decompresses a gzip or zstd file on its own thread.
+ *
+ *  The decompressed data is handed to the reader in fixed size chunks through
+ *  a lock-free ring, and the emptied chunk buffers come back through another one,
+ *  so the decompressor can run up to NUM_CHUNKS chunks ahead of the parser
+ *  and nothing is ever written to disk.
+ */
+class StreamDecompressor
+{
+public:
+	enum Format
+	{
+		FORMAT_NONE,	///< Not compressed (or not a format we know)
+		FORMAT_GZIP,
+		FORMAT_ZSTD
+	};
+
+	static const size_t CHUNK_SIZE = 1 << 20;	///< Decompressed bytes per chunk
+	static const size_t NUM_CHUNKS = 8;
+
+private:
+	typedef SPSCRing<std::vector<char>*> chunk_ring;
+
+	std::shared_ptr<const MappedFile>				m_file;
+	Format											m_format;
+
+	std::vector<std::unique_ptr<std::vector<char>>>	m_chunks;
+	chunk_ring										m_free_chunks;
+	chunk_ring										m_full_chunks;
+
+	std::atomic<bool>		m_cancel;
+	std::atomic<bool>		m_done;
+	std::atomic<size_t>		m_compressed_consumed;
+	std::exception_ptr		m_error;
+
+	std::thread				m_thread;
+
+	void run();
+	void inflate_gzip();
+	void decompress_zstd();
+
+	/** Waits for an empty chunk buffer. Returns null if we've been canceled. */
+	std::vector<char>* next_free_chunk();
+
+	/** Hands a filled chunk to the reader. Returns false if we've been canceled. */
+	bool push_chunk(std::vector<char>* chunk);
+
+public:
+	/** Constructor.
+	 *  @param	file	The compressed file
+	 *  @param	format	The file format, from DetectFormat()
+	 *  @throws std::runtime_error if the format isn't supported by this build
+	 */
+	StreamDecompressor(const std::shared_ptr<const MappedFile>& file, Format format);
+
+	/** Cancels and waits for the decompressor thread */
+	~StreamDecompressor();
+
+	StreamDecompressor(const StreamDecompressor&) = delete;
+	StreamDecompressor& operator=(const StreamDecompressor&) = delete;
+
+	/** Identifies gzip and zstd files by their magic numbers */
+	static Format DetectFormat(const MappedFile& file);
+
+	/** True if this build can decompress the given format */
+	static bool IsSupported(Format format);
+
+	/** Starts the decompressor thread */
+	void Start();
+
+	/** Stops the decompressor. Read() returns false from then on. */
+	void Cancel();
+
+	/** Gets the next chunk of decompressed data. Reader thread only.
+	 *  The chunk is swapped into buffer, and buffer's old storage is recycled.
+	 *  Blocks until a chunk is ready.
+	 *  @returns	false at the end of the stream, or if we've been canceled
+	 *  @throws		std::runtime_error if the data is corrupt
+	 */
+	bool Read(std::vector<char>& buffer);
+
+	/** The decompressed size recorded in the file, or 0 if it doesn't say.
+	 *  For gzip this is only the size modulo 2^32.
+	 */
+	size_t UncompressedSizeHint() const;
+
+	size_t CompressedSize() const { return m_file->Size(); }
+
+	/** How much of the compressed file has been decompressed so far. Any thread. */
+	size_t CompressedBytesConsumed() const { return m_compressed_consumed.load(std::memory_order_relaxed); }
+};
+
+#endif /* STREAMDECOMPRESSOR_H_ */
@@ -0,0 +1,147 @@
+/*
+ * StreamingSTLReader.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "StreamingSTLReader.h"
+#include "BinarySTLReader.h"
+#include "ASCIISTLReader.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+StreamingSTLReader::StreamingSTLReader(StreamDecompressor& stream)
+: m_stream(stream)
+, m_format(FORMAT_UNKNOWN)
+, m_stream_end(false)
+, m_num_facets_expected(0)
+, m_num_facets_read(0)
+{
+
+}
+
+bool StreamingSTLReader::read_chunk()
+{
+	if (m_stream_end)
+		return false;
+
+	if (!m_stream.Read(m_chunk))
+	{
+		m_stream_end = true;
+		return false;
+	}
+
+	if (m_pending.empty())
+		m_pending.swap(m_chunk);	// the common case for ASCII, no copy
+	else
+		m_pending.insert(m_pending.end(), m_chunk.begin(), m_chunk.end());
+
+	return true;
+}
+
+void StreamingSTLReader::detect_format()
+{
+	const size_t prefix_size = BinarySTLReader::HEADER_SIZE + BinarySTLReader::COUNT_SIZE;
+
+	while (m_pending.size() < prefix_size && read_chunk())
+		;
+
+	const char* begin = m_pending.data();
+	const char* end = begin + m_pending.size();
+
+	// If the file says how big it is, a binary file's facet count has to agree with it
+	bool size_matches_binary = false;
+	uint32_t count = 0;
+	if (m_pending.size() >= prefix_size)
+	{
+		std::memcpy(&count, begin + BinarySTLReader::HEADER_SIZE, sizeof(count));
+
+		const uint64_t binary_size = prefix_size + (uint64_t) count * BinarySTLReader::RECORD_SIZE;
+		const size_t size_hint = m_stream.UncompressedSizeHint();
+		size_matches_binary = size_hint != 0 && (binary_size & 0xffffffffULL) == (size_hint & 0xffffffffULL);
+	}
+
+	if (!size_matches_binary && ASCIISTLReader::LooksLikeASCIISTL(begin, end))
+	{
+		m_format = FORMAT_ASCII;
+		m_name = ASCIISTLReader::ParseName(begin, end);
+	}
+	else
+	{
+		if (m_pending.size() < prefix_size)
+			throw std::runtime_error("Not an STL file (too short)");
+
+		m_format = FORMAT_BINARY;
+		m_name = BinarySTLReader::HeaderName(begin);
+		m_num_facets_expected = count;
+		m_pending.erase(m_pending.begin(), m_pending.begin() + prefix_size);
+	}
+}
+
+void StreamingSTLReader::next_binary(std::vector<STLTriangle>& triangles)
+{
+	const size_t record_size = BinarySTLReader::RECORD_SIZE;
+
+	while (m_pending.size() < record_size && read_chunk())
+		;
+
+	size_t num_records = std::min(m_pending.size() / record_size, m_num_facets_expected - m_num_facets_read);
+
+	triangles.resize(num_records);
+	for (size_t i = 0 ; i < num_records ; i++)
+		BinarySTLReader::DecodeRecord(m_pending.data() + i * record_size, triangles[i]);
+
+	m_pending.erase(m_pending.begin(), m_pending.begin() + num_records * record_size);
+	m_num_facets_read += num_records;
+
+	if (m_stream_end && m_num_facets_read < m_num_facets_expected && num_records == 0)
+		throw std::runtime_error("Binary STL file is truncated");
+}
+
+void StreamingSTLReader::next_ascii(std::vector<STLTriangle>& triangles)
+{
+	const char* begin = m_pending.data();
+	const char* end = begin + m_pending.size();
+
+	// Parse up to the last complete facet, unless there's nothing more coming
+	const char* parse_end = m_stream_end ? end : ASCIISTLReader::FindLastEndFacet(begin, end);
+
+	ASCIISTLReader::ParseRange(begin, parse_end, triangles);
+	m_pending.erase(m_pending.begin(), m_pending.begin() + (parse_end - begin));
+}
+
+bool StreamingSTLReader::NextTriangles(std::vector<STLTriangle>& triangles)
+{
+	triangles.clear();
+
+	if (m_format == FORMAT_UNKNOWN)
+		detect_format();
+
+	while (triangles.empty())
+	{
+		if (m_format == FORMAT_BINARY)
+		{
+			if (m_num_facets_read == m_num_facets_expected)
+				return false;
+
+			next_binary(triangles);
+		}
+		else
+		{
+			if (m_stream_end && m_pending.empty())
+				return false;
+
+			next_ascii(triangles);
+
+			if (triangles.empty() && !m_stream_end)
+				read_chunk();
+			else if (m_stream_end)
+				m_pending.clear();
+		}
+	}
+
+	return true;
+}
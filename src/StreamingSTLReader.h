@@ -0,0 +1,76 @@
+/*
+ * StreamingSTLReader.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef STREAMINGSTLREADER_H_
+#define STREAMINGSTLREADER_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+#include "StreamDecompressor.h"
+#include "TriangleBatch.h"
+
+/** Reads a binary or ASCII STL file as it comes out of a StreamDecompressor.
+ *
+ *  Each decompressed chunk is parsed as soon as it arrives. Whatever is left
+ *  over at the end of a chunk (part of a binary record, or the text after the
+ *  last "endfacet") is carried over to the next one.
+ */
+class StreamingSTLReader
+{
+private:
+	enum Format
+	{
+		FORMAT_UNKNOWN,
+		FORMAT_BINARY,
+		FORMAT_ASCII
+	};
+
+	StreamDecompressor&	m_stream;
+	Format				m_format;
+	std::string			m_name;
+
+	std::vector<char>	m_pending;	///< Data we've read but haven't parsed yet
+	std::vector<char>	m_chunk;
+	bool				m_stream_end;
+
+	size_t				m_num_facets_expected;	///< From the binary header
+	size_t				m_num_facets_read;
+
+	/** Appends the next chunk to m_pending. Returns false at the end of the stream. */
+	bool read_chunk();
+
+	void detect_format();
+	void next_binary(std::vector<STLTriangle>& triangles);
+	void next_ascii(std::vector<STLTriangle>& triangles);
+
+public:
+	explicit StreamingSTLReader(StreamDecompressor& stream);
+
+	/** Replaces the contents of triangles with the next facets in the file.
+	 *  Blocks until the decompressor has produced them.
+	 *  @returns	false once the whole file has been read
+	 *  @throws		std::runtime_error if the file is corrupt or truncated
+	 */
+	bool NextTriangles(std::vector<STLTriangle>& triangles);
+
+	/** The solid name, or the binary header text. Valid once NextTriangles() has been called. */
+	const std::string& Name() const { return m_name; }
+
+	/** Writes every facet in the file to out as an STLTriangle */
+	template <typename OutputIterator>
+	void Import(OutputIterator out)
+	{
+		std::vector<STLTriangle> triangles;
+		while (NextTriangles(triangles))
+			out = std::copy(triangles.begin(), triangles.end(), out);
+	}
+};
+
+#endif /* STREAMINGSTLREADER_H_ */
@@ -0,0 +1,247 @@
+/*
+ * ThumbnailRenderer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "ThumbnailRenderer.h"
+#include "MeshLoader.h"
+#include "MeshGeometry.h"
+#include "DisplayObject.h"
+#include "GLCamera.h"
+#include "ViewSetup.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <set>
+#include <stdexcept>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include <errno.h>
+
+#ifdef STLVIEW_HAVE_THUMBNAILS
+#include <png.h>
+#endif
+
+#include <GL/gl.h>
+
+using std::shared_ptr;
+
+namespace
+{
+	/** The file's name without its directory or STL extension */
+	std::string base_name(const std::string& filename)
+	{
+		std::string name = filename.substr(filename.find_last_of('/') + 1);
+
+		std::string lower(name);
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+
+		for (const char* extension : { ".stl.gz", ".stl.zst", ".stl" })
+		{
+			const size_t length = std::strlen(extension);
+			if (lower.size() > length && lower.compare(lower.size() - length, length, extension) == 0)
+				return name.substr(0, name.size() - length);
+		}
+
+		return name;
+	}
+
+#ifdef STLVIEW_HAVE_THUMBNAILS
+	/** Writes 8 bit RGB rows, top row first */
+	void write_png(const std::string& filename, unsigned width, unsigned height, const std::vector<uint8_t>& rgb)
+	{
+		FILE* file = std::fopen(filename.c_str(), "wb");
+		if (!file)
+			throw std::runtime_error("Error opening " + filename + ": " + ::strerror(errno));
+
+		std::vector<png_const_bytep> rows(height);
+		for (unsigned y = 0 ; y < height ; y++)
+			rows[y] = &rgb[3 * (size_t) width * y];
+
+		png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+		png_infop info = png ? png_create_info_struct(png) : nullptr;
+
+		// libpng longjmps back here on errors
+		if (!png || !info || setjmp(png_jmpbuf(png)))
+		{
+			png_destroy_write_struct(&png, &info);
+			std::fclose(file);
+			throw std::runtime_error("Error writing " + filename);
+		}
+
+		png_init_io(png, file);
+		png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+					 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+		png_write_info(png, info);
+		png_write_rows(png, (png_bytepp) rows.data(), height);
+		png_write_end(png, nullptr);
+
+		png_destroy_write_struct(&png, &info);
+
+		if (std::fclose(file) != 0)
+			throw std::runtime_error("Error writing " + filename + ": " + ::strerror(errno));
+	}
+#endif
+};
+
+ThumbnailRenderer::ThumbnailRenderer(unsigned width, unsigned height)
+: m_context(width, height)
+{
+#ifdef STLVIEW_HAVE_THUMBNAILS
+	ViewSetup::SetupLighting();
+	glShadeModel(GL_SMOOTH);
+#else
+	throw std::runtime_error("stlview was built without EGL and libpng, so it can't render thumbnails");
+#endif
+}
+
+//static
+bool ThumbnailRenderer::IsSupported()
+{
+#ifdef STLVIEW_HAVE_THUMBNAILS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void ThumbnailRenderer::Render(const shared_ptr<const MeshGeometry>& geometry, const std::string& png_filename)
+{
+#ifdef STLVIEW_HAVE_THUMBNAILS
+	const unsigned width = m_context.Width();
+	const unsigned height = m_context.Height();
+
+	// The part in a scene of its own, as STLDrawArea::InitMeshDO() shows it
+	{
+		auto scene_do = std::make_shared<SceneDisplayObject>();
+		auto part_do = std::make_shared<MeshDisplayObject>(geometry);
+		part_do->BuildDisplayLists();
+		scene_do->AddChild(part_do);
+
+		GLCamera camera;
+		ViewSetup::FitCamera(camera, scene_do->GetBBox());
+		ViewSetup::LoadProjection(scene_do->GetBBox(), camera.GetViewDistance(), 1.0, width, height);
+
+		glClearColor(1.0, 1.0, 1.0, 1.0);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		camera.GetMatrixForModelview();
+
+		glEnable(GL_CULL_FACE);
+		scene_do->Draw();
+		glDisable(GL_CULL_FACE);
+
+		// The display lists go with the display objects, before the next part
+	}
+
+	std::vector<uint8_t> pixels(3 * (size_t) width * height);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+	if (glGetError() != GL_NO_ERROR)
+		throw std::runtime_error("OpenGL error rendering " + png_filename);
+
+	// GL rows go bottom up, PNG rows top down
+	const size_t row_size = 3 * (size_t) width;
+	for (unsigned y = 0 ; y < height / 2 ; y++)
+		std::swap_ranges(&pixels[row_size * y], &pixels[row_size * (y + 1)], &pixels[row_size * (height - 1 - y)]);
+
+	write_png(png_filename, width, height, pixels);
+#endif
+}
+
+//static
+std::vector<ThumbnailRenderer::Result> ThumbnailRenderer::RenderAll(const std::vector<std::string>& filenames, const std::string& output_dir,
+																	unsigned width, unsigned height, unsigned num_threads,
+																	double weld_tolerance, double crease_angle)
+{
+	std::vector<Result> results(filenames.size());
+	if (filenames.empty())
+		return results;
+
+	// Files with the same name in different directories get numbered
+	const std::string dir_prefix = output_dir.empty() ? "" : (output_dir.back() == '/' ? output_dir : output_dir + "/");
+	std::set<std::string> image_names;
+	for (size_t i = 0 ; i < filenames.size() ; i++)
+	{
+		const std::string base = base_name(filenames[i]);
+
+		std::string image_name = base + ".png";
+		for (int n = 2 ; !image_names.insert(image_name).second ; n++)
+			image_name = base + "-" + std::to_string(n) + ".png";
+
+		results[i].filename = filenames[i];
+		results[i].image_filename = dir_prefix + image_name;
+	}
+
+	const unsigned num_workers = std::max<unsigned>(1, std::min<size_t>(ResolveThreadCount(num_threads), filenames.size()));
+
+	// Like MeshReport::GenerateAll(), with fewer files than threads each file gets a share of the rest
+	const unsigned load_threads = std::max<unsigned>(1, ResolveThreadCount(num_threads) / num_workers);
+
+	// Each worker takes the next file until they're all done, so one big part doesn't hold up a whole range
+	std::atomic<size_t> next_file(0);
+	std::vector<std::exception_ptr> context_errors(num_workers);
+
+	ParallelFor(0, num_workers, num_workers,
+		[&](size_t, size_t, size_t worker)
+		{
+			std::unique_ptr<ThumbnailRenderer> renderer;
+			try
+			{
+				renderer.reset(new ThumbnailRenderer(width, height));
+			}
+			catch (...)
+			{
+				context_errors[worker] = std::current_exception();
+				return;
+			}
+
+			for (size_t i = next_file++ ; i < filenames.size() ; i = next_file++)
+			{
+				Result& result = results[i];
+				auto const start = std::chrono::steady_clock::now();
+
+				// A thumbnail is a one off, don't leave a cache next to every file
+				MeshLoader loader(filenames[i], load_threads, weld_tolerance, crease_angle);
+				loader.DisableCacheWrite();
+				loader.Load();
+
+				if (loader.GetState() != MeshLoader::STATE_DONE)
+					result.error = loader.Error();
+				else if (loader.Geometry()->NumFacets() == 0)
+					result.error = "No facets";
+				else
+				{
+					try
+					{
+						renderer->Render(loader.Geometry(), result.image_filename);
+					}
+					catch (std::exception& ex)
+					{
+						result.error = ex.what();
+					}
+				}
+
+				result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+		});
+
+	// If any worker had a context, it did all the files
+	if (next_file.load() < filenames.size())
+	{
+		for (const std::exception_ptr& error : context_errors)
+			if (error)
+				std::rethrow_exception(error);
+	}
+
+	return results;
+}
@@ -0,0 +1,73 @@
+/*
+ * ThumbnailRenderer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef THUMBNAILRENDERER_H_
+#define THUMBNAILRENDERER_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "OffscreenContext.h"
+
+struct MeshGeometry;
+
+/** Draws parts into PNG images without a display or a GPU, for "stlview --thumbnails".
+ *
+ *  Each renderer has its own OffscreenContext, so they can run on several threads.
+ *  Parts are drawn the way the window first shows them: from display lists
+ *  (MeshDisplayObject), with the view fitted by ViewSetup.
+ *
+ *  Needs EGL and libpng at build time (STLVIEW_HAVE_THUMBNAILS).
+ */
+class ThumbnailRenderer
+{
+public:
+	/** How one file went */
+	struct Result
+	{
+		std::string	filename;
+		std::string	image_filename;
+		double		seconds = 0.0;	///< Loading and rendering
+		std::string	error;			///< Why there's no image, empty if there is
+
+		bool Ok() const { return error.empty(); }
+	};
+
+private:
+	OffscreenContext	m_context;
+
+public:
+	/** Creates the context and makes it current on the calling thread, which is the
+	 *  only thread the renderer may be used on.
+	 *  @throws std::runtime_error if there's no way to get an offscreen context
+	 */
+	ThumbnailRenderer(unsigned width, unsigned height);
+
+	ThumbnailRenderer(const ThumbnailRenderer&) = delete;
+	ThumbnailRenderer& operator=(const ThumbnailRenderer&) = delete;
+
+	/** Whether stlview was built with offscreen rendering */
+	static bool IsSupported();
+
+	/** Draws the part and writes it to a PNG file.
+	 *  @throws std::runtime_error if the image couldn't be written
+	 */
+	void Render(const std::shared_ptr<const MeshGeometry>& geometry, const std::string& png_filename);
+
+	/** Renders a thumbnail of every file into output_dir, on num_threads threads (0 for the default),
+	 *  each with its own context. Each image is named after its file, with .png for the STL extension.
+	 *  The files are loaded from their mesh caches where they have one, but no new caches are written.
+	 *  The results are in the same order as the files.
+	 *  @throws std::runtime_error if no thread could get a context
+	 */
+	static std::vector<Result> RenderAll(const std::vector<std::string>& filenames, const std::string& output_dir,
+										 unsigned width, unsigned height, unsigned num_threads,
+										 double weld_tolerance, double crease_angle);
+};
+
+#endif /* THUMBNAILRENDERER_H_ */
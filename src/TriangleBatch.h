@@ -0,0 +1,46 @@
+/*
+ * TriangleBatch.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef TRIANGLEBATCH_H_
+#define TRIANGLEBATCH_H_
+
+#include <geom.h>
+#include <vectors.h>
+
+#include <vector>
+
+/** A triangle as it comes out of an STL file.
+ *  Plain data, so that batches of them can be filled and recycled without
+ *  constructing maths objects.
+ */
+struct STLTriangle
+{
+	double	v[9];	///< x, y, z of each of the three vertices
+
+	maths::triangle3d ToTriangle3d() const
+	{
+		return maths::triangle3d(	maths::vector3d(v[0], v[1], v[2]),
+									maths::vector3d(v[3], v[4], v[5]),
+									maths::vector3d(v[6], v[7], v[8]));
+	}
+};
+
+/** A fixed-capacity batch of triangles, handed from the importer thread
+ *  to the mesh builder thread in one go.
+ */
+struct TriangleBatch
+{
+	static const size_t CAPACITY = 4096;
+
+	std::vector<STLTriangle>	triangles;
+
+	TriangleBatch() { triangles.reserve(CAPACITY); }
+
+	bool Full() const { return triangles.size() == CAPACITY; }
+};
+
+#endif /* TRIANGLEBATCH_H_ */
@@ -0,0 +1,343 @@
+/*
+ * VertexCacheOptimizer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const uint32_t NO_FACET = std::numeric_limits<uint32_t>::max();
+
+	// Forsyth's scoring constants
+	const float CACHE_DECAY_POWER = 1.5f;
+	const float LAST_FACET_SCORE = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+
+	/** Valences past this all score the same (as good as nothing) */
+	const uint32_t MAX_SCORED_VALENCE = 32;
+
+	struct valence_table
+	{
+		float	scores[MAX_SCORED_VALENCE + 1];
+
+		valence_table()
+		{
+			scores[0] = 0.0f;
+			for (uint32_t valence = 1 ; valence <= MAX_SCORED_VALENCE ; valence++)
+				scores[valence] = VALENCE_BOOST_SCALE * std::pow((float) valence, -VALENCE_BOOST_POWER);
+		}
+	};
+
+	const valence_table VALENCE_SCORES;
+
+	/** Simulates a FIFO vertex cache */
+	class fifo_cache
+	{
+	private:
+		std::vector<uint32_t>	m_entries;
+		size_t					m_next;		///< Where the next miss goes
+
+	public:
+		explicit fifo_cache(unsigned size) : m_entries(std::max(1u, size), std::numeric_limits<uint32_t>::max()), m_next(0) { }
+
+		/** Looks vertex up, and adds it if it isn't there. Returns true on a miss. */
+		bool Miss(uint32_t vertex)
+		{
+			if (std::find(m_entries.begin(), m_entries.end(), vertex) != m_entries.end())
+				return false;
+
+			m_entries[m_next] = vertex;
+			m_next = (m_next + 1) % m_entries.size();
+			return true;
+		}
+	};
+};
+
+//static
+const unsigned VertexCacheOptimizer::DEFAULT_CACHE_SIZE;
+
+//static
+const unsigned VertexCacheOptimizer::FIFO_CACHE_SIZE;
+
+VertexCacheOptimizer::VertexCacheOptimizer(unsigned cache_size)
+: m_cache_size(std::max(4u, cache_size))
+, m_position_scores(m_cache_size)
+{
+	// The last facet's vertices score the same whichever order they went in, so
+	// the facet that used them doesn't win just for them. After that, the score
+	// decays with the position in the cache.
+	const float scaler = 1.0f / (m_cache_size - 3);
+	for (unsigned position = 0 ; position < m_cache_size ; position++)
+	{
+		m_position_scores[position] = position < 3 ?
+			LAST_FACET_SCORE : std::pow(1.0f - (position - 3) * scaler, CACHE_DECAY_POWER);
+	}
+}
+
+float VertexCacheOptimizer::vertex_score(uint32_t vertex) const
+{
+	const uint32_t live = m_live_facets[vertex];
+	if (live == 0)
+		return 0.0f;
+
+	const int32_t position = m_cache_position[vertex];
+	const float cache_score = position < 0 ? 0.0f : m_position_scores[position];
+
+	return cache_score + VALENCE_SCORES.scores[std::min(live, MAX_SCORED_VALENCE)];
+}
+
+void VertexCacheOptimizer::Optimize(uint32_t* indices, size_t num_facets)
+{
+	if (num_facets < 2)
+		return;
+
+	const size_t num_indices = 3 * num_facets;
+
+	// Number the vertices 0 to n - 1, so everything per vertex can be an array.
+	// The ids are usually close together, so a table over their range does; otherwise they're sorted.
+	const auto range = std::minmax_element(indices, indices + num_indices);
+	const size_t id_range = (size_t) *range.second - *range.first + 1;
+
+	m_local.resize(num_indices);
+	size_t num_vertices = 0;
+	if (id_range <= 4 * num_indices)
+	{
+		m_vertex_ids.assign(id_range, NO_FACET);
+		for (size_t i = 0 ; i < num_indices ; i++)
+		{
+			uint32_t& id = m_vertex_ids[indices[i] - *range.first];
+			if (id == NO_FACET)
+				id = (uint32_t) num_vertices++;
+			m_local[i] = id;
+		}
+	}
+	else
+	{
+		m_vertex_ids.assign(indices, indices + num_indices);
+		std::sort(m_vertex_ids.begin(), m_vertex_ids.end());
+		m_vertex_ids.erase(std::unique(m_vertex_ids.begin(), m_vertex_ids.end()), m_vertex_ids.end());
+
+		num_vertices = m_vertex_ids.size();
+		for (size_t i = 0 ; i < num_indices ; i++)
+			m_local[i] = (uint32_t) (std::lower_bound(m_vertex_ids.begin(), m_vertex_ids.end(), indices[i]) - m_vertex_ids.begin());
+	}
+
+	// The facets of each vertex (CSR). A facet using a vertex twice is there twice.
+	m_live_facets.assign(num_vertices, 0);
+	for (uint32_t v : m_local)
+		m_live_facets[v]++;
+
+	m_facet_start.resize(num_vertices + 1);
+	m_facet_start[0] = 0;
+	for (size_t v = 0 ; v < num_vertices ; v++)
+		m_facet_start[v + 1] = m_facet_start[v] + m_live_facets[v];
+
+	m_vertex_facets.resize(num_indices);
+	for (size_t i = 0 ; i < num_indices ; i++)
+		m_vertex_facets[m_facet_start[m_local[i]]++] = (uint32_t) (i / 3);
+
+	for (size_t v = num_vertices ; v > 0 ; v--)
+		m_facet_start[v] = m_facet_start[v - 1];
+	m_facet_start[0] = 0;
+
+	m_cache_position.assign(num_vertices, -1);
+	m_vertex_score.resize(num_vertices);
+	for (size_t v = 0 ; v < num_vertices ; v++)
+		m_vertex_score[v] = vertex_score((uint32_t) v);
+
+	m_emitted.assign(num_facets, 0);
+
+	std::vector<uint32_t> result;
+	result.reserve(num_indices);
+
+	std::vector<uint32_t> cache, new_cache;
+	cache.reserve(m_cache_size + 3);
+	new_cache.reserve(m_cache_size + 3);
+
+	uint32_t best = 0;
+	size_t next_in_order = 0;
+
+	for (size_t emitted = 0 ; emitted < num_facets ; emitted++)
+	{
+		// Nothing in the cache is any use, so carry on from where the original order left off
+		if (best == NO_FACET)
+		{
+			while (m_emitted[next_in_order])
+				next_in_order++;
+
+			best = (uint32_t) next_in_order;
+		}
+
+		const uint32_t* corners = &m_local[3 * best];
+		result.insert(result.end(), indices + 3 * best, indices + 3 * best + 3);
+		m_emitted[best] = 1;
+
+		// It's no longer live for its vertices
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			const uint32_t v = corners[k];
+			uint32_t* facets = &m_vertex_facets[m_facet_start[v]];
+			uint32_t& live = m_live_facets[v];
+
+			uint32_t* found = std::find(facets, facets + live, best);
+			std::swap(*found, facets[live - 1]);
+			live--;
+		}
+
+		// Its vertices go to the front of the cache
+		new_cache.clear();
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			if (std::find(new_cache.begin(), new_cache.end(), corners[k]) == new_cache.end())
+				new_cache.push_back(corners[k]);
+		}
+
+		for (uint32_t v : cache)
+		{
+			if (v != corners[0] && v != corners[1] && v != corners[2])
+				new_cache.push_back(v);
+		}
+
+		// Rescore everything that moved, including whatever fell out of the cache
+		for (size_t i = 0 ; i < new_cache.size() ; i++)
+		{
+			const uint32_t v = new_cache[i];
+			m_cache_position[v] = i < m_cache_size ? (int32_t) i : -1;
+			m_vertex_score[v] = vertex_score(v);
+		}
+
+		if (new_cache.size() > m_cache_size)
+			new_cache.resize(m_cache_size);
+		cache.swap(new_cache);
+
+		// The next facet is the best of those using a cached vertex. Only these facets'
+		// scores ever matter, so they're summed here rather than kept up to date.
+		best = NO_FACET;
+		float best_score = -1.0f;
+		for (uint32_t v : cache)
+		{
+			const uint32_t* facets = &m_vertex_facets[m_facet_start[v]];
+			for (uint32_t j = 0 ; j < m_live_facets[v] ; j++)
+			{
+				const uint32_t* facet_corners = &m_local[3 * facets[j]];
+				const float score = m_vertex_score[facet_corners[0]] + m_vertex_score[facet_corners[1]] +
+									m_vertex_score[facet_corners[2]];
+				if (score > best_score)
+				{
+					best = facets[j];
+					best_score = score;
+				}
+			}
+		}
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+//static
+void VertexCacheOptimizer::ClusterForOverdraw(uint32_t* indices, size_t num_facets, const void* positions, size_t stride,
+											  const float center[3])
+{
+	struct cluster
+	{
+		size_t	first_facet;
+		size_t	num_facets;
+		float	outwards;		///< How far it faces away from the center
+	};
+
+	auto const position = [positions, stride](uint32_t v)
+	{
+		return reinterpret_cast<const float*>(static_cast<const char*>(positions) + v * stride);
+	};
+
+	// A facet that misses on all three vertices starts a new cluster: the cache has started over anyway
+	std::vector<cluster> clusters;
+	fifo_cache cache(FIFO_CACHE_SIZE);
+	for (size_t f = 0 ; f < num_facets ; f++)
+	{
+		int misses = 0;
+		for (int k = 0 ; k < 3 ; k++)
+			misses += cache.Miss(indices[3 * f + k]) ? 1 : 0;
+
+		if (misses == 3 || clusters.empty())
+			clusters.push_back({ f, 0, 0.0f });
+
+		clusters.back().num_facets++;
+	}
+
+	if (clusters.size() < 2)
+		return;
+
+	// The area weighted centroid and normal of each cluster
+	for (cluster& c : clusters)
+	{
+		double area_centroid[3] = { 0.0, 0.0, 0.0 };
+		double area_normal[3] = { 0.0, 0.0, 0.0 };
+		double area = 0.0;
+
+		for (size_t f = c.first_facet ; f < c.first_facet + c.num_facets ; f++)
+		{
+			const float* p0 = position(indices[3 * f]);
+			const float* p1 = position(indices[3 * f + 1]);
+			const float* p2 = position(indices[3 * f + 2]);
+
+			const double e1[3] = { (double) p1[0] - p0[0], (double) p1[1] - p0[1], (double) p1[2] - p0[2] };
+			const double e2[3] = { (double) p2[0] - p0[0], (double) p2[1] - p0[1], (double) p2[2] - p0[2] };
+			const double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			const double facet_area = 0.5 * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (int k = 0 ; k < 3 ; k++)
+			{
+				area_centroid[k] += facet_area * (p0[k] + p1[k] + p2[k]) / 3.0;
+				area_normal[k] += 0.5 * n[k];
+			}
+			area += facet_area;
+		}
+
+		const double normal_length = std::sqrt(area_normal[0] * area_normal[0] + area_normal[1] * area_normal[1] +
+											   area_normal[2] * area_normal[2]);
+		if (area <= 0.0 || normal_length <= 0.0)
+			continue;
+
+		double outwards = 0.0;
+		for (int k = 0 ; k < 3 ; k++)
+			outwards += (area_centroid[k] / area - center[k]) * area_normal[k] / normal_length;
+
+		c.outwards = (float) outwards;
+	}
+
+	// Outermost first, and otherwise as they were
+	std::stable_sort(clusters.begin(), clusters.end(),
+		[](const cluster& a, const cluster& b) { return a.outwards > b.outwards; });
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(3 * num_facets);
+	for (const cluster& c : clusters)
+		sorted.insert(sorted.end(), indices + 3 * c.first_facet, indices + 3 * (c.first_facet + c.num_facets));
+
+	std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+//static
+double VertexCacheOptimizer::ACMR(const uint32_t* indices, size_t num_facets, unsigned cache_size)
+{
+	if (num_facets == 0)
+		return 0.0;
+
+	fifo_cache cache(cache_size);
+
+	size_t misses = 0;
+	for (size_t i = 0 ; i < 3 * num_facets ; i++)
+		misses += cache.Miss(indices[i]) ? 1 : 0;
+
+	return (double) misses / (double) num_facets;
+}
@@ -0,0 +1,85 @@
+/*
+ * VertexCacheOptimizer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef VERTEXCACHEOPTIMIZER_H_
+#define VERTEXCACHEOPTIMIZER_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/** Reorders the facets of an indexed triangle list so the GPU's post-transform
+ *  vertex cache hits more often, and measures how well it does.
+ *
+ *  The order is Forsyth's "Linear-Speed Vertex Cache Optimisation": each vertex is
+ *  scored by its place in a modelled LRU cache and by how many facets still use it,
+ *  and the facet with the best total score among those using cached vertices goes
+ *  next. When none do, it carries on with the next facet in the original order, so
+ *  an order that was spatially coherent to start with stays so.
+ *
+ *  ClusterForOverdraw() then optionally sorts the runs between cache restarts so
+ *  the ones on the outside of the part are drawn first, as in Sander et al.'s
+ *  Tipsify, which costs almost no cache hits and lets the depth test reject more.
+ *
+ *  The vertex numbers aren't changed; renumber them by first use afterwards for
+ *  vertex fetch locality.
+ */
+class VertexCacheOptimizer
+{
+public:
+	/** The size of the LRU cache the scores model. Forsyth used 32; 16 matches the
+	 *  cache ACMR() measures with, and takes half the time.
+	 */
+	static const unsigned DEFAULT_CACHE_SIZE = 16;
+
+	/** The FIFO cache ACMR() measures with, and ClusterForOverdraw() splits at: a typical hardware cache */
+	static const unsigned FIFO_CACHE_SIZE = 16;
+
+private:
+	unsigned				m_cache_size;
+	std::vector<float>		m_position_scores;	///< The score for each place in the cache
+
+	// Scratch, kept between calls so a run of small Optimize() calls doesn't allocate
+	std::vector<uint32_t>	m_vertex_ids;		///< Vertex to local number over the id range, or the distinct vertices sorted
+	std::vector<uint32_t>	m_local;			///< Each corner's local vertex number
+	std::vector<uint32_t>	m_facet_start;		///< Per vertex, where its facets start in m_vertex_facets
+	std::vector<uint32_t>	m_live_facets;		///< Per vertex, how many facets using it are still to go
+	std::vector<uint32_t>	m_vertex_facets;	///< The facets using each vertex, live ones first
+	std::vector<int32_t>	m_cache_position;	///< Per vertex, -1 if it isn't in the modelled cache
+	std::vector<float>		m_vertex_score;
+	std::vector<uint8_t>	m_emitted;
+
+	float vertex_score(uint32_t vertex) const;
+
+public:
+	explicit VertexCacheOptimizer(unsigned cache_size = DEFAULT_CACHE_SIZE);
+
+	/** Reorders the facets in place.
+	 *  @param	indices		Three vertex indices per facet
+	 *  @param	num_facets	The number of facets
+	 */
+	void Optimize(uint32_t* indices, size_t num_facets);
+
+	/** Splits the facets into clusters where a FIFO_CACHE_SIZE cache misses all three
+	 *  vertices of a facet, and orders the clusters by how far they face out from center.
+	 *  @param	indices		Three vertex indices per facet, reordered in place
+	 *  @param	num_facets	The number of facets
+	 *  @param	positions	The x, y, z of the first vertex, as floats
+	 *  @param	stride		The bytes from one vertex's position to the next
+	 *  @param	center		The middle of the part
+	 */
+	static void ClusterForOverdraw(uint32_t* indices, size_t num_facets, const void* positions, size_t stride,
+								   const float center[3]);
+
+	/** The average cache miss ratio: vertices transformed per facet with a FIFO cache
+	 *  of cache_size, from 3 (no reuse at all) down to about 0.5 for a big regular grid.
+	 *  0 if there are no facets.
+	 */
+	static double ACMR(const uint32_t* indices, size_t num_facets, unsigned cache_size = FIFO_CACHE_SIZE);
+};
+
+#endif /* VERTEXCACHEOPTIMIZER_H_ */
@@ -0,0 +1,265 @@
+/*
+ * VertexWelder.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "VertexWelder.h"
+#include "Parallel.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+namespace
+{
+	struct corner_key
+	{
+		uint64_t	morton;		// Morton code of the weld cell (shifted down to 21 bits), for locality
+		uint32_t	cell[3];	// The weld cell, or the coordinate bits for an exact weld
+		uint32_t	corner;		// Index of the corner in the soup
+	};
+
+	inline bool same_cell(const corner_key& a, const corner_key& b)
+	{
+		return a.cell[0] == b.cell[0] && a.cell[1] == b.cell[1] && a.cell[2] == b.cell[2];
+	}
+
+	inline bool operator<(const corner_key& a, const corner_key& b)
+	{
+		if (a.morton != b.morton)
+			return a.morton < b.morton;
+
+		for (int i = 0 ; i < 3 ; i++)
+			if (a.cell[i] != b.cell[i])
+				return a.cell[i] < b.cell[i];
+
+		return a.corner < b.corner;
+	}
+
+	/// Spreads the low 21 bits of v out to every third bit
+	inline uint64_t spread_bits(uint64_t v)
+	{
+		v &= 0x1fffff;
+		v = (v | (v << 32)) & 0x1f00000000ffffULL;
+		v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+		v = (v | (v << 8))  & 0x100f00f00f00f00fULL;
+		v = (v | (v << 4))  & 0x10c30c30c30c30c3ULL;
+		v = (v | (v << 2))  & 0x1249249249249249ULL;
+
+		return v;
+	}
+
+	inline uint64_t morton_code(uint32_t x, uint32_t y, uint32_t z)
+	{
+		return spread_bits(x) | (spread_bits(y) << 1) | (spread_bits(z) << 2);
+	}
+
+	/// Clamps v to [0, max] and truncates it (NaN goes to 0)
+	inline uint32_t to_cell(double v, double max)
+	{
+		if (!(v >= 0.0))
+			return 0;
+
+		return v < max ? (uint32_t) v : (uint32_t) max;
+	}
+
+	/// Maps a float to an integer with the same ordering, so that equal keys mean equal coordinates
+	inline uint32_t float_key(float f)
+	{
+		f += 0.0f;	// -0 -> +0
+
+		uint32_t bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+
+		return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	}
+};
+
+IndexedMesh VertexWelder::Weld(const std::vector<float>& corners, const std::atomic<bool>* cancel) const
+{
+	IndexedMesh welded;
+
+	const size_t num_corners = corners.size() / 3;
+	if (num_corners == 0)
+		return welded;
+
+	if (num_corners > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("Too many triangles to weld");
+
+	const unsigned num_threads = ResolveThreadCount(m_num_threads);
+
+	// Bounding box of all of the corners
+	const float inf = std::numeric_limits<float>::infinity();
+	std::vector<float> range_bounds(6 * num_threads);
+	for (unsigned r = 0 ; r < num_threads ; r++)
+	{
+		std::fill(range_bounds.begin() + 6 * r, range_bounds.begin() + 6 * r + 3, inf);
+		std::fill(range_bounds.begin() + 6 * r + 3, range_bounds.begin() + 6 * r + 6, -inf);
+	}
+
+	ParallelFor(0, num_corners, num_threads,
+		[&](size_t begin, size_t end, size_t range)
+		{
+			float* bounds = &range_bounds[6 * range];
+			for (size_t i = begin ; i < end ; i++)
+			{
+				if (i % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+					return;
+
+				for (int k = 0 ; k < 3 ; k++)
+				{
+					const float c = corners[3 * i + k];
+					if (c < bounds[k])
+						bounds[k] = c;
+					if (c > bounds[k + 3])
+						bounds[k + 3] = c;
+				}
+			}
+		});
+
+	if (IsCanceled(cancel))
+		return welded;
+
+	float bbox[6] = { inf, inf, inf, -inf, -inf, -inf };
+	for (unsigned r = 0 ; r < num_threads ; r++)
+	{
+		for (int k = 0 ; k < 3 ; k++)
+		{
+			bbox[k] = std::min(bbox[k], range_bounds[6 * r + k]);
+			bbox[k + 3] = std::max(bbox[k + 3], range_bounds[6 * r + k + 3]);
+		}
+	}
+
+	const double max_extent = std::max({ (double) bbox[3] - bbox[0], (double) bbox[4] - bbox[1], (double) bbox[5] - bbox[2], 0.0 });
+	const double morton_max = (double) ((1 << 21) - 1);
+	const double morton_scale = max_extent > 0.0 ? morton_max / max_extent : 0.0;
+	const double cell_max = (double) std::numeric_limits<uint32_t>::max();
+	const bool exact = !(m_tolerance > 0.0);
+
+	// The cells are 32 bits, so a tolerance too fine to cover the mesh in that many is
+	// coarsened to fit. Otherwise every corner past the last cell would weld into it.
+	double tolerance = m_tolerance;
+	if (!exact && std::isfinite(max_extent) && max_extent / tolerance > cell_max)
+	{
+		tolerance = max_extent / cell_max;
+		std::clog	<< "Weld tolerance " << m_tolerance << " is too fine for a mesh " << max_extent
+					<< " across, welding at " << tolerance << " instead" << std::endl;
+	}
+
+	// With a tolerance the Morton code comes from the weld cell itself, so a cell's
+	// corners always sort together. Exact keys get a coarse grid of their own.
+	int cell_shift = 0;
+	if (!exact)
+	{
+		const uint32_t max_cell = to_cell(std::floor(max_extent / tolerance), cell_max);
+		while ((max_cell >> cell_shift) > 0x1fffff)
+			cell_shift++;
+	}
+
+	// Key every corner and sort them so coincident corners are adjacent
+	std::vector<corner_key> keys(num_corners);
+
+	ParallelFor(0, num_corners, num_threads,
+		[&](size_t begin, size_t end, size_t)
+		{
+			for (size_t i = begin ; i < end ; i++)
+			{
+				if (i % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+					return;
+
+				const float* p = &corners[3 * i];
+				corner_key& key = keys[i];
+
+				uint32_t coarse[3];
+				for (int k = 0 ; k < 3 ; k++)
+				{
+					const double d = (double) p[k] - bbox[k];
+
+					if (exact)
+					{
+						coarse[k] = to_cell(d * morton_scale, morton_max);
+						key.cell[k] = float_key(p[k]);
+					}
+					else
+					{
+						key.cell[k] = to_cell(std::floor(d / tolerance), cell_max);
+						coarse[k] = key.cell[k] >> cell_shift;
+					}
+				}
+
+				key.morton = morton_code(coarse[0], coarse[1], coarse[2]);
+				key.corner = (uint32_t) i;
+			}
+		});
+
+	if (IsCanceled(cancel))
+		return welded;
+
+	ParallelSort(keys, std::less<corner_key>(), num_threads, cancel);
+	if (IsCanceled(cancel))
+		return welded;
+
+	// Each run of keys in the same cell is one vertex. Count the runs that start
+	// in each range so every range knows the first vertex index it will hand out.
+	std::vector<size_t> range_starts(num_threads + 1, 0);
+
+	ParallelFor(0, num_corners, num_threads,
+		[&](size_t begin, size_t end, size_t range)
+		{
+			size_t num_starts = 0;
+			for (size_t i = begin ; i < end ; i++)
+			{
+				if (i % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+					return;
+
+				if (i == 0 || !same_cell(keys[i], keys[i - 1]))
+					num_starts++;
+			}
+
+			range_starts[range + 1] = num_starts;
+		});
+
+	for (unsigned r = 0 ; r < num_threads ; r++)
+		range_starts[r + 1] += range_starts[r];
+
+	if (IsCanceled(cancel))
+		return welded;
+
+	const size_t num_vertices = range_starts[num_threads];
+	welded.positions.resize(3 * num_vertices);
+	welded.indices.resize(num_corners);
+
+	ParallelFor(0, num_corners, num_threads,
+		[&](size_t begin, size_t end, size_t range)
+		{
+			// Index of the vertex the current run belongs to, plus one
+			size_t vertex_end = range_starts[range];
+
+			for (size_t i = begin ; i < end ; i++)
+			{
+				if (i % CANCEL_CHECK_INTERVAL == 0 && IsCanceled(cancel))
+					return;
+
+				const corner_key& key = keys[i];
+
+				if (i == 0 || !same_cell(key, keys[i - 1]))
+				{
+					// The sort puts the lowest corner index first, use its position
+					std::copy(&corners[3 * key.corner], &corners[3 * key.corner] + 3, &welded.positions[3 * vertex_end]);
+					vertex_end++;
+				}
+
+				welded.indices[key.corner] = (uint32_t) (vertex_end - 1);
+			}
+		});
+
+	if (IsCanceled(cancel))
+		return IndexedMesh();
+
+	return welded;
+}
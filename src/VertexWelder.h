@@ -0,0 +1,56 @@
+/*
+ * VertexWelder.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef VERTEXWELDER_H_
+#define VERTEXWELDER_H_
+
+#include <vector>
+#include <atomic>
+
+#include "IndexedMesh.h"
+
+/** Welds the corners of a triangle soup into shared vertices.
+ *
+ *  Every corner gets a key: its cell in a grid of tolerance-sized cells
+ *  (or its exact coordinates if the tolerance is 0). The corners are sorted,
+ *  in parallel, by the Morton code of their cell and then by the key, so
+ *  corners that weld end up next to each other. Each run of equal keys
+ *  becomes one vertex. The vertices come out in Morton order, which keeps
+ *  neighboring vertices close together in memory.
+ *
+ *  Two corners weld if they fall in the same cell, so corners closer than
+ *  the tolerance but on either side of a cell boundary stay apart. There are
+ *  at most 2^32 cells across the mesh, so a finer tolerance is coarsened to
+ *  that (and logged).
+ */
+class VertexWelder
+{
+private:
+	double		m_tolerance;
+	unsigned	m_num_threads;
+
+public:
+	/** Constructor.
+	 *  @param	tolerance	The weld cell size, 0 to only weld exactly coincident corners
+	 *  @param	num_threads	The number of threads to use, 0 for the default
+	 */
+	VertexWelder(double tolerance = 0.0, unsigned num_threads = 0)
+	: m_tolerance(tolerance)
+	, m_num_threads(num_threads)
+	{
+
+	}
+
+	/** Welds a triangle soup.
+	 *  @param	corners	Nine floats (three x, y, z corners) per triangle
+	 *  @param	cancel	If not null, Weld() gives up soon after this is set and returns an empty mesh
+	 *  @returns		The welded vertices, and the triangles as vertex indices in their original order
+	 */
+	IndexedMesh Weld(const std::vector<float>& corners, const std::atomic<bool>* cancel = nullptr) const;
+};
+
+#endif /* VERTEXWELDER_H_ */
@@ -0,0 +1,84 @@
+/*
+ * ViewSetup.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "ViewSetup.h"
+#include "GLCamera.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <GL/gl.h>
+
+using maths::vector3f;
+using maths::vector3d;
+
+//static
+void ViewSetup::SetupLighting()
+{
+	GLfloat mat_ambient_diff[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, mat_ambient_diff);
+	glColorMaterial(GL_FRONT, GL_AMBIENT_AND_DIFFUSE);
+	glEnable(GL_COLOR_MATERIAL);
+
+	GLfloat light_position_1[] = { 5.0f, 5.0f, 10.0f, 1.0f };
+	GLfloat light_position_2[] = { 0.0f, 10.0f, 0.0f, 1.0f };
+	glLightfv(GL_LIGHT0, GL_POSITION, light_position_1);
+	glLightfv(GL_LIGHT1, GL_POSITION, light_position_2);
+
+	glEnable(GL_LIGHTING);
+	glEnable(GL_LIGHT0);
+	glEnable(GL_DEPTH_TEST);
+}
+
+//static
+void ViewSetup::FitCamera(GLCamera& camera, const maths::bbox3d& bbox)
+{
+	const vector3d mesh_c = bbox.center();
+	const double diam = std::max(bbox.extent_x(), bbox.extent_y());
+
+	vector3f origin(0.0f, 0.0f, 2 * diam);
+	vector3f view_dir((float) mesh_c.x(), (float) mesh_c.y(), (float) mesh_c.z());
+	camera.LookAt(origin, view_dir, vector3f(0.0f, 1.0f, 0.0f));
+}
+
+//static
+double ViewSetup::LoadProjection(const maths::bbox3d& bbox, double view_distance, double zoom_factor,
+								 unsigned width, unsigned height)
+{
+	const GLfloat aspect = (GLfloat) width / (GLfloat) height;
+	glViewport(0, 0, width, height);
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+
+	const double c_x = bbox.is_empty() ? 0.0 : bbox.center().x();
+	const double c_y = bbox.is_empty() ? 0.0 : bbox.center().y();
+	const double diam = bbox.is_empty() ? 1.0 : bbox.max_extent();
+	double left = c_x - diam;
+	double right = c_x + diam;
+	double bottom = c_y - diam;
+	double top = c_y + diam;
+
+	const double z_near = -2.0 * (view_distance + diam);
+	const double z_far = 2.0 * (view_distance + diam);
+
+	if (aspect < 1.0)
+	{
+		bottom /= aspect;
+		top /= aspect;
+	}
+	else
+	{
+		left *= aspect;
+		right *= aspect;
+	}
+
+	glOrtho(zoom_factor * left, zoom_factor * right, zoom_factor * bottom, zoom_factor * top, z_near, z_far);
+
+	const double view_height = std::fabs(zoom_factor * (top - bottom));
+	return view_height > 0.0 ? height / view_height : 0.0;
+}
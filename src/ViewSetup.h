@@ -0,0 +1,38 @@
+/*
+ * ViewSetup.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef VIEWSETUP_H_
+#define VIEWSETUP_H_
+
+#include <geom.h>
+
+class GLCamera;
+
+/** How the view of a scene is set up: lighting, the camera and the projection.
+ *  Shared by the window (STLDrawArea) and offscreen rendering (ThumbnailRenderer),
+ *  so a thumbnail looks like the part did when it was first opened.
+ *  Everything here needs a current GL context.
+ */
+struct ViewSetup
+{
+	/** Sets up the lights and material */
+	static void SetupLighting();
+
+	/** Points the camera at the middle of bbox, from in front of it */
+	static void FitCamera(GLCamera& camera, const maths::bbox3d& bbox);
+
+	/** Loads an orthographic projection around bbox, for a viewport of width by height
+	 *  @param	bbox			What to fit in view, empty for a unit view
+	 *  @param	view_distance	The camera's distance from what it looks at
+	 *  @param	zoom_factor		1 to fit bbox, smaller to zoom in
+	 *  @returns				Model units to screen pixels
+	 */
+	static double LoadProjection(const maths::bbox3d& bbox, double view_distance, double zoom_factor,
+								 unsigned width, unsigned height);
+};
+
+#endif /* VIEWSETUP_H_ */
@@ -0,0 +1,103 @@
+/*
+ * WorkerPool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#include "WorkerPool.h"
+#include "Parallel.h"
+
+WorkerPool::WorkerPool(unsigned num_threads)
+: m_num_busy(0)
+, m_stop(false)
+{
+	num_threads = ResolveThreadCount(num_threads);
+
+	for (unsigned i = 0 ; i < num_threads ; i++)
+		m_threads.emplace_back(&WorkerPool::run, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue.clear();
+		m_stop = true;
+	}
+	m_work_cv.notify_all();
+
+	for (std::thread& t : m_threads)
+		t.join();
+}
+
+void WorkerPool::run()
+{
+	for (;;)
+	{
+		task t;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_work_cv.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+
+			if (m_stop)
+				return;
+
+			t = std::move(m_queue.front());
+			m_queue.pop_front();
+			m_num_busy++;
+		}
+
+		try
+		{
+			t();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_error)
+				m_error = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_num_busy--;
+		}
+		m_idle_cv.notify_all();
+	}
+}
+
+void WorkerPool::Submit(const task& t)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue.push_back(t);
+	}
+	m_work_cv.notify_one();
+}
+
+void WorkerPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle_cv.wait(lock, [this]() { return m_queue.empty() && m_num_busy == 0; });
+
+	if (m_error)
+	{
+		std::exception_ptr error = m_error;
+		m_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+size_t WorkerPool::CancelPending()
+{
+	size_t num_dropped = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		num_dropped = m_queue.size();
+		m_queue.clear();
+	}
+	m_idle_cv.notify_all();
+
+	return num_dropped;
+}
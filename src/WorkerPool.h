@@ -0,0 +1,69 @@
+/*
+ * WorkerPool.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: cds
+ */
+
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <cstddef>
+
+/** A fixed set of worker threads that run queued tasks in submission order.
+ *  For independent jobs (one per file, say) that don't fit ParallelFor().
+ */
+class WorkerPool
+{
+public:
+	typedef std::function<void ()> task;
+
+private:
+	std::vector<std::thread>	m_threads;
+	std::deque<task>			m_queue;
+
+	std::mutex					m_mutex;
+	std::condition_variable		m_work_cv;
+	std::condition_variable		m_idle_cv;
+	size_t						m_num_busy;
+	bool						m_stop;
+	std::exception_ptr			m_error;
+
+	void run();
+
+public:
+	/** Constructor.
+	 *  @param num_threads	The number of worker threads, 0 for the default
+	 */
+	explicit WorkerPool(unsigned num_threads = 0);
+
+	/** Drops any tasks that haven't started, and waits for the running ones */
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	unsigned NumThreads() const { return (unsigned) m_threads.size(); }
+
+	/** Queues a task. Any thread. */
+	void Submit(const task& t);
+
+	/** Blocks until every queued task has finished.
+	 *  Rethrows the first exception thrown by a task since the last Wait().
+	 */
+	void Wait();
+
+	/** Drops the tasks that haven't started yet.
+	 *  @returns	The number of tasks dropped
+	 */
+	size_t CancelPending();
+};
+
+#endif /* WORKERPOOL_H_ */
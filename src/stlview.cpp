@@ -6,18 +6,396 @@
  */
 
 #include <memory>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+
+#include <errno.h>
+#include <sys/stat.h>
 
 #include <gtkglmm.h>
 #include <gtkmm.h>
 
 #include "MainWindow.h"
+#include "MeshReport.h"
+#include "Parallel.h"
+#include "SplitNormals.h"
+#include "ThumbnailRenderer.h"
+
+namespace
+{
+	/** Everything we can be told on the command line */
+	struct options
+	{
+		int				num_threads = 0;
+		double			weld_tolerance = 0.0;
+		double			crease_angle = SplitNormals::DEFAULT_CREASE_ANGLE;
+		double			feature_angle = 0.0;
+		Glib::ustring	renderer = "buffers";
+		bool			log_draw_times = false;
+		bool			frame_stats = false;
+		int				settle_ms = 200;
+
+		bool			report = false;
+		Glib::ustring	report_format = "json";
+		Glib::ustring	report_output;
+		Glib::ustring	report_file_list;
+
+		bool			thumbnails = false;
+		Glib::ustring	thumbnail_size = "256";
+		Glib::ustring	thumbnail_dir = "thumbnails";
+	};
+
+	/** Sets up option_context to fill in opts.
+	 *  The groups have to outlive the context, so they live in groups.
+	 */
+	void init_option_context(Glib::OptionContext& option_context, options& opts,
+							 std::vector<std::unique_ptr<Glib::OptionGroup>>& groups)
+	{
+		Glib::OptionEntry threads_entry;
+		threads_entry.set_long_name("threads");
+		threads_entry.set_short_name('j');
+		threads_entry.set_arg_description("N");
+		threads_entry.set_description("Number of threads used to parse STL files (default: one per core)");
+
+		Glib::OptionEntry weld_entry;
+		weld_entry.set_long_name("weld-tolerance");
+		weld_entry.set_arg_description("TOL");
+		weld_entry.set_description("Weld triangle corners that fall in the same TOL-sized grid cell into one vertex (default: only coincident corners)");
+
+		Glib::OptionEntry crease_entry;
+		crease_entry.set_long_name("crease-angle");
+		crease_entry.set_arg_description("DEGREES");
+		crease_entry.set_description("Split the shading where facets meet at more than DEGREES (default: 38.25)");
+
+		Glib::OptionEntry feature_entry;
+		feature_entry.set_long_name("feature-angle");
+		feature_entry.set_arg_description("DEGREES");
+		feature_entry.set_description("Only show edges where facets meet at more than DEGREES, and boundary edges (default: all edges)");
+
+		Glib::OptionEntry renderer_entry;
+		renderer_entry.set_long_name("renderer");
+		renderer_entry.set_arg_description("buffers|lists");
+		renderer_entry.set_description("Draw meshes from buffer objects or from display lists (default: buffers)");
+
+		Glib::OptionEntry draw_times_entry;
+		draw_times_entry.set_long_name("log-draw-times");
+		draw_times_entry.set_description("Log how long each phase of each frame takes on the CPU and GPU, and what it drew");
+
+		Glib::OptionEntry frame_stats_entry;
+		frame_stats_entry.set_long_name("frame-stats");
+		frame_stats_entry.set_description("Show frame timings (CPU per phase and GPU), what was drawn and a frame time histogram over the view");
+
+		Glib::OptionEntry settle_entry;
+		settle_entry.set_long_name("settle-time");
+		settle_entry.set_arg_description("MS");
+		settle_entry.set_description("Draw a cheap proxy while the view is dragged, and full quality once there's been no input for MS milliseconds (default: 200)");
+
+		groups.emplace_back(new Glib::OptionGroup("stlview", "STLView options"));
+		groups.back()->add_entry(threads_entry, opts.num_threads);
+		groups.back()->add_entry(weld_entry, opts.weld_tolerance);
+		groups.back()->add_entry(crease_entry, opts.crease_angle);
+		groups.back()->add_entry(feature_entry, opts.feature_angle);
+		groups.back()->add_entry(renderer_entry, opts.renderer);
+		groups.back()->add_entry(draw_times_entry, opts.log_draw_times);
+		groups.back()->add_entry(frame_stats_entry, opts.frame_stats);
+		groups.back()->add_entry(settle_entry, opts.settle_ms);
+		option_context.set_main_group(*groups.back());
+
+		Glib::OptionEntry report_entry;
+		report_entry.set_long_name("report");
+		report_entry.set_description("Write the mesh info for every FILE (or every STL file under a directory) without opening a window");
+
+		Glib::OptionEntry format_entry;
+		format_entry.set_long_name("format");
+		format_entry.set_arg_description("json|csv");
+		format_entry.set_description("Report format (default: json)");
+
+		Glib::OptionEntry output_entry;
+		output_entry.set_long_name("output");
+		output_entry.set_short_name('o');
+		output_entry.set_arg_description("FILE");
+		output_entry.set_description("Write the report to FILE instead of standard output");
+
+		Glib::OptionEntry file_list_entry;
+		file_list_entry.set_long_name("file-list");
+		file_list_entry.set_arg_description("FILE");
+		file_list_entry.set_description("Also report on the files listed in FILE, one per line (- for standard input)");
+
+		groups.emplace_back(new Glib::OptionGroup("report", "Batch report options", "Show batch report options"));
+		groups.back()->add_entry(report_entry, opts.report);
+		groups.back()->add_entry(format_entry, opts.report_format);
+		groups.back()->add_entry(output_entry, opts.report_output);
+		groups.back()->add_entry(file_list_entry, opts.report_file_list);
+		option_context.add_group(*groups.back());
+
+		Glib::OptionEntry thumbnails_entry;
+		thumbnails_entry.set_long_name("thumbnails");
+		thumbnails_entry.set_description("Render a PNG image of every FILE (or every STL file under a directory) without opening a window");
+
+		Glib::OptionEntry size_entry;
+		size_entry.set_long_name("thumbnail-size");
+		size_entry.set_arg_description("N|WxH");
+		size_entry.set_description("Thumbnail size in pixels (default: 256)");
+
+		Glib::OptionEntry dir_entry;
+		dir_entry.set_long_name("thumbnail-dir");
+		dir_entry.set_arg_description("DIR");
+		dir_entry.set_description("Write the thumbnails to DIR (default: thumbnails)");
+
+		groups.emplace_back(new Glib::OptionGroup("thumbnails", "Thumbnail options", "Show thumbnail options"));
+		groups.back()->add_entry(thumbnails_entry, opts.thumbnails);
+		groups.back()->add_entry(size_entry, opts.thumbnail_size);
+		groups.back()->add_entry(dir_entry, opts.thumbnail_dir);
+		option_context.add_group(*groups.back());
+	}
+
+	/** Finds the STL files named on the command line and in --file-list
+	 *  @throws std::runtime_error if a file or directory can't be read
+	 */
+	void find_files(const options& opts, int argc, char** argv, std::vector<std::string>& filenames)
+	{
+		for (int i = 1 ; i < argc ; i++)
+			MeshReport::FindSTLFiles(argv[i], filenames);
+
+		if (!opts.report_file_list.empty())
+		{
+			std::ifstream list_file;
+			if (opts.report_file_list != "-")
+			{
+				list_file.open(opts.report_file_list.c_str());
+				if (list_file.fail())
+					throw std::runtime_error("Error opening " + opts.report_file_list + ": " + ::strerror(errno));
+			}
+
+			std::istream& list = opts.report_file_list == "-" ? std::cin : list_file;
+
+			std::string line;
+			while (std::getline(list, line))
+			{
+				if (!line.empty())
+					MeshReport::FindSTLFiles(line, filenames);
+			}
+		}
+	}
+
+	/** Runs "stlview --report". Nothing here touches GTK or OpenGL,
+	 *  so this works on machines without a display.
+	 *  @returns	The process exit code
+	 */
+	int run_report(const options& opts, int argc, char** argv)
+	{
+		if (opts.report_format != "json" && opts.report_format != "csv")
+		{
+			std::cerr << "Unknown report format: " << opts.report_format << std::endl;
+			return 1;
+		}
+
+		std::vector<std::string> filenames;
+		try
+		{
+			find_files(opts, argc, argv, filenames);
+		}
+		catch (std::exception& ex)
+		{
+			std::cerr << ex.what() << std::endl;
+			return 1;
+		}
+
+		if (filenames.empty())
+		{
+			std::cerr << "No files to report on" << std::endl;
+			return 1;
+		}
+
+		const unsigned num_threads = ResolveThreadCount(opts.num_threads > 0 ? (unsigned) opts.num_threads : 0);
+
+		auto const start = std::chrono::steady_clock::now();
+		const std::vector<MeshReport> reports = MeshReport::GenerateAll(filenames, num_threads, opts.weld_tolerance, opts.crease_angle);
+		std::chrono::duration<double> const time = std::chrono::steady_clock::now() - start;
+
+		std::ofstream output_file;
+		if (!opts.report_output.empty())
+		{
+			output_file.open(opts.report_output.c_str());
+			if (output_file.fail())
+			{
+				std::cerr << "Error opening " << opts.report_output << ": " << ::strerror(errno) << std::endl;
+				return 1;
+			}
+		}
+
+		std::ostream& os = opts.report_output.empty() ? std::cout : output_file;
+
+		if (opts.report_format == "csv")
+			MeshReport::WriteCSV(os, reports);
+		else
+			MeshReport::WriteJSON(os, reports);
+
+		size_t num_failed = 0;
+		uint64_t num_facets = 0;
+		for (const MeshReport& r : reports)
+		{
+			if (!r.Ok())
+			{
+				std::cerr << r.filename << ": " << r.error << std::endl;
+				num_failed++;
+			}
+
+			num_facets += r.stats.num_facets;
+		}
+
+		const double seconds = std::max(time.count(), 1.0e-9);
+		std::clog	<< "Reported on " << reports.size() << " files (" << num_failed << " failed), "
+					<< num_facets << " facets in " << std::fixed << std::setprecision(3) << seconds << " s on "
+					<< num_threads << " threads: " << std::setprecision(1)
+					<< reports.size() / seconds << " files/s, " << num_facets / seconds << " facets/s" << std::endl;
+
+		return num_failed == 0 ? 0 : 2;
+	}
+
+	/** Runs "stlview --thumbnails". Like the report, this needs no display.
+	 *  @returns	The process exit code
+	 */
+	int run_thumbnails(const options& opts, int argc, char** argv)
+	{
+		if (!ThumbnailRenderer::IsSupported())
+		{
+			std::cerr << "stlview was built without EGL and libpng, so it can't render thumbnails" << std::endl;
+			return 1;
+		}
+
+		unsigned width = 0, height = 0;
+		char extra = 0;
+		const int num_sizes = std::sscanf(opts.thumbnail_size.c_str(), "%ux%u%c", &width, &height, &extra);
+		if (num_sizes == 1)
+			height = width;
+
+		if ((num_sizes != 1 && num_sizes != 2) || width == 0 || height == 0 || width > 8192 || height > 8192)
+		{
+			std::cerr << "Bad thumbnail size: " << opts.thumbnail_size << std::endl;
+			return 1;
+		}
+
+		std::vector<std::string> filenames;
+		try
+		{
+			find_files(opts, argc, argv, filenames);
+		}
+		catch (std::exception& ex)
+		{
+			std::cerr << ex.what() << std::endl;
+			return 1;
+		}
+
+		if (filenames.empty())
+		{
+			std::cerr << "No files to render" << std::endl;
+			return 1;
+		}
+
+		if (::mkdir(opts.thumbnail_dir.c_str(), 0777) != 0 && errno != EEXIST)
+		{
+			std::cerr << "Error creating " << opts.thumbnail_dir << ": " << ::strerror(errno) << std::endl;
+			return 1;
+		}
+
+		const unsigned num_threads = ResolveThreadCount(opts.num_threads > 0 ? (unsigned) opts.num_threads : 0);
+
+		auto const start = std::chrono::steady_clock::now();
+		std::vector<ThumbnailRenderer::Result> results;
+		try
+		{
+			results = ThumbnailRenderer::RenderAll(filenames, opts.thumbnail_dir, width, height, num_threads,
+												   opts.weld_tolerance, opts.crease_angle);
+		}
+		catch (std::exception& ex)
+		{
+			std::cerr << ex.what() << std::endl;
+			return 1;
+		}
+		std::chrono::duration<double> const time = std::chrono::steady_clock::now() - start;
+
+		size_t num_failed = 0;
+		for (const ThumbnailRenderer::Result& r : results)
+		{
+			if (!r.Ok())
+			{
+				std::cerr << r.filename << ": " << r.error << std::endl;
+				num_failed++;
+			}
+		}
+
+		const double seconds = std::max(time.count(), 1.0e-9);
+		std::clog	<< "Rendered " << results.size() - num_failed << " thumbnails (" << num_failed << " failed) at "
+					<< width << "x" << height << " in " << std::fixed << std::setprecision(3) << seconds << " s on "
+					<< num_threads << " threads: " << std::setprecision(1) << results.size() / seconds << " images/s" << std::endl;
+
+		return num_failed == 0 ? 0 : 2;
+	}
+};
 
 int main(int argc, char** argv)
 {
 	if (!Glib::thread_supported())
 		Glib::thread_init();
 
-	Gtk::Main kit(argc, argv);
+	options opts;
+
+	Glib::OptionContext option_context("[FILE...]");
+	std::vector<std::unique_ptr<Glib::OptionGroup>> option_groups;
+	init_option_context(option_context, opts, option_groups);
+
+	// Report and thumbnail modes must not initialize GTK, there may not be a display
+	bool report_mode = false, thumbnail_mode = false;
+	for (int i = 1 ; i < argc ; i++)
+	{
+		report_mode = report_mode || std::strcmp(argv[i], "--report") == 0;
+		thumbnail_mode = thumbnail_mode || std::strcmp(argv[i], "--thumbnails") == 0;
+	}
+
+	if (report_mode || thumbnail_mode)
+	{
+		try
+		{
+			option_context.parse(argc, argv);
+		}
+		catch (Glib::OptionError& ex)
+		{
+			std::cerr << ex.what() << std::endl;
+			return 1;
+		}
+
+		if (opts.thumbnails)
+			return run_thumbnails(opts, argc, argv);
+
+		return run_report(opts, argc, argv);
+	}
+
+	std::unique_ptr<Gtk::Main> kit;
+	try
+	{
+		kit.reset(new Gtk::Main(argc, argv, option_context));
+	}
+	catch (Glib::OptionError& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		return 1;
+	}
+
+	if (opts.renderer != "buffers" && opts.renderer != "lists")
+	{
+		std::cerr << "Unknown renderer: " << opts.renderer << std::endl;
+		return 1;
+	}
+
 	Gtk::GL::init(argc, argv);
 
 	const int width_default = 1024;
@@ -25,11 +403,20 @@ int main(int argc, char** argv)
 
 	std::unique_ptr<MainWindow> window(new MainWindow);
 	window->resize(width_default, height_default);
+	window->SetImportThreads(opts.num_threads > 0 ? (unsigned) opts.num_threads : 0);
+	window->SetWeldTolerance(opts.weld_tolerance);
+	window->SetCreaseAngle(opts.crease_angle);
+	if (opts.feature_angle > 0.0)
+		window->SetFeatureAngle(opts.feature_angle);
+	window->SetRenderer(opts.renderer == "lists" ? STLDrawArea::RENDERER_DISPLAY_LISTS : STLDrawArea::RENDERER_BUFFERS);
+	window->SetLogDrawTimes(opts.log_draw_times);
+	window->SetShowFrameStats(opts.frame_stats);
+	window->SetSettleTime(opts.settle_ms > 0 ? (unsigned) opts.settle_ms : 0);
 
 	if (argc > 1)
-		window->FileOpen(argv[1]);
+		window->OpenFiles(std::vector<Glib::ustring>(argv + 1, argv + argc));
 
-	kit.run(*window);
+	kit->run(*window);
 
 	return 0;
 }